@@ -358,6 +358,8 @@ bool BaseViewer::unload()
 {
     getPickHandler()->reset();
     getPickHandler()->unload();
+    if (makeGLContextCurrent())
+        getPickHandler()->releaseGL();
     return true;
 }
 
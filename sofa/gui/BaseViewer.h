@@ -112,6 +112,10 @@ public:
     /// unload the viewer without delete
     virtual bool unload(void);
 
+    /// Make the GL context of the viewer current, to release its GL resources
+    /// outside of the drawing. Return false if the viewer has no such context.
+    virtual bool makeGLContextCurrent() { return false; }
+
     /// Recompute viewer's home position so it encompass the whole scene and apply it
     virtual void viewAll(void) = 0;
 
@@ -0,0 +1,111 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "ColourPickingRegistry.h"
+
+#include <SofaMeshCollision/TriangleModel.h>
+#include <SofaBaseCollision/SphereModel.h>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+using namespace sofa::component::collision;
+
+ColourPickingRegistry::ColourPickingRegistry()
+    : root(NULL)
+{
+}
+
+ColourPickingRegistry::~ColourPickingRegistry()
+{
+}
+
+void ColourPickingRegistry::attach(simulation::Node* node)
+{
+    if (root) detach();
+    root = node;
+    // register the existing models and listen to the whole graph
+    addChild(NULL, root);
+}
+
+void ColourPickingRegistry::detach()
+{
+    if (!root) return;
+    removeChild(NULL, root);
+    root->removeListener(this);
+    root = NULL;
+    models.clear();
+    ids.clear();
+    freeIds.clear();
+}
+
+void ColourPickingRegistry::addObject(simulation::Node* parent, core::objectmodel::BaseObject* object)
+{
+    core::CollisionModel* model = core::CollisionModel::DynamicCast(object);
+    // only triangle and sphere models are drawn in the selection buffer
+    if (model && (TriangleModel::DynamicCast(model) || SphereModel::DynamicCast(model)))
+        registerModel(model);
+    MutationListener::addObject(parent, object);
+}
+
+void ColourPickingRegistry::removeObject(simulation::Node* parent, core::objectmodel::BaseObject* object)
+{
+    MutationListener::removeObject(parent, object);
+    core::CollisionModel* model = core::CollisionModel::DynamicCast(object);
+    if (model) unregisterModel(model);
+}
+
+void ColourPickingRegistry::registerModel(core::CollisionModel* model)
+{
+    if (ids.count(model)) return;
+    unsigned int id;
+    if (!freeIds.empty())
+    {
+        id = freeIds.back();
+        freeIds.pop_back();
+        models[id-1] = model;
+    }
+    else
+    {
+        models.push_back(model);
+        id = (unsigned int)models.size();
+    }
+    ids[model] = id;
+}
+
+void ColourPickingRegistry::unregisterModel(core::CollisionModel* model)
+{
+    std::unordered_map<const core::CollisionModel*, unsigned int>::iterator it = ids.find(model);
+    if (it == ids.end()) return;
+    models[it->second-1] = NULL;
+    freeIds.push_back(it->second);
+    ids.erase(it);
+}
+
+} // namespace gui
+
+} // namespace sofa
@@ -0,0 +1,117 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_COLOURPICKINGREGISTRY_H
+#define SOFA_GUI_COLOURPICKINGREGISTRY_H
+
+#include "SofaGUI.h"
+#include <sofa/simulation/common/Node.h>
+#include <sofa/simulation/common/MutationListener.h>
+#include <sofa/core/CollisionModel.h>
+#include <sofa/defaulttype/Vec.h>
+#include <unordered_map>
+#include <vector>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+/// Compact integer identifiers of the collision models drawn in the selection buffer.
+/// The table is filled when attached to a scene and kept up to date through the
+/// graph mutation events, so that encoding and decoding do not query the graph.
+/// Identifiers start at 1, 0 being the background. Identifiers of removed models
+/// are reused by the next registered ones.
+///
+/// The pair model - element is encoded as integers in 16 bit channels, which are
+/// exact in both the RGBA16 and the RGBA32F selection buffers:
+///   r : model identifier
+///   g : 16 low bits of the element index
+///   b : 16 high bits of the element index
+class SOFA_SOFAGUI_API ColourPickingRegistry : public simulation::MutationListener
+{
+public:
+    ColourPickingRegistry();
+    virtual ~ColourPickingRegistry();
+
+    void attach(simulation::Node* root);
+    void detach();
+
+    /// Return the identifier of the model, 0 if it is not registered
+    unsigned int getId(const core::CollisionModel* model) const
+    {
+        std::unordered_map<const core::CollisionModel*, unsigned int>::const_iterator it = ids.find(model);
+        return it == ids.end() ? 0 : it->second;
+    }
+
+    /// Return the model of the given identifier, NULL if there is none
+    core::CollisionModel* getModel(unsigned int id) const
+    {
+        return (id > 0 && id <= models.size()) ? models[id-1] : NULL;
+    }
+
+    /// Greatest identifier in use
+    unsigned int getNbIds() const { return (unsigned int)models.size(); }
+
+    /// Channels of the colour code of an element, as 16 bit normalized integers
+    static sofa::defaulttype::Vec<4,unsigned short> encode(unsigned int id, unsigned int index)
+    {
+        return sofa::defaulttype::Vec<4,unsigned short>((unsigned short)id, (unsigned short)(index & 0xFFFF),
+                (unsigned short)(index >> 16), 0xFFFF);
+    }
+
+    /// Colour code of an element in floating point
+    static sofa::defaulttype::Vec4f encodeColour(unsigned int id, unsigned int index)
+    {
+        const sofa::defaulttype::Vec<4,unsigned short> c = encode(id, index);
+        return sofa::defaulttype::Vec4f(c[0]/65535.0f, c[1]/65535.0f, c[2]/65535.0f, 1.0f);
+    }
+
+    /// Return false if the colour is the background
+    static bool decodeColour(const sofa::defaulttype::Vec4f& colour, unsigned int& id, unsigned int& index)
+    {
+        id = (unsigned int)(colour[0]*65535.0f + 0.5f);
+        index = (unsigned int)(colour[1]*65535.0f + 0.5f) | ((unsigned int)(colour[2]*65535.0f + 0.5f) << 16);
+        return id != 0;
+    }
+
+    virtual void addObject(simulation::Node* parent, core::objectmodel::BaseObject* object);
+    virtual void removeObject(simulation::Node* parent, core::objectmodel::BaseObject* object);
+
+protected:
+    void registerModel(core::CollisionModel* model);
+    void unregisterModel(core::CollisionModel* model);
+
+    simulation::Node* root;
+    std::vector<core::CollisionModel*> models;
+    std::unordered_map<const core::CollisionModel*, unsigned int> ids;
+    std::vector<unsigned int> freeIds;
+};
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_COLOURPICKINGREGISTRY_H
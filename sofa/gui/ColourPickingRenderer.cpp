@@ -0,0 +1,493 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "ColourPickingRenderer.h"
+#include "ColourPickingRegistry.h"
+
+#include <sofa/core/behavior/BaseMechanicalState.h>
+#include <sofa/core/VecId.h>
+
+#include <algorithm>
+#include <iostream>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+using namespace sofa::component::collision;
+
+namespace
+{
+#ifdef SOFA_HAVE_GLEW
+const char* sphereVertexShader =
+    "#version 120\n"
+    "uniform float viewportHeight;\n"
+    "varying vec3 center;\n"
+    "varying float radius;\n"
+    "void main()\n"
+    "{\n"
+    "    vec4 eye = gl_ModelViewMatrix * vec4(gl_Vertex.xyz, 1.0);\n"
+    "    center = eye.xyz;\n"
+    "    radius = gl_Vertex.w;\n"
+    "    gl_Position = gl_ProjectionMatrix * eye;\n"
+    "    gl_PointSize = viewportHeight * gl_ProjectionMatrix[1][1] * radius / gl_Position.w;\n"
+    "    gl_FrontColor = gl_Color;\n"
+    "}\n";
+
+const char* sphereFragmentShader =
+    "#version 120\n"
+    "varying vec3 center;\n"
+    "varying float radius;\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 p = gl_PointCoord * 2.0 - 1.0;\n"
+    "    float d2 = dot(p, p);\n"
+    "    if (d2 > 1.0) discard;\n"
+    "    vec3 eye = center + vec3(p.x, -p.y, sqrt(1.0 - d2)) * radius;\n"
+    "    vec4 clip = gl_ProjectionMatrix * vec4(eye, 1.0);\n"
+    "    gl_FragDepth = 0.5 * clip.z / clip.w + 0.5;\n"
+    "    gl_FragData[0] = gl_Color;\n"
+    "    gl_FragData[1] = vec4(0.0, 0.0, 0.0, 1.0);\n"
+    "}\n";
+
+GLuint compileShader(GLenum type, const char* source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        std::cerr << "ColourPickingRenderer: shader compilation failed: " << log << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+#endif
+}
+
+ColourPickingRenderer::TriangleBuffers::TriangleBuffers()
+    : model(NULL)
+    , size(0)
+    , counter(-1)
+    , positionVBO(0)
+    , codeVBO(0)
+    , barycentricVBO(0)
+{
+}
+
+ColourPickingRenderer::SphereBuffers::SphereBuffers()
+    : model(NULL)
+    , size(0)
+    , counter(-1)
+    , positionVBO(0)
+    , codeVBO(0)
+{
+}
+
+ColourPickingRenderer::ColourPickingRenderer()
+    : sphereProgram(0)
+    , sphereViewportHeight(-1)
+    , sphereProgramChecked(false)
+    , maxPointSize(0)
+{
+}
+
+ColourPickingRenderer::~ColourPickingRenderer()
+{
+}
+
+bool ColourPickingRenderer::useVBO()
+{
+#ifdef SOFA_HAVE_GLEW
+    return GLEW_VERSION_1_5 ? true : false;
+#else
+    return false;
+#endif
+}
+
+GLuint ColourPickingRenderer::createProgram(const char* vertexShader, const char* fragmentShader)
+{
+    GLuint program = 0;
+#ifdef SOFA_HAVE_GLEW
+    if (!GLEW_VERSION_2_0) return 0;
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShader);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentShader);
+    if (vs && fs)
+    {
+        program = glCreateProgram();
+        glAttachShader(program, vs);
+        glAttachShader(program, fs);
+        glLinkProgram(program);
+        GLint status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        if (status != GL_TRUE)
+        {
+            char log[1024];
+            glGetProgramInfoLog(program, sizeof(log), NULL, log);
+            std::cerr << "ColourPickingRenderer: program link failed: " << log << std::endl;
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    if (vs) glDeleteShader(vs);
+    if (fs) glDeleteShader(fs);
+#else
+    (void)vertexShader;
+    (void)fragmentShader;
+#endif
+    return program;
+}
+
+int ColourPickingRenderer::getCounter(core::CollisionModel* model)
+{
+    core::behavior::BaseMechanicalState* mstate = model->getContext()->getMechanicalState();
+    if (!mstate) return -1;
+    const core::objectmodel::BaseData* position = mstate->baseRead(core::ConstVecCoordId::position());
+    return position ? position->getCounter() : -1;
+}
+
+void ColourPickingRenderer::release(TriangleBuffers& buffers)
+{
+#ifdef SOFA_HAVE_GLEW
+    if (buffers.positionVBO) glDeleteBuffers(1, &buffers.positionVBO);
+    if (buffers.codeVBO) glDeleteBuffers(1, &buffers.codeVBO);
+    if (buffers.barycentricVBO) glDeleteBuffers(1, &buffers.barycentricVBO);
+#endif
+    buffers = TriangleBuffers();
+}
+
+void ColourPickingRenderer::release(SphereBuffers& buffers)
+{
+#ifdef SOFA_HAVE_GLEW
+    if (buffers.positionVBO) glDeleteBuffers(1, &buffers.positionVBO);
+    if (buffers.codeVBO) glDeleteBuffers(1, &buffers.codeVBO);
+#endif
+    buffers = SphereBuffers();
+}
+
+void ColourPickingRenderer::release()
+{
+    for (unsigned int i=0; i<triangles.size(); ++i)
+        release(triangles[i]);
+    triangles.clear();
+    for (unsigned int i=0; i<spheres.size(); ++i)
+        release(spheres[i]);
+    spheres.clear();
+#ifdef SOFA_HAVE_GLEW
+    if (sphereProgram) glDeleteProgram(sphereProgram);
+#endif
+    sphereProgram = 0;
+    sphereProgramChecked = false;
+}
+
+void ColourPickingRenderer::update(TriangleBuffers& buffers, TriangleModel* model, unsigned int id)
+{
+    const unsigned int size = (unsigned int)model->getSize();
+    const int counter = getCounter(model);
+    const bool rebuild = (buffers.model != model || buffers.size != size);
+    if (!rebuild && buffers.counter == counter && counter != -1) return;
+
+    if (rebuild)
+    {
+        release(buffers);
+        buffers.model = model;
+        buffers.size = size;
+
+        // element codes, constant for a given id and size
+        buffers.codes.resize(size*3*4);
+        for (unsigned int i=0; i<size; ++i)
+        {
+            const sofa::defaulttype::Vec<4,unsigned short> code = ColourPickingRegistry::encode(id, i);
+            for (unsigned int v=0; v<3; ++v)
+                for (unsigned int c=0; c<4; ++c)
+                    buffers.codes[(i*3+v)*4+c] = code[c];
+        }
+        // weights of p1, p2 and p3
+        buffers.barycentrics.assign(size*3*4, 0);
+        for (unsigned int i=0; i<size; ++i)
+        {
+            for (unsigned int v=0; v<3; ++v)
+            {
+                buffers.barycentrics[(i*3+v)*4+v] = 255;
+                buffers.barycentrics[(i*3+v)*4+3] = 255;
+            }
+        }
+#ifdef SOFA_HAVE_GLEW
+        if (useVBO() && size)
+        {
+            glGenBuffers(1, &buffers.codeVBO);
+            glBindBuffer(GL_ARRAY_BUFFER, buffers.codeVBO);
+            glBufferData(GL_ARRAY_BUFFER, buffers.codes.size()*sizeof(GLushort), &buffers.codes[0], GL_STATIC_DRAW);
+            glGenBuffers(1, &buffers.barycentricVBO);
+            glBindBuffer(GL_ARRAY_BUFFER, buffers.barycentricVBO);
+            glBufferData(GL_ARRAY_BUFFER, buffers.barycentrics.size()*sizeof(GLubyte), &buffers.barycentrics[0], GL_STATIC_DRAW);
+            glGenBuffers(1, &buffers.positionVBO);
+            glBindBuffer(GL_ARRAY_BUFFER, buffers.positionVBO);
+            glBufferData(GL_ARRAY_BUFFER, size*9*sizeof(GLfloat), NULL, GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            std::vector<GLushort>().swap(buffers.codes);
+            std::vector<GLubyte>().swap(buffers.barycentrics);
+        }
+#endif
+    }
+
+    buffers.counter = counter;
+    buffers.positions.resize(size*9);
+    for (unsigned int i=0; i<size; ++i)
+    {
+        Triangle t(model, i);
+        const defaulttype::Vector3 p[3] = { t.p1(), t.p2(), t.p3() };
+        for (unsigned int v=0; v<3; ++v)
+            for (unsigned int c=0; c<3; ++c)
+                buffers.positions[i*9+v*3+c] = (GLfloat)p[v][c];
+    }
+#ifdef SOFA_HAVE_GLEW
+    if (buffers.positionVBO)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffers.positionVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, buffers.positions.size()*sizeof(GLfloat), &buffers.positions[0]);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+#endif
+}
+
+void ColourPickingRenderer::drawTriangles(TriangleModel* model, unsigned int id, bool elementCodes, bool barycentrics)
+{
+    if (!id) return;
+    if (triangles.size() < id) triangles.resize(id);
+    TriangleBuffers& buffers = triangles[id-1];
+    update(buffers, model, id);
+    if (!buffers.size) return;
+
+    const GLvoid* positions = NULL;
+    const GLvoid* codes = NULL;
+    const GLvoid* weights = NULL;
+    if (!buffers.positionVBO)
+    {
+        positions = &buffers.positions[0];
+        codes = &buffers.codes[0];
+        weights = &buffers.barycentrics[0];
+    }
+
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+#ifdef SOFA_HAVE_GLEW
+    if (buffers.positionVBO) glBindBuffer(GL_ARRAY_BUFFER, buffers.positionVBO);
+#endif
+    glVertexPointer(3, GL_FLOAT, 0, positions);
+    if (elementCodes)
+    {
+#ifdef SOFA_HAVE_GLEW
+        if (buffers.codeVBO) glBindBuffer(GL_ARRAY_BUFFER, buffers.codeVBO);
+#endif
+        glColorPointer(4, GL_UNSIGNED_SHORT, 0, codes);
+    }
+    if (barycentrics)
+    {
+#ifdef SOFA_HAVE_GLEW
+        if (buffers.barycentricVBO) glBindBuffer(GL_ARRAY_BUFFER, buffers.barycentricVBO);
+        if (elementCodes)
+        {
+            glEnableClientState(GL_SECONDARY_COLOR_ARRAY);
+            glSecondaryColorPointer(3, GL_UNSIGNED_BYTE, 4*sizeof(GLubyte), weights);
+        }
+        else
+#endif
+            glColorPointer(4, GL_UNSIGNED_BYTE, 0, weights);
+    }
+    glDrawArrays(GL_TRIANGLES, 0, buffers.size*3);
+#ifdef SOFA_HAVE_GLEW
+    if (buffers.positionVBO) glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+    glPopClientAttrib();
+}
+
+bool ColourPickingRenderer::initSphereProgram()
+{
+    if (sphereProgramChecked) return sphereProgram != 0;
+    sphereProgramChecked = true;
+#ifdef SOFA_HAVE_GLEW
+    if (!GLEW_VERSION_2_1) return false;
+    sphereProgram = createProgram(sphereVertexShader, sphereFragmentShader);
+    if (sphereProgram)
+    {
+        sphereViewportHeight = glGetUniformLocation(sphereProgram, "viewportHeight");
+        // sprites are clamped to the smallest of the two ranges depending on the implementation
+        GLfloat range[2] = { 0, 0 };
+        GLfloat aliasedRange[2] = { 0, 0 };
+        glGetFloatv(GL_POINT_SIZE_RANGE, range);
+        glGetFloatv(GL_ALIASED_POINT_SIZE_RANGE, aliasedRange);
+        maxPointSize = std::min(range[1], aliasedRange[1]);
+    }
+#endif
+    return sphereProgram != 0;
+}
+
+void ColourPickingRenderer::update(SphereBuffers& buffers, SphereModel* model, unsigned int id)
+{
+    const unsigned int size = (unsigned int)model->getSize();
+    const int counter = getCounter(model);
+    const bool rebuild = (buffers.model != model || buffers.size != size);
+    if (!rebuild && buffers.counter == counter && counter != -1) return;
+
+    if (rebuild)
+    {
+        release(buffers);
+        buffers.model = model;
+        buffers.size = size;
+        buffers.codes.resize(size*4);
+        for (unsigned int i=0; i<size; ++i)
+        {
+            const sofa::defaulttype::Vec<4,unsigned short> code = ColourPickingRegistry::encode(id, i);
+            for (unsigned int c=0; c<4; ++c)
+                buffers.codes[i*4+c] = code[c];
+        }
+#ifdef SOFA_HAVE_GLEW
+        if (useVBO() && size)
+        {
+            glGenBuffers(1, &buffers.codeVBO);
+            glBindBuffer(GL_ARRAY_BUFFER, buffers.codeVBO);
+            glBufferData(GL_ARRAY_BUFFER, buffers.codes.size()*sizeof(GLushort), &buffers.codes[0], GL_STATIC_DRAW);
+            glGenBuffers(1, &buffers.positionVBO);
+            glBindBuffer(GL_ARRAY_BUFFER, buffers.positionVBO);
+            glBufferData(GL_ARRAY_BUFFER, size*4*sizeof(GLfloat), NULL, GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            std::vector<GLushort>().swap(buffers.codes);
+        }
+#endif
+    }
+
+    buffers.counter = counter;
+    buffers.positions.resize(size*4);
+    for (unsigned int i=0; i<size; ++i)
+    {
+        Sphere sphere(model, i);
+        const defaulttype::Vector3 p = sphere.center();
+        buffers.positions[i*4+0] = (GLfloat)p[0];
+        buffers.positions[i*4+1] = (GLfloat)p[1];
+        buffers.positions[i*4+2] = (GLfloat)p[2];
+        buffers.positions[i*4+3] = (GLfloat)sphere.r();
+    }
+#ifdef SOFA_HAVE_GLEW
+    if (buffers.positionVBO)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffers.positionVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, buffers.positions.size()*sizeof(GLfloat), &buffers.positions[0]);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+#endif
+}
+
+bool ColourPickingRenderer::drawSpheres(SphereModel* model, unsigned int id, std::vector<unsigned int>& fallback)
+{
+    fallback.clear();
+    if (!id || !initSphereProgram()) return false;
+#ifdef SOFA_HAVE_GLEW
+    if (spheres.size() < id) spheres.resize(id);
+    SphereBuffers& buffers = spheres[id-1];
+    update(buffers, model, id);
+    if (!buffers.size) return true;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    // same point size as the vertex shader, from the clip coordinates of the center
+    GLfloat modelview[16];
+    GLfloat projection[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+    sphereIndices.clear();
+    for (unsigned int i=0; i<buffers.size; ++i)
+    {
+        const GLfloat* p = &buffers.positions[i*4];
+        GLfloat eye[4];
+        for (int r=0; r<4; ++r)
+            eye[r] = modelview[r]*p[0] + modelview[4+r]*p[1] + modelview[8+r]*p[2] + modelview[12+r];
+        GLfloat clip[4];
+        for (int r=0; r<4; ++r)
+            clip[r] = projection[r]*eye[0] + projection[4+r]*eye[1] + projection[8+r]*eye[2] + projection[12+r]*eye[3];
+        const bool visible = clip[3] > 0
+                && clip[0] >= -clip[3] && clip[0] <= clip[3]
+                && clip[1] >= -clip[3] && clip[1] <= clip[3];
+        if (visible && viewport[3] * projection[5] * p[3] / clip[3] <= maxPointSize)
+            sphereIndices.push_back(i);
+        else
+            fallback.push_back(i);
+    }
+    if (sphereIndices.empty()) return true;
+    // restore the single pass picking program afterwards
+    GLint previousProgram = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+    glUseProgram(sphereProgram);
+    glUniform1f(sphereViewportHeight, (GLfloat)viewport[3]);
+
+    glPushAttrib(GL_ENABLE_BIT);
+    glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+    glEnable(GL_POINT_SPRITE);
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    if (buffers.positionVBO)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffers.positionVBO);
+        glVertexPointer(4, GL_FLOAT, 0, NULL);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers.codeVBO);
+        glColorPointer(4, GL_UNSIGNED_SHORT, 0, NULL);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    else
+    {
+        glVertexPointer(4, GL_FLOAT, 0, &buffers.positions[0]);
+        glColorPointer(4, GL_UNSIGNED_SHORT, 0, &buffers.codes[0]);
+    }
+    if (fallback.empty())
+        glDrawArrays(GL_POINTS, 0, buffers.size);
+    else
+        glDrawElements(GL_POINTS, (GLsizei)sphereIndices.size(), GL_UNSIGNED_INT, &sphereIndices[0]);
+    glPopClientAttrib();
+    glPopAttrib();
+    glUseProgram(previousProgram);
+    return true;
+#else
+    (void)model;
+    (void)fallback;
+    return false;
+#endif
+}
+
+} // namespace gui
+
+} // namespace sofa
@@ -0,0 +1,135 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_COLOURPICKINGRENDERER_H
+#define SOFA_GUI_COLOURPICKINGRENDERER_H
+
+#include "SofaGUI.h"
+
+#include <sofa/helper/system/gl.h>
+#include <SofaMeshCollision/TriangleModel.h>
+#include <SofaBaseCollision/SphereModel.h>
+
+#include <vector>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+/// Draws the triangle and sphere models in the selection buffer from geometry kept on the GPU.
+///
+/// For each registered model (indexed by its ColourPickingRegistry id) the colour codes
+/// of the elements and the barycentric colours are uploaded once, and the positions are
+/// only uploaded again when the position counter of the mechanical state changes.
+/// Vertex buffer objects are used when supported, client side arrays otherwise.
+///
+/// Spheres are drawn as point sprite impostors in a single draw call, with a shader
+/// writing the depth of the sphere surface. Point sprites are clamped to the point
+/// size range and dropped when their center is outside of the viewport, so the
+/// spheres in these cases are left to the caller, to be drawn as geometry.
+///
+/// All the methods must be called with the GL context of the viewer current.
+class SOFA_SOFAGUI_API ColourPickingRenderer
+{
+public:
+    ColourPickingRenderer();
+    ~ColourPickingRenderer();
+
+    /// Draw the triangles of the model with their element code or with the barycentric
+    /// weights of their vertices as colour. When both are requested, the weights are
+    /// given as secondary colour, for a shader writing them in a second render target.
+    void drawTriangles(sofa::component::collision::TriangleModel* model, unsigned int id, bool elementCodes, bool barycentrics);
+
+    /// Draw the spheres of the model with their element code.
+    /// Return false if impostors are not supported, the caller must then draw the spheres itself.
+    /// Otherwise fallback receives the indices of the spheres the caller must still draw:
+    /// larger than the maximum point size, or whose center is outside of the viewport.
+    bool drawSpheres(sofa::component::collision::SphereModel* model, unsigned int id, std::vector<unsigned int>& fallback);
+
+    /// Release the GL resources of all the models
+    void release();
+
+    /// Compile and link a GLSL program, return 0 and print the log on failure
+    static GLuint createProgram(const char* vertexShader, const char* fragmentShader);
+
+protected:
+    struct TriangleBuffers
+    {
+        TriangleBuffers();
+
+        const core::CollisionModel* model;
+        unsigned int size;
+        int counter;
+        GLuint positionVBO;
+        GLuint codeVBO;
+        GLuint barycentricVBO;
+        /// client side arrays, positions are also used to stage the uploads
+        std::vector<GLfloat> positions;
+        std::vector<GLushort> codes;
+        std::vector<GLubyte> barycentrics;
+    };
+
+    struct SphereBuffers
+    {
+        SphereBuffers();
+
+        const core::CollisionModel* model;
+        unsigned int size;
+        int counter;
+        /// x y z radius
+        GLuint positionVBO;
+        GLuint codeVBO;
+        std::vector<GLfloat> positions;
+        std::vector<GLushort> codes;
+    };
+
+    static bool useVBO();
+    static int getCounter(core::CollisionModel* model);
+
+    void update(TriangleBuffers& buffers, sofa::component::collision::TriangleModel* model, unsigned int id);
+    void update(SphereBuffers& buffers, sofa::component::collision::SphereModel* model, unsigned int id);
+    void release(TriangleBuffers& buffers);
+    void release(SphereBuffers& buffers);
+    bool initSphereProgram();
+
+    /// indexed by the registry id minus one
+    std::vector<TriangleBuffers> triangles;
+    std::vector<SphereBuffers> spheres;
+
+    GLuint sphereProgram;
+    GLint sphereViewportHeight;
+    bool sphereProgramChecked;
+    /// largest point sprite, in pixels
+    GLfloat maxPointSize;
+    /// spheres drawn as impostors, when some of them are left to the caller
+    std::vector<GLuint> sphereIndices;
+};
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_COLOURPICKINGRENDERER_H
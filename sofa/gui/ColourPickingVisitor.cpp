@@ -70,6 +70,22 @@ void decodeCollisionElement(const sofa::defaulttype::Vec4f colour,  sofa::compon
 
 }
 
+void decodeCollisionElement(const sofa::defaulttype::Vec4f colour,  sofa::component::collision::BodyPicked& body,
+        const ColourPickingRegistry& registry)
+{
+    body.body = NULL;
+    body.indexCollisionElement= 0;
+    unsigned int id, index;
+    if( ColourPickingRegistry::decodeColour(colour, id, index) ) // make sure we are not picking the background...
+    {
+        body.body = registry.getModel(id);
+        if (body.body && index < (unsigned int)body.body->getSize())
+            body.indexCollisionElement = index;
+        else
+            body.body = NULL;
+    }
+}
+
 void decodePosition(BodyPicked& body, const sofa::defaulttype::Vec4f colour, const TriangleModel* model,
         const unsigned int index)
 {
@@ -117,6 +133,16 @@ void ColourPickingVisitor::processCollisionModel(simulation::Node*  node , core:
         processSphereModel(node,smodel);
 }
 
+float ColourPickingVisitor::getModelCode(simulation::Node* node, core::CollisionModel* model) const
+{
+    helper::vector<core::CollisionModel*> listCollisionModel;
+    node->get< sofa::core::CollisionModel >( &listCollisionModel, BaseContext::SearchRoot);
+    helper::vector<core::CollisionModel*>::iterator iter = std::find(listCollisionModel.begin(), listCollisionModel.end(), model);
+    const std::size_t totalCollisionModel = listCollisionModel.size();
+    const int indexCollisionModel = std::distance(listCollisionModel.begin(),iter ) + 1 ;
+    return (float)indexCollisionModel / (float)totalCollisionModel;
+}
+
 void ColourPickingVisitor::processTriangleModel(simulation::Node * node, sofa::component::collision::TriangleModel * tmodel)
 {
 #ifndef SOFA_NO_OPENGL
@@ -128,35 +154,42 @@ void ColourPickingVisitor::processTriangleModel(simulation::Node * node, sofa::c
     glDisable(GL_BLEND);
     glEnable(GL_DEPTH_TEST);
 
+    unsigned int id = 0;
+    if (registry)
+    {
+        id = registry->getId(tmodel);
+        if (!id) return;
+        if (renderer)
+        {
+            renderer->drawTriangles(tmodel, id, method != ENCODE_RELATIVEPOSITION, method != ENCODE_COLLISIONELEMENT);
+            return;
+        }
+    }
+
     sofa::helper::vector<Vector3> points;
     sofa::helper::vector<Vector3> normals;
     sofa::helper::vector< Vec<4,float> > colours;
-    helper::vector<core::CollisionModel*> listCollisionModel;
-    helper::vector<core::CollisionModel*>::iterator iter;
-    float r,g;
+    float r = 0, g;
 
     int size = tmodel->getSize();
 
-    node->get< sofa::core::CollisionModel >( &listCollisionModel, BaseContext::SearchRoot);
-    iter = std::find(listCollisionModel.begin(), listCollisionModel.end(), tmodel);
-    const std::size_t totalCollisionModel = listCollisionModel.size();
-    const int indexCollisionModel = std::distance(listCollisionModel.begin(),iter ) + 1 ;
-
     switch( method )
     {
     case ENCODE_COLLISIONELEMENT:
-        r = (float)indexCollisionModel / (float)totalCollisionModel;
+    case ENCODE_COLLISIONELEMENT_AND_RELATIVEPOSITION: // no secondary colour without renderer
+        if (!registry) r = getModelCode(node, tmodel);
         for( int i=0 ; i<size; i++)
         {
             g = (float)i / (float)size;
+            const Vec<4,float> colour = registry ? ColourPickingRegistry::encodeColour(id, i) : Vec<4,float>(r,g,0,1);
             component::collision::Triangle t(tmodel,i);
             normals.push_back(t.n() );
             points.push_back( t.p1() );
             points.push_back( t.p2() );
             points.push_back( t.p3() );
-            colours.push_back( Vec<4,float>(r,g,0,1) );
-            colours.push_back( Vec<4,float>(r,g,0,1) );
-            colours.push_back( Vec<4,float>(r,g,0,1) );
+            colours.push_back( colour );
+            colours.push_back( colour );
+            colours.push_back( colour );
         }
         break;
     case ENCODE_RELATIVEPOSITION:
@@ -185,40 +218,43 @@ void ColourPickingVisitor::processSphereModel(simulation::Node * node, sofa::com
 
     if( method == ENCODE_RELATIVEPOSITION ) return; // we pick the center of the sphere.
 
-    helper::vector<core::CollisionModel*> listCollisionModel;
-
-    node->get< sofa::core::CollisionModel >( &listCollisionModel, BaseContext::SearchRoot);
-    const std::size_t totalCollisionModel = listCollisionModel.size();
-    helper::vector<core::CollisionModel*>::iterator iter = std::find(listCollisionModel.begin(), listCollisionModel.end(), smodel);
-    const int indexCollisionModel = std::distance(listCollisionModel.begin(),iter ) + 1 ;
-    float red = (float)indexCollisionModel / (float)totalCollisionModel;
-    // Check topological modifications
-
-    const int npoints = smodel->getMechanicalState()->getSize();
-    std::vector<Vector3> points;
-    std::vector<float> radius;
-    for (int i=0; i<npoints; i++)
-    {
-        Sphere t(smodel,i);
-        Coord p = t.p();
-        points.push_back(p);
-        radius.push_back((float)t.r());
-    }
+    const unsigned int id = registry ? registry->getId(smodel) : 0;
+    if (registry && !id) return;
     glDisable(GL_LIGHTING);
     glDisable(GL_COLOR_MATERIAL);
     glDisable(GL_DITHER);
     glDisable(GL_BLEND);
     glEnable(GL_DEPTH_TEST);
+    // the impostors leave the spheres they can not cover to the geometry below
+    std::vector<unsigned int> indices;
+    const int npoints = smodel->getMechanicalState()->getSize();
+    if (!renderer || !renderer->drawSpheres(smodel, id, indices))
+    {
+        indices.resize(npoints);
+        for (int i=0; i<npoints; i++) indices[i] = i;
+    }
+
+    const float red = registry ? 0.0f : getModelCode(node, smodel);
     float ratio;
-    for( int i=0; i<npoints; i++)
+    for (unsigned int k=0; k<indices.size(); k++)
     {
-        Vector3 p = points[i];
+        const int i = indices[k];
+        Sphere t(smodel,i);
+        Coord p = t.p();
 
         glPushMatrix();
         glTranslated(p[0], p[1], p[2]);
-        ratio = (float)i / (float)npoints;
-        glColor4f(red,ratio,0,1);
-        glutSolidSphere(radius[i], 32, 16);
+        if (registry)
+        {
+            const Vec<4,unsigned short> code = ColourPickingRegistry::encode(id, i);
+            glColor4us(code[0], code[1], code[2], code[3]);
+        }
+        else
+        {
+            ratio = (float)i / (float)npoints;
+            glColor4f(red,ratio,0,1);
+        }
+        glutSolidSphere(t.r(), 32, 16);
 
         glPopMatrix();
     }
@@ -26,6 +26,8 @@
 #define SOFA_GUI_COLOURPICKING_VISITOR
 
 #include "SofaGUI.h"
+#include "ColourPickingRegistry.h"
+#include "ColourPickingRenderer.h"
 #include <sofa/simulation/common/Node.h>
 #include <sofa/simulation/common/Visitor.h>
 #include <sofa/core/CollisionModel.h>
@@ -41,6 +43,7 @@ namespace gui
 {
 
 void decodeCollisionElement( const sofa::defaulttype::Vec4f colour, sofa::component::collision::BodyPicked& body );
+void decodeCollisionElement( const sofa::defaulttype::Vec4f colour, sofa::component::collision::BodyPicked& body, const ColourPickingRegistry& registry );
 void decodePosition( sofa::component::collision::BodyPicked& body, const sofa::defaulttype::Vec4f colour, const component::collision::TriangleModel* model,
         const unsigned int index);
 void decodePosition( sofa::component::collision::BodyPicked& body, const sofa::defaulttype::Vec4f colour, const component::collision::SphereModel* model,
@@ -57,6 +60,7 @@ public:
     {
         ENCODE_COLLISIONELEMENT,		///< The object colour encodes the pair CollisionModel - CollisionElement
         ENCODE_RELATIVEPOSITION,	///< The object colour encodes the relative position.
+        ENCODE_COLLISIONELEMENT_AND_RELATIVEPOSITION ///< Both, the relative position being given as secondary colour
     };
 
 
@@ -65,16 +69,25 @@ public:
     /// ENCODE_COLLISIONELEMENT Pass :
     ///   r channel : indexCollisionModel / totalCollisionModelInScene.
     ///   g channel : index of CollisionElement.
+    ///   (exact integer codes with a ColourPickingRegistry)
     /// ENCODE_RELATIVEPOSITION Pass :
     /// r,g,b channels encode the barycentric weights for a triangle model
+    /// ENCODE_COLLISIONELEMENT_AND_RELATIVEPOSITION Pass :
+    ///   single pass of both, for a shader writing in two render targets.
+    ///   Requires a registry and a renderer.
     virtual void drawColourPicking(const ColourCode /* method */) {}
 
     /// Picking related.
     /// For TriangleModels a,b,c encode the barycentric weights with respect to the vertex p1 p2 and p3 of
     /// the TriangleElement with the given index
-
-    ColourPickingVisitor(const core::visual::VisualParams* params, ColourCode Method)
-        :Visitor(params),vparams(params),method(Method)
+    ///
+    /// When a registry is given, the collision models are identified by their registry id
+    /// instead of their position in the list of the models of the scene, and the element
+    /// index is encoded exactly (see ColourPickingRegistry). The renderer keeps the
+    /// triangles on the GPU between the picking passes.
+    ColourPickingVisitor(const core::visual::VisualParams* params, ColourCode Method, const ColourPickingRegistry* Registry = NULL,
+            ColourPickingRenderer* Renderer = NULL)
+        :Visitor(params),vparams(params),method(Method),registry(Registry),renderer(Renderer)
     {}
 
     void processCollisionModel(simulation::Node* node, core::CollisionModel* /*o*/);
@@ -90,9 +103,13 @@ private:
 
     void processTriangleModel(simulation::Node*, sofa::component::collision::TriangleModel* );
     void processSphereModel(simulation::Node*, sofa::component::collision::SphereModel*);
+    /// red channel of the colour code of the model, when there is no registry
+    float getModelCode(simulation::Node*, core::CollisionModel*) const;
 
     const core::visual::VisualParams* vparams;
     ColourCode method;
+    const ColourPickingRegistry* registry;
+    ColourPickingRenderer* renderer;
 };
 
 
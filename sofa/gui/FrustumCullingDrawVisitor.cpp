@@ -0,0 +1,106 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "FrustumCullingDrawVisitor.h"
+
+namespace sofa
+{
+
+namespace gui
+{
+
+FrustumCullingDrawVisitor::FrustumCullingDrawVisitor(core::visual::VisualParams* params, const double* projection, const double* modelview)
+    : simulation::VisualDrawVisitor(params)
+    , prunedNode(NULL)
+    , nbVisitedNodes(0)
+    , nbCulledNodes(0)
+{
+    // clip = projection * modelview
+    double clip[16];
+    for (int c = 0; c < 4; ++c)
+        for (int r = 0; r < 4; ++r)
+        {
+            double v = 0;
+            for (int k = 0; k < 4; ++k)
+                v += projection[k*4+r] * modelview[c*4+k];
+            clip[c*4+r] = v;
+        }
+
+    // planes are combinations of the rows of the clip matrix
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            planes[2*i  ][c] = clip[c*4+3] + clip[c*4+i];
+            planes[2*i+1][c] = clip[c*4+3] - clip[c*4+i];
+        }
+    }
+}
+
+bool FrustumCullingDrawVisitor::isCulled(const sofa::defaulttype::BoundingBox& bbox) const
+{
+    if (!bbox.isValid())
+        return false;
+
+    const SReal* minBBox = bbox.minBBoxPtr();
+    const SReal* maxBBox = bbox.maxBBoxPtr();
+    for (int p = 0; p < 6; ++p)
+    {
+        const sofa::defaulttype::Vec<4,double>& plane = planes[p];
+        // corner of the box the furthest along the plane normal
+        double d = plane[3];
+        for (int c = 0; c < 3; ++c)
+            d += plane[c] * (plane[c] >= 0 ? maxBBox[c] : minBBox[c]);
+        if (d < 0)
+            return true;
+    }
+    return false;
+}
+
+simulation::Visitor::Result FrustumCullingDrawVisitor::processNodeTopDown(simulation::Node* node)
+{
+    ++nbVisitedNodes;
+    if (isCulled(node->f_bbox.getValue()))
+    {
+        ++nbCulledNodes;
+        prunedNode = node;
+        return RESULT_PRUNE;
+    }
+    return simulation::VisualDrawVisitor::processNodeTopDown(node);
+}
+
+void FrustumCullingDrawVisitor::processNodeBottomUp(simulation::Node* node)
+{
+    if (node == prunedNode)
+    {
+        // nothing was pushed by processNodeTopDown for this node
+        prunedNode = NULL;
+        return;
+    }
+    simulation::VisualDrawVisitor::processNodeBottomUp(node);
+}
+
+} // namespace gui
+
+} // namespace sofa
@@ -0,0 +1,75 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_FRUSTUMCULLINGDRAWVISITOR_H
+#define SOFA_GUI_FRUSTUMCULLINGDRAWVISITOR_H
+
+#include "SofaGUI.h"
+#include <sofa/simulation/common/VisualVisitor.h>
+#include <sofa/simulation/common/Node.h>
+#include <sofa/defaulttype/BoundingBox.h>
+#include <sofa/defaulttype/Vec.h>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+/// Draw the visual models of the scene, skipping the subtrees whose bounding box
+/// (Node::f_bbox) is fully outside of the view frustum.
+/// Nodes without a valid bounding box are always drawn.
+class SOFA_SOFAGUI_API FrustumCullingDrawVisitor : public simulation::VisualDrawVisitor
+{
+public:
+    /// projection and modelview are column-major OpenGL matrices
+    FrustumCullingDrawVisitor(core::visual::VisualParams* params, const double* projection, const double* modelview);
+
+    virtual Result processNodeTopDown(simulation::Node* node);
+    virtual void processNodeBottomUp(simulation::Node* node);
+
+    /// Return true if the box is fully outside of the frustum.
+    bool isCulled(const sofa::defaulttype::BoundingBox& bbox) const;
+
+    unsigned int getNbVisitedNodes() const { return nbVisitedNodes; }
+    unsigned int getNbCulledNodes() const { return nbCulledNodes; }
+
+    virtual const char* getClassName() const { return "FrustumCullingDrawVisitor"; }
+
+protected:
+    /// left, right, bottom, top, near and far planes, (a,b,c,d) with a*x+b*y+c*z+d >= 0 inside
+    sofa::defaulttype::Vec<4,double> planes[6];
+
+    /// node pruned by processNodeTopDown, whose processNodeBottomUp must be skipped too
+    simulation::Node* prunedNode;
+
+    unsigned int nbVisitedNodes;
+    unsigned int nbCulledNodes;
+};
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_FRUSTUMCULLINGDRAWVISITOR_H
@@ -0,0 +1,193 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "GLFrameProfiler.h"
+
+#include <iostream>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+using sofa::helper::system::thread::CTime;
+
+GLFrameProfiler::Section::Section(const std::string& name)
+    : name(name)
+    , cpuTime(0.0)
+    , gpuTime(-1.0)
+    , nbCalls(0)
+    , cpuStart(0)
+    , cpuAccum(0.0)
+    , nbCallsAccum(0)
+{
+}
+
+GLFrameProfiler::GLFrameProfiler()
+    : enabled(false)
+    , inFrame(false)
+    , frameCount(0)
+    , frame("Frame")
+{
+}
+
+GLFrameProfiler::~GLFrameProfiler()
+{
+    stopLog();
+}
+
+void GLFrameProfiler::setEnabled(bool e)
+{
+    enabled = e;
+}
+
+void GLFrameProfiler::begin(Section& s)
+{
+    if (s.timers.size() <= s.nbCallsAccum)
+        s.timers.resize(s.nbCallsAccum + 1);
+    s.timers[s.nbCallsAccum].begin();
+    s.cpuStart = CTime::getRefTime();
+}
+
+void GLFrameProfiler::end(Section& s)
+{
+    s.cpuAccum += (CTime::getRefTime() - s.cpuStart) * 1000.0 / CTime::getRefTicksPerSec();
+    s.timers[s.nbCallsAccum].end();
+    ++s.nbCallsAccum;
+}
+
+void GLFrameProfiler::collect(Section& s)
+{
+    s.cpuTime = s.cpuAccum;
+    s.nbCalls = s.nbCallsAccum;
+    s.cpuAccum = 0.0;
+    s.nbCallsAccum = 0;
+
+    // the timers of the calls that did not happen this frame keep their old result
+    double gpu = 0.0;
+    bool valid = s.nbCalls > 0;
+    for (unsigned int i = 0; i < s.nbCalls && i < s.timers.size(); ++i)
+    {
+        const double t = s.timers[i].getLastTime();
+        if (t < 0) valid = false;
+        else gpu += t;
+    }
+    s.gpuTime = valid ? gpu : -1.0;
+}
+
+void GLFrameProfiler::beginFrame()
+{
+    if (!enabled) return;
+    inFrame = true;
+    activeSections.clear();
+    begin(frame);
+}
+
+void GLFrameProfiler::endFrame()
+{
+    if (!inFrame) return;
+    while (!activeSections.empty())
+        endSection();
+    end(frame);
+    inFrame = false;
+
+    collect(frame);
+    for (unsigned int i = 0; i < sections.size(); ++i)
+        collect(sections[i]);
+    ++frameCount;
+
+    if (log.is_open())
+    {
+        writeLog(frame);
+        for (unsigned int i = 0; i < sections.size(); ++i)
+            if (sections[i].nbCalls)
+                writeLog(sections[i]);
+    }
+}
+
+void GLFrameProfiler::beginSection(const char* name)
+{
+    if (!inFrame) return;
+    unsigned int index = 0;
+    while (index < sections.size() && sections[index].name != name)
+        ++index;
+    if (index == sections.size())
+        sections.push_back(Section(name));
+    activeSections.push_back(index);
+    begin(sections[index]);
+}
+
+void GLFrameProfiler::endSection()
+{
+    if (!inFrame || activeSections.empty()) return;
+    end(sections[activeSections.back()]);
+    activeSections.pop_back();
+}
+
+bool GLFrameProfiler::startLog(const std::string& filename)
+{
+    stopLog();
+    log.open(filename.c_str());
+    if (!log.is_open())
+    {
+        std::cerr << "ERROR: can not write the frame times to " << filename << std::endl;
+        return false;
+    }
+    log << "frame,section,calls,cpu_ms,gpu_ms" << std::endl;
+    return true;
+}
+
+void GLFrameProfiler::stopLog()
+{
+    if (log.is_open())
+        log.close();
+}
+
+void GLFrameProfiler::writeLog(const Section& s)
+{
+    log << frameCount << ',' << s.name << ',' << s.nbCalls << ',' << s.cpuTime << ',';
+    if (s.gpuTime >= 0)
+        log << s.gpuTime;
+    log << '\n';
+}
+
+void GLFrameProfiler::release(Section& s)
+{
+    for (unsigned int i = 0; i < s.timers.size(); ++i)
+        s.timers[i].release();
+    s.timers.clear();
+}
+
+void GLFrameProfiler::release()
+{
+    release(frame);
+    for (unsigned int i = 0; i < sections.size(); ++i)
+        release(sections[i]);
+    inFrame = false;
+}
+
+} // namespace gui
+
+} // namespace sofa
@@ -0,0 +1,125 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_GLFRAMEPROFILER_H
+#define SOFA_GUI_GLFRAMEPROFILER_H
+
+#include "SofaGUI.h"
+#include "GLTimerQuery.h"
+#include <sofa/helper/system/thread/CTime.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+/// Measure the CPU and GPU time spent in the named sections of the frames
+/// drawn by a viewer.
+///
+/// A section can be entered several times per frame (once per stereo eye for
+/// instance), its times are then summed. Sections can be nested.
+/// The GPU times come from double-buffered timer queries, so they are those of
+/// a frame drawn two frames earlier than the CPU times.
+class SOFA_SOFAGUI_API GLFrameProfiler
+{
+public:
+    typedef sofa::helper::system::thread::ctime_t ctime_t;
+
+    struct Section
+    {
+        std::string name;
+        double cpuTime;   ///< milliseconds, last frame
+        double gpuTime;   ///< milliseconds, last completed frame, negative if unknown
+        unsigned int nbCalls;
+
+        Section(const std::string& name="");
+
+        // internal state of the current frame
+        ctime_t cpuStart;
+        double cpuAccum;
+        unsigned int nbCallsAccum;
+        std::vector<GLTimerQuery> timers; ///< one per call in the frame
+    };
+
+    /// Begin and end a section in the constructor and destructor.
+    class ScopedSection
+    {
+    public:
+        ScopedSection(GLFrameProfiler& profiler, const char* name) : profiler(profiler) { profiler.beginSection(name); }
+        ~ScopedSection() { profiler.endSection(); }
+    protected:
+        GLFrameProfiler& profiler;
+    };
+
+    GLFrameProfiler();
+    ~GLFrameProfiler();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled; }
+
+    void beginFrame();
+    void endFrame();
+
+    void beginSection(const char* name);
+    void endSection();
+
+    const std::vector<Section>& getSections() const { return sections; }
+    /// Whole frame, between beginFrame and endFrame
+    const Section& getFrame() const { return frame; }
+    unsigned int getFrameCount() const { return frameCount; }
+
+    /// Append the times of each frame to a CSV file, until stopLog is called.
+    bool startLog(const std::string& filename);
+    void stopLog();
+    bool isLogging() const { return log.is_open(); }
+
+    /// Release the GL resources. Must be called before the GL context is destroyed.
+    void release();
+
+protected:
+    void begin(Section& s);
+    void end(Section& s);
+    void collect(Section& s);
+    void writeLog(const Section& s);
+    void release(Section& s);
+
+    bool enabled;
+    bool inFrame;
+    unsigned int frameCount;
+    Section frame;
+    std::vector<Section> sections;
+    std::vector<unsigned int> activeSections;
+    std::ofstream log;
+};
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_GLFRAMEPROFILER_H
@@ -0,0 +1,118 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "GLTimerQuery.h"
+
+namespace sofa
+{
+
+namespace gui
+{
+
+GLTimerQuery::GLTimerQuery()
+    : current(0)
+    , lastTime(-1.0)
+    , newResult(false)
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        queries[i][0] = queries[i][1] = 0;
+        pending[i] = false;
+    }
+}
+
+GLTimerQuery::~GLTimerQuery()
+{
+}
+
+bool GLTimerQuery::isSupported()
+{
+#ifdef SOFA_HAVE_GLEW
+    return (GLEW_VERSION_3_3 || GLEW_ARB_timer_query) ? true : false;
+#else
+    return false;
+#endif
+}
+
+void GLTimerQuery::readResult(int buffer)
+{
+#ifdef SOFA_HAVE_GLEW
+    if (!pending[buffer]) return;
+    GLint available = 0;
+    glGetQueryObjectiv(queries[buffer][1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available)
+    {
+        GLuint64 t0 = 0, t1 = 0;
+        glGetQueryObjectui64v(queries[buffer][0], GL_QUERY_RESULT, &t0);
+        glGetQueryObjectui64v(queries[buffer][1], GL_QUERY_RESULT, &t1);
+        lastTime = (t1 - t0) * 1.0e-6;
+        newResult = true;
+    }
+    // if the result is still not available it is dropped, the queries are reused anyway
+    pending[buffer] = false;
+#else
+    (void)buffer;
+#endif
+}
+
+void GLTimerQuery::begin()
+{
+#ifdef SOFA_HAVE_GLEW
+    if (!isSupported()) return;
+    if (!queries[current][0])
+        glGenQueries(2, queries[current]);
+    readResult(current);
+    glQueryCounter(queries[current][0], GL_TIMESTAMP);
+#endif
+}
+
+void GLTimerQuery::end()
+{
+#ifdef SOFA_HAVE_GLEW
+    if (!queries[current][0]) return;
+    glQueryCounter(queries[current][1], GL_TIMESTAMP);
+    pending[current] = true;
+    current = 1 - current;
+#endif
+}
+
+void GLTimerQuery::release()
+{
+#ifdef SOFA_HAVE_GLEW
+    for (int i = 0; i < 2; ++i)
+    {
+        if (queries[i][0])
+            glDeleteQueries(2, queries[i]);
+        queries[i][0] = queries[i][1] = 0;
+        pending[i] = false;
+    }
+#endif
+    current = 0;
+    lastTime = -1.0;
+    newResult = false;
+}
+
+} // namespace gui
+
+} // namespace sofa
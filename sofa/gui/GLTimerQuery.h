@@ -0,0 +1,83 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_GLTIMERQUERY_H
+#define SOFA_GUI_GLTIMERQUERY_H
+
+#include "SofaGUI.h"
+#include <sofa/helper/system/gl.h>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+/// Measure the GPU time spent between begin() and end() with timestamp queries.
+///
+/// The queries are double-buffered: the result of a frame is only read back when
+/// the same query objects are reused two frames later, so the CPU never waits for
+/// the GPU. Timestamps (instead of GL_TIME_ELAPSED) allow several timers to overlap.
+class SOFA_SOFAGUI_API GLTimerQuery
+{
+public:
+    GLTimerQuery();
+    ~GLTimerQuery();
+
+    /// Return true if the current GL context supports timer queries.
+    static bool isSupported();
+
+    void begin();
+    void end();
+
+    /// GPU time in milliseconds of the last completed measure, or a negative value if none.
+    double getLastTime() const { return lastTime; }
+
+    /// Get the last completed measure if it was not already returned by a previous call.
+    bool popLastTime(double& time)
+    {
+        if (!newResult) return false;
+        time = lastTime;
+        newResult = false;
+        return true;
+    }
+
+    /// Release the GL resources. Must be called before the GL context is destroyed.
+    void release();
+
+protected:
+    void readResult(int buffer);
+
+    GLuint queries[2][2]; ///< [buffer][begin,end]
+    bool pending[2];
+    int current;
+    double lastTime;
+    bool newResult;
+};
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_GLTIMERQUERY_H
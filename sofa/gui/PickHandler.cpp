@@ -36,6 +36,7 @@
 #include <SofaMeshCollision/TriangleModel.h>
 #include <SofaBaseCollision/SphereModel.h>
 
+#include <algorithm>
 #include <iostream>
 #include <limits>
 
@@ -55,10 +56,29 @@ PickHandler::PickHandler():
     mouseNode(NULL),
     mouseContainer(NULL),
     mouseCollision(NULL),
+    narrowPhasePicking(true),
+    asynchronousPicking(true),
+    waitingAsynchronousResult(false),
+    lastPostedRay(0),
     renderCallback(NULL),
     pickingMethod(RAY_CASTING),
-    _fboAllocated(false)
+    _fboAllocated(false),
+    _fboFormatInitialized(false),
+    _fboWidth(0),
+    _fboHeight(0)
 {
+#ifndef SOFA_NO_OPENGL
+    _barycentricTexture = 0;
+    _pickingProgram = 0;
+    _readbackBuffer = 0;
+    _readbackBufferSize = 0;
+    _singlePassChecked = false;
+    _singlePassSupported = false;
+#ifdef SOFA_HAVE_GLEW
+    _readbackFence = NULL;
+#endif
+    _readbackX0 = _readbackY0 = _readbackW = _readbackH = 0;
+#endif
     operations[LEFT] = operations[MIDDLE] = operations[RIGHT] = NULL;
 }
 
@@ -87,11 +107,12 @@ PickHandler::~PickHandler()
 
 void PickHandler::allocateSelectionBuffer(int width, int height)
 {
-    /*called when shift key is pressed */
-    assert(_fboAllocated == false );
+    /*called when shift key is pressed and before each colour picking.
+      The buffer is kept until unload and only reallocated when the viewport is resized */
+    if (_fboAllocated && width == _fboWidth && height == _fboHeight) return;
+    if (_fboAllocated) destroySelectionBuffer();
 #ifndef SOFA_NO_OPENGL
-    static bool firstTime=true;
-    if (firstTime)
+    if (!_fboFormatInitialized)
     {
         _fboParams.depthInternalformat = GL_DEPTH_COMPONENT24;
 #if defined(GL_VERSION_3_0) && defined(SOFA_HAVE_GLEW)
@@ -108,23 +129,304 @@ void PickHandler::allocateSelectionBuffer(int width, int height)
         _fboParams.colorType           = GL_FLOAT;
 
         _fbo.setFormat(_fboParams);
-        firstTime=false;
+        _fboFormatInitialized=true;
     }
     _fbo.init(width,height);
+
+#ifdef SOFA_HAVE_GLEW
+    if (initSinglePassPicking())
+    {
+        glGenTextures(1, &_barycentricTexture);
+        glBindTexture(GL_TEXTURE_2D, _barycentricTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, _fboParams.colorInternalformat, width, height, 0, _fboParams.colorFormat, _fboParams.colorType, NULL);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+#endif
 #endif /* SOFA_NO_OPENGL */
+    _fboWidth = width;
+    _fboHeight = height;
     _fboAllocated = true;
 }
 
 void PickHandler::destroySelectionBuffer()
 {
-    /*called when shift key is released */
-    assert(_fboAllocated);
+    /*called on unload, or when the viewport is resized */
+    if (!_fboAllocated) return;
 #ifndef SOFA_NO_OPENGL
     _fbo.destroy();
+    if (_barycentricTexture)
+    {
+        glDeleteTextures(1, &_barycentricTexture);
+        _barycentricTexture = 0;
+    }
 #endif
     _fboAllocated = false;
 }
 
+#ifndef SOFA_NO_OPENGL
+namespace
+{
+#ifdef SOFA_HAVE_GLEW
+const char* pickingVertexShader =
+    "varying vec3 barycentric;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = ftransform();\n"
+    "    gl_FrontColor = gl_Color;\n"
+    "    barycentric = gl_SecondaryColor.rgb;\n"
+    "}\n";
+
+const char* pickingFragmentShader =
+    "varying vec3 barycentric;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_FragData[0] = gl_Color;\n"
+    "    gl_FragData[1] = vec4(barycentric, 1.0);\n"
+    "}\n";
+#endif
+
+/// half size of the region rendered around the cursor when picking
+const int pickingRegionRadius = 1;
+}
+
+bool PickHandler::initSinglePassPicking()
+{
+    if (_singlePassChecked) return _singlePassSupported;
+    _singlePassChecked = true;
+#ifdef SOFA_HAVE_GLEW
+    GLint maxDrawBuffers = 0;
+    if (GLEW_VERSION_2_1) glGetIntegerv(GL_MAX_DRAW_BUFFERS, &maxDrawBuffers);
+    if (maxDrawBuffers < 2) return false;
+
+    _pickingProgram = ColourPickingRenderer::createProgram(pickingVertexShader, pickingFragmentShader);
+    if (!_pickingProgram) return false;
+
+    glGenBuffers(1, &_readbackBuffer);
+    _readbackBufferSize = 0;
+    _singlePassSupported = true;
+#endif
+    return _singlePassSupported;
+}
+
+void PickHandler::releaseSinglePassPicking()
+{
+#ifdef SOFA_HAVE_GLEW
+    cancelColourPicking();
+    if (_pickingProgram) glDeleteProgram(_pickingProgram);
+    if (_readbackBuffer) glDeleteBuffers(1, &_readbackBuffer);
+#endif
+    _pickingProgram = 0;
+    _readbackBuffer = 0;
+    _singlePassChecked = false;
+    _singlePassSupported = false;
+}
+
+bool PickHandler::getPickingRegion(const helper::vector<MousePosition>& pixels, int& x0, int& y0, int& w, int& h) const
+{
+    // smallest region of the buffer containing all the pixels
+    x0 = _fboWidth;
+    y0 = _fboHeight;
+    int x1 = -1, y1 = -1;
+    for (unsigned int i=0; i<pixels.size(); ++i)
+    {
+        const int x = pixels[i].x;
+        const int y = pixels[i].screenHeight - pixels[i].y;
+        x0 = std::min(x0, x - pickingRegionRadius);
+        y0 = std::min(y0, y - pickingRegionRadius);
+        x1 = std::max(x1, x + pickingRegionRadius);
+        y1 = std::max(y1, y + pickingRegionRadius);
+    }
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, _fboWidth-1);
+    y1 = std::min(y1, _fboHeight-1);
+    w = x1-x0+1;
+    h = y1-y0+1;
+    return w > 0 && h > 0;
+}
+
+void PickHandler::decodeRegion(const helper::vector<MousePosition>& pixels, int x0, int y0, int w, int h,
+        const std::vector<GLfloat>& region,
+        helper::vector<sofa::defaulttype::Vec4f>& elements, helper::vector<sofa::defaulttype::Vec4f>& positions)
+{
+    for (unsigned int i=0; i<pixels.size(); ++i)
+    {
+        const int x = pixels[i].x - x0;
+        const int y = pixels[i].screenHeight - pixels[i].y - y0;
+        if (x < 0 || x >= w || y < 0 || y >= h) continue;
+        const GLfloat* element = &region[(y*w+x)*4];
+        const GLfloat* position = &region[(w*h + y*w+x)*4];
+        elements[i] = sofa::defaulttype::Vec4f(element[0], element[1], element[2], element[3]);
+        positions[i] = sofa::defaulttype::Vec4f(position[0], position[1], position[2], position[3]);
+    }
+}
+
+BodyPicked PickHandler::decodeColourCodes(const sofa::defaulttype::Vec4f& element, const sofa::defaulttype::Vec4f& position,
+        const defaulttype::Vector3& origin, const defaulttype::Vector3& direction) const
+{
+    BodyPicked result;
+    result.dist =  0;
+    decodeCollisionElement(element,result,colourPickingRegistry);
+    TriangleModel* tmodel;
+    SphereModel* smodel;
+    if( ( tmodel = TriangleModel::DynamicCast(result.body) ) != NULL )
+    {
+        decodePosition(result,position,tmodel,result.indexCollisionElement);
+    }
+    if( ( smodel = SphereModel::DynamicCast(result.body)) != NULL)
+    {
+        decodePosition(result, position,smodel,result.indexCollisionElement);
+    }
+    result.rayLength = (result.point-origin)*direction;
+    return result;
+}
+
+#ifdef SOFA_HAVE_GLEW
+void PickHandler::queueColourCodes(int x0, int y0, int w, int h)
+{
+    glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT1_EXT, GL_TEXTURE_2D, _barycentricTexture, 0);
+    const GLenum targets[2] = { GL_COLOR_ATTACHMENT0_EXT, GL_COLOR_ATTACHMENT1_EXT };
+    glDrawBuffers(2, targets);
+    glUseProgram(_pickingProgram);
+    renderCallback->render(ColourPickingVisitor::ENCODE_COLLISIONELEMENT_AND_RELATIVEPOSITION);
+    glUseProgram(0);
+    glDrawBuffer(GL_COLOR_ATTACHMENT0_EXT);
+
+    // both targets are copied in the pixel buffer, the copy is only waited for when it is mapped
+    const GLsizeiptr size = 2*w*h*4*sizeof(GLfloat);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, _readbackBuffer);
+    if (size > _readbackBufferSize)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        _readbackBufferSize = size;
+    }
+    glReadBuffer(GL_COLOR_ATTACHMENT0_EXT);
+    glReadPixels(x0,y0,w,h,GL_RGBA,GL_FLOAT,(GLvoid*)0);
+    glReadBuffer(GL_COLOR_ATTACHMENT1_EXT);
+    glReadPixels(x0,y0,w,h,GL_RGBA,GL_FLOAT,(GLvoid*)(w*h*4*sizeof(GLfloat)));
+    glReadBuffer(GL_COLOR_ATTACHMENT0_EXT);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT1_EXT, GL_TEXTURE_2D, 0, 0);
+}
+
+void PickHandler::mapColourCodes(std::vector<GLfloat>& region)
+{
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, _readbackBuffer);
+    const GLfloat* data = (const GLfloat*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (data)
+    {
+        std::copy(data, data+region.size(), region.begin());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+bool PickHandler::queueColourPicking(BodyPicked& previous)
+{
+    if (!renderCallback || !(GLEW_VERSION_3_2 || GLEW_ARB_sync)) return false;
+    if (mousePosition.screenWidth > 0 && mousePosition.screenHeight > 0)
+        allocateSelectionBuffer(mousePosition.screenWidth, mousePosition.screenHeight);
+    if (!_fboAllocated || !_barycentricTexture) return false;
+
+    // the element of the previous position is used until the readback of this one is done
+    previous = lastPicked;
+    if (_readbackFence)
+    {
+        if (waitingAsynchronousResult) takeColourPicking(previous, true);
+        else cancelColourPicking();
+    }
+
+    helper::vector<MousePosition> pixels(1, mousePosition);
+    int x0, y0, w, h;
+    if (!getPickingRegion(pixels, x0, y0, w, h))
+    {
+        previous = BodyPicked();
+        return true;
+    }
+    _fbo.start();
+    glPushAttrib(GL_SCISSOR_BIT);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(x0, y0, w, h);
+    queueColourCodes(x0, y0, w, h);
+    glPopAttrib();
+    _fbo.stop();
+    _readbackFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // start the execution of the commands, without waiting for them
+    glFlush();
+
+    _readbackX0 = x0;
+    _readbackY0 = y0;
+    _readbackW = w;
+    _readbackH = h;
+    _readbackPixel = mousePosition;
+    _readbackOrigin = mouseCollision->getRay(0).origin();
+    _readbackDirection = mouseCollision->getRay(0).direction();
+    return true;
+}
+
+bool PickHandler::takeColourPicking(BodyPicked& result, bool wait)
+{
+    if (!_readbackFence) return false;
+    if (!wait && glClientWaitSync(_readbackFence, 0, 0) == GL_TIMEOUT_EXPIRED) return false;
+    cancelColourPicking();
+
+    std::vector<GLfloat> region(2*_readbackW*_readbackH*4);
+    mapColourCodes(region);
+    helper::vector<MousePosition> pixels(1, _readbackPixel);
+    helper::vector<sofa::defaulttype::Vec4f> elements(1), positions(1);
+    decodeRegion(pixels, _readbackX0, _readbackY0, _readbackW, _readbackH, region, elements, positions);
+    result = decodeColourCodes(elements[0], positions[0], _readbackOrigin, _readbackDirection);
+    return true;
+}
+
+void PickHandler::cancelColourPicking()
+{
+    if (!_readbackFence) return;
+    glDeleteSync(_readbackFence);
+    _readbackFence = NULL;
+}
+#endif
+
+void PickHandler::readColourCodes(const helper::vector<MousePosition>& pixels,
+        helper::vector<sofa::defaulttype::Vec4f>& elements, helper::vector<sofa::defaulttype::Vec4f>& positions)
+{
+    elements.assign(pixels.size(), sofa::defaulttype::Vec4f(0,0,0,0));
+    positions.assign(pixels.size(), sofa::defaulttype::Vec4f(0,0,0,0));
+    if (pixels.empty()) return;
+
+    int x0, y0, w, h;
+    if (!getPickingRegion(pixels, x0, y0, w, h)) return;
+
+    glPushAttrib(GL_SCISSOR_BIT);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(x0, y0, w, h);
+
+    std::vector<GLfloat> region(2*w*h*4);
+#ifdef SOFA_HAVE_GLEW
+    if (_barycentricTexture)
+    {
+        // the pixel buffer is reused, a readback queued for the mouse moves is dropped
+        cancelColourPicking();
+        waitingAsynchronousResult = false;
+        queueColourCodes(x0, y0, w, h);
+        mapColourCodes(region);
+    }
+    else
+#endif
+    {
+        renderCallback->render(ColourPickingVisitor::ENCODE_COLLISIONELEMENT );
+        glReadPixels(x0,y0,w,h,_fboParams.colorFormat,_fboParams.colorType,&region[0]);
+        renderCallback->render(ColourPickingVisitor::ENCODE_RELATIVEPOSITION );
+        glReadPixels(x0,y0,w,h,_fboParams.colorFormat,_fboParams.colorType,&region[w*h*4]);
+    }
+    glPopAttrib();
+
+    decodeRegion(pixels, x0, y0, w, h, region, elements, positions);
+}
+#endif /* SOFA_NO_OPENGL */
+
 
 void PickHandler::init(core::objectmodel::BaseNode* root)
 {
@@ -165,6 +467,15 @@ void PickHandler::init(core::objectmodel::BaseNode* root)
     root->getContext()->get(pipeline, core::objectmodel::BaseContext::SearchRoot);
 
     useCollisions = (pipeline != NULL);
+
+    pickingService.clear();
+    lastAsynchronousResult = PickingService::Result();
+    waitingAsynchronousResult = false;
+    // the picking index follows the scene from now on, so that findCollisions can answer
+    // outside of an interaction session too
+    pickingService.attach(simulation::Node::DynamicCast(root), mouseNode.get());
+    pickingNarrowPhase.attach(simulation::Node::DynamicCast(root), mouseNode.get(), mouseCollision.get());
+    colourPickingRegistry.attach(simulation::Node::DynamicCast(root));
 }
 
 void PickHandler::reset()
@@ -188,6 +499,21 @@ void PickHandler::unload()
     }
     instanceComponents.clear();
 
+    pickingService.stop();
+    pickingService.clear();
+    pickingNarrowPhase.clear();
+    lastAsynchronousResult = PickingService::Result();
+    waitingAsynchronousResult = false;
+    colourPickingRegistry.detach();
+}
+
+void PickHandler::releaseGL()
+{
+#ifndef SOFA_NO_OPENGL
+    colourPickingRenderer.release();
+    destroySelectionBuffer();
+    releaseSinglePassPicking();
+#endif
 }
 
 Operation *PickHandler::changeOperation(sofa::component::configurationsetting::MouseButtonSetting* setting)
@@ -213,6 +539,11 @@ void PickHandler::activateRay(int width, int height, core::objectmodel::BaseNode
 {
     if (!interactorInUse)
     {
+        // follow the pickable components of the scene, the mouse node is not pickable
+        pickingService.attach(simulation::Node::DynamicCast(root), mouseNode.get());
+        pickingNarrowPhase.attach(simulation::Node::DynamicCast(root), mouseNode.get(), mouseCollision.get());
+        updateMouseCollisionActivity();
+        if (asynchronousPicking) pickingService.start();
         root->addChild(mouseNode);
         interaction->attach(mouseNode.get());
         if( pickingMethod == SELECTION_BUFFER)
@@ -235,15 +566,26 @@ void PickHandler::deactivateRay()
 
         interaction->mouseInteractor->cleanup();
         interaction->detach();
-        if( pickingMethod == SELECTION_BUFFER)
-        {
-            destroySelectionBuffer();
-        }
         interactorInUse=false;
+        waitingAsynchronousResult = false;
+        mouseCollision->setActive(true);
     }
 
 }
 
+void PickHandler::setNarrowPhasePicking(bool b)
+{
+    narrowPhasePicking = b;
+    if (interactorInUse) updateMouseCollisionActivity();
+}
+
+void PickHandler::updateMouseCollisionActivity()
+{
+    // the narrow phase answers the picking by itself: the pipeline does not need to
+    // compute the contacts of the mouse ray at each step
+    mouseCollision->setActive(!(narrowPhasePicking && pickingNarrowPhase.isReady()));
+}
+
 
 
 
@@ -303,13 +645,7 @@ void PickHandler::updateRay(const sofa::defaulttype::Vector3 &position,const sof
     if (needToCastRay())
     {
         lastPicked=findCollision();
-        setCompatibleInteractor();
-        interaction->mouseInteractor->setMouseRayModel(mouseCollision.get());
-        interaction->mouseInteractor->setBodyPicked(lastPicked);
-        for (unsigned int i=0; i<callbacks.size(); ++i)
-        {
-            callbacks[i]->execute(lastPicked);
-        }
+        notifyPicked();
     }
 
     if(mouseButton != NONE)
@@ -344,6 +680,44 @@ void PickHandler::updateRay(const sofa::defaulttype::Vector3 &position,const sof
     }
 }
 
+void PickHandler::notifyPicked()
+{
+    setCompatibleInteractor();
+    interaction->mouseInteractor->setMouseRayModel(mouseCollision.get());
+    interaction->mouseInteractor->setBodyPicked(lastPicked);
+    for (unsigned int i=0; i<callbacks.size(); ++i)
+    {
+        callbacks[i]->execute(lastPicked);
+    }
+}
+
+bool PickHandler::pollAsynchronousResult()
+{
+    if (!interactorInUse || !waitingAsynchronousResult) return false;
+#if !defined(SOFA_NO_OPENGL) && defined(SOFA_HAVE_GLEW)
+    if (pickingMethod == SELECTION_BUFFER)
+    {
+        BodyPicked picked;
+        if (!takeColourPicking(picked, false)) return false;
+        waitingAsynchronousResult = false;
+        lastPicked = picked;
+        pickingNarrowPhase.resetStats();
+        notifyPicked();
+        return true;
+    }
+#endif
+    PickingService::Result answer;
+    if (!pickingService.takeResult(answer)) return false;
+    // an older ray is still closer to the cursor than the previous answer
+    if (answer.rayId == lastPostedRay) waitingAsynchronousResult = false;
+    if (!pickingService.isValid(answer)) answer = PickingService::Result();
+    lastAsynchronousResult = answer;
+    lastPicked = answer.found ? toBodyPicked(answer.hit) : BodyPicked();
+    pickingNarrowPhase.resetStats();
+    notifyPicked();
+    return true;
+}
+
 //Clear the node create, and destroy all its components
 void PickHandler::handleMouseEvent(MOUSE_STATUS status, MOUSE_BUTTON button)
 {
@@ -364,19 +738,32 @@ ComponentMouseInteraction *PickHandler::getInteraction()
 component::collision::BodyPicked PickHandler::findCollision()
 {
     BodyPicked result;
+    waitingAsynchronousResult = false;
+    pickingNarrowPhase.resetStats();
     switch( pickingMethod)
     {
     case RAY_CASTING:
         if (useCollisions)
         {
-            component::collision::BodyPicked picked=findCollisionUsingPipeline();
+            component::collision::BodyPicked picked;
+            if (narrowPhasePicking && pickingNarrowPhase.isReady()) picked=findCollisionUsingNarrowPhase();
+            else picked=findCollisionUsingPipeline();
             if (picked.body) result = picked;
-            else result = findCollisionUsingBruteForce();
+            else result = findCollisionUsingBVH();
         }
         else
-            result = findCollisionUsingBruteForce();
+            result = findCollisionUsingBVH();
         break;
     case SELECTION_BUFFER:
+#if !defined(SOFA_NO_OPENGL) && defined(SOFA_HAVE_GLEW)
+        // the moves read the selection buffer back without waiting for the GPU, the
+        // codes of this position are decoded by pollAsynchronousResult
+        if (asynchronousPicking && mouseStatus != PRESSED && queueColourPicking(result))
+        {
+            waitingAsynchronousResult = true;
+            break;
+        }
+#endif
         result = findCollisionUsingColourCoding();
         break;
     default:
@@ -447,13 +834,60 @@ component::collision::BodyPicked PickHandler::findCollisionUsingPipeline()
     return result;
 }
 
-component::collision::BodyPicked PickHandler::findCollisionUsingBruteForce()
+component::collision::BodyPicked PickHandler::findCollisionUsingNarrowPhase()
+{
+    const defaulttype::Vector3& origin          = mouseCollision->getRay(0).origin();
+    const defaulttype::Vector3& direction       = mouseCollision->getRay(0).direction();
+    const double& maxLength                     = mouseCollision->getRay(0).l();
+
+    return pickingNarrowPhase.intersect(origin, direction, maxLength);
+}
+
+component::collision::BodyPicked PickHandler::findCollisionUsingBVH()
 {
     const defaulttype::Vector3& origin          = mouseCollision->getRay(0).origin();
     const defaulttype::Vector3& direction       = mouseCollision->getRay(0).direction();
     const double& maxLength                     = mouseCollision->getRay(0).l();
 
-    return findCollisionUsingBruteForce(origin, direction, maxLength, mouseNode->getRoot());
+    BodyPicked result;
+    PickingBVH::Hit hit;
+    bool found;
+    if (asynchronousPicking && pickingService.isRunning() && mouseStatus != PRESSED)
+    {
+        // never wait for a running query, the positions are copied at the next move
+        pickingService.updateSnapshot(false);
+        lastPostedRay = pickingService.post(origin, direction, maxLength);
+        PickingService::Result answer;
+        if (pickingService.takeResult(answer)) lastAsynchronousResult = answer;
+        // the picked component may have been removed since the query
+        if (!pickingService.isValid(lastAsynchronousResult)) lastAsynchronousResult = PickingService::Result();
+        // the answer of this ray is applied by pollAsynchronousResult
+        waitingAsynchronousResult = true;
+        found = lastAsynchronousResult.found;
+        hit = lastAsynchronousResult.hit;
+    }
+    else
+    {
+        pickingService.updateSnapshot();
+        found = pickingService.pick(origin, direction, maxLength, hit);
+    }
+    if (found) result = toBodyPicked(hit);
+    return result;
+}
+
+component::collision::BodyPicked PickHandler::toBodyPicked(const PickingBVH::Hit& hit)
+{
+    BodyPicked result;
+    result.body = hit.model;
+    result.mstate = hit.mstate;
+    result.indexCollisionElement = hit.index;
+    result.point = hit.point;
+#ifdef DETECTIONOUTPUT_BARYCENTRICINFO
+    if (hit.model) result.baryCoords = hit.baryCoords;
+#endif
+    result.dist = 0;
+    result.rayLength = hit.rayLength;
+    return result;
 }
 
 component::collision::BodyPicked PickHandler::findCollisionUsingColourCoding()
@@ -496,36 +930,78 @@ component::collision::BodyPicked PickHandler::findCollisionUsingBruteForce(const
 component::collision::BodyPicked PickHandler::findCollisionUsingColourCoding(const defaulttype::Vector3& origin,
         const defaulttype::Vector3& direction)
 {
-    assert(_fboAllocated);
-    BodyPicked result;
+    helper::vector<PickingRay> rays(1);
+    rays[0].origin = origin;
+    rays[0].direction = direction;
+    rays[0].maxLength = std::numeric_limits<double>::max();
+    rays[0].mouse = mousePosition;
+    helper::vector<BodyPicked> results;
+    findCollisionsUsingColourCoding(rays, results);
+    return results[0];
+}
+
+void PickHandler::findCollisionsUsingColourCoding(const helper::vector<PickingRay>& rays, helper::vector<BodyPicked>& results)
+{
+    results.clear();
+    results.resize(rays.size());
 #ifndef SOFA_NO_OPENGL
-    result.dist =  0;
-    sofa::defaulttype::Vec4f color;
-    int x = mousePosition.x;
-    int y = mousePosition.screenHeight - mousePosition.y;
-    TriangleModel* tmodel;
-    SphereModel* smodel;
+    if (rays.empty()) return;
+    // follow the resizes of the viewport while shift is pressed
+    const MousePosition& screen = rays[0].mouse;
+    if (screen.screenWidth > 0 && screen.screenHeight > 0)
+        allocateSelectionBuffer(screen.screenWidth, screen.screenHeight);
+    if (!_fboAllocated)
+    {
+        std::cerr << "PickHandler: no selection buffer, the viewport size is unknown" << std::endl;
+        return;
+    }
+
+    helper::vector<MousePosition> pixels(rays.size());
+    for (unsigned int i=0; i<rays.size(); ++i) pixels[i] = rays[i].mouse;
+    helper::vector<sofa::defaulttype::Vec4f> colors, positions;
     _fbo.start();
     if(renderCallback)
     {
-        renderCallback->render(ColourPickingVisitor::ENCODE_COLLISIONELEMENT );
-        glReadPixels(x,y,1,1,_fboParams.colorFormat,_fboParams.colorType,color.elems);
-        decodeCollisionElement(color,result);
-        renderCallback->render(ColourPickingVisitor::ENCODE_RELATIVEPOSITION );
-        glReadPixels(x,y,1,1,_fboParams.colorFormat,_fboParams.colorType,color.elems);
-        if( ( tmodel = TriangleModel::DynamicCast(result.body) ) != NULL )
-        {
-            decodePosition(result,color,tmodel,result.indexCollisionElement);
-        }
-        if( ( smodel = SphereModel::DynamicCast(result.body)) != NULL)
-        {
-            decodePosition(result, color,smodel,result.indexCollisionElement);
-        }
-        result.rayLength = (result.point-origin)*direction;
+        readColourCodes(pixels,colors,positions);
+        for (unsigned int i=0; i<rays.size(); ++i)
+            results[i] = decodeColourCodes(colors[i], positions[i], rays[i].origin, rays[i].direction);
     }
     _fbo.stop();
 #endif /* SOFA_NO_OPENGL */
-    return result;
+}
+
+void PickHandler::findCollisions(const helper::vector<PickingRay>& rays, helper::vector<BodyPicked>& results)
+{
+    if (pickingMethod == SELECTION_BUFFER)
+    {
+        findCollisionsUsingColourCoding(rays, results);
+        return;
+    }
+    if (!pickingService.getRoot())
+    {
+        std::cerr << "PickHandler: no scene to pick in, init has not been called" << std::endl;
+        results.clear();
+        results.resize(rays.size());
+        return;
+    }
+
+    std::vector<PickingService::Query> queries(rays.size());
+    for (unsigned int i=0; i<rays.size(); ++i)
+    {
+        queries[i].origin = rays[i].origin;
+        queries[i].direction = rays[i].direction;
+        queries[i].maxLength = rays[i].maxLength;
+    }
+    std::vector<PickingService::Result> answers;
+    pickingService.updateSnapshot();
+    pickingService.pick(queries, answers);
+
+    results.clear();
+    results.resize(rays.size());
+    for (unsigned int i=0; i<rays.size(); ++i)
+    {
+        if (answers[i].found) results[i] = toBodyPicked(answers[i].hit);
+    }
 }
 
 
@@ -30,6 +30,9 @@
 
 
 #include "ColourPickingVisitor.h"
+#include "ColourPickingRegistry.h"
+#include "PickingService.h"
+#include "PickingNarrowPhase.h"
 
 #include <sofa/simulation/common/Simulation.h>
 #include <sofa/simulation/common/Node.h>
@@ -44,6 +47,7 @@
 #include <sofa/helper/fixed_array.h>
 #include <sofa/helper/gl/FrameBufferObject.h>
 #include <functional>
+#include <limits>
 
 
 namespace sofa
@@ -99,8 +103,14 @@ public:
     void activateRay(int width, int height, core::objectmodel::BaseNode* root);
     void deactivateRay();
 
+    /// Allocate the selection buffer, or resize it if the viewport size changed.
+    /// The buffer is kept between the picking sessions and released by releaseGL.
     void allocateSelectionBuffer(int width, int height);
     void destroySelectionBuffer();
+    /// Release the GL resources of the colour picking (selection buffer, programs,
+    /// readback buffer and model buffers). Must be called by the viewer with its GL
+    /// context current, on unload and before it is destroyed.
+    void releaseGL();
 
 
     void setPickingMethod(PickingMethod method) { pickingMethod = method; }
@@ -108,6 +118,14 @@ public:
 
     void updateRay(const sofa::defaulttype::Vector3 &position, const sofa::defaulttype::Vector3 &orientation);
 
+    /// Apply the answer of the picking service or of the selection buffer readback to
+    /// the last picked element, if it arrived after the mouse stopped. To be called
+    /// regularly by the thread of the GUI, with the GL context of the viewer current,
+    /// while isWaitingAsynchronousResult() is true. Return true if the picked element
+    /// was updated.
+    bool pollAsynchronousResult();
+    bool isWaitingAsynchronousResult() const { return waitingAsynchronousResult; }
+
     void handleMouseEvent( MOUSE_STATUS status, MOUSE_BUTTON button);
 
     void init(core::objectmodel::BaseNode* root);
@@ -131,13 +149,52 @@ public:
     helper::vector< CallBackPicker* > getCallBackPicker() {return callbacks;}
     void clearCallBacks() {for (unsigned int i=0; i<callbacks.size(); ++i) callbacks.clear();}
 
+    /// Ray of a batch query. The window position is only used by the selection buffer.
+    struct PickingRay
+    {
+        PickingRay() : maxLength(std::numeric_limits<double>::max()) { mouse.x = mouse.y = mouse.screenWidth = mouse.screenHeight = 0; }
+        defaulttype::Vector3 origin;
+        defaulttype::Vector3 direction;
+        double maxLength;
+        MousePosition mouse;
+    };
+
+    /// Pick along many rays at once (lasso selection, area probes...), one result per ray.
+    /// Ray casting answers them in parallel with the picking index, the selection buffer
+    /// renders the region containing all the window positions once.
+    /// The scene must have been given to init, rays without hit get an empty BodyPicked.
+    void findCollisions(const helper::vector<PickingRay>& rays, helper::vector<BodyPicked>& results);
+
     static BodyPicked findCollisionUsingBruteForce(const defaulttype::Vector3& origin, const defaulttype::Vector3& direction, double maxLength, core::objectmodel::BaseNode* root);
     BodyPicked findCollisionUsingColourCoding(const defaulttype::Vector3& origin, const defaulttype::Vector3& direction);
 
     ComponentMouseInteraction           *getInteraction();
     BodyPicked                          *getLastPicked() {return &lastPicked;}
+    const ColourPickingRegistry         &getColourPickingRegistry() const {return colourPickingRegistry;}
+    PickingService                      &getPickingService() {return pickingService;}
+
+    /// Answer the mouse moves in the thread of the picking service, the picked element
+    /// lagging behind the cursor until the query is done. Presses are always answered
+    /// synchronously. Used for ray casting without a collision pipeline hit, and for the
+    /// readback of the selection buffer when the GL fences are supported.
+    void setAsynchronousPicking(bool b) { asynchronousPicking = b; }
+    bool useAsynchronousPicking() const { return asynchronousPicking; }
+    /// Timestamps of the result used by the last asynchronous picking
+    const PickingService::Result        &getLastAsynchronousResult() const {return lastAsynchronousResult;}
+    ColourPickingRenderer               *getColourPickingRenderer() {return &colourPickingRenderer;}
+
+    /// With a collision pipeline, intersect the ray with the candidates of the last
+    /// broad phase instead of reading the contacts of the mouse ray model, which is then
+    /// left out of the pipeline.
+    void setNarrowPhasePicking(bool b);
+    bool useNarrowPhasePicking() const { return narrowPhasePicking; }
+    /// Counters and duration of the last narrow phase query
+    const PickingNarrowPhase::Stats     &getLastNarrowPhaseStats() const {return pickingNarrowPhase.getLastStats();}
 
 protected:
+    /// Keep the mouse ray out of the pipeline while the narrow phase answers the picking
+    void updateMouseCollisionActivity();
+
     bool interactorInUse;
     MOUSE_STATUS mouseStatus;
     MOUSE_BUTTON mouseButton;
@@ -152,6 +209,54 @@ protected:
 #ifndef SOFA_NO_OPENGL
     sofa::helper::gl::FrameBufferObject _fbo;
     sofa::helper::gl::fboParameters     _fboParams;
+
+    /// second render target of the single pass picking, receiving the barycentric weights
+    GLuint _barycentricTexture;
+    /// shader writing the element code and the barycentric weights in the two targets
+    GLuint _pickingProgram;
+    /// pixel buffer receiving both targets in one readback
+    GLuint _readbackBuffer;
+    GLsizeiptr _readbackBufferSize;
+    bool   _singlePassChecked;
+    bool   _singlePassSupported;
+
+    bool initSinglePassPicking();
+    void releaseSinglePassPicking();
+    /// Render the colour codes around the pixels and read the codes of each of them
+    void readColourCodes(const helper::vector<MousePosition>& pixels,
+            helper::vector<sofa::defaulttype::Vec4f>& elements, helper::vector<sofa::defaulttype::Vec4f>& positions);
+    /// Smallest region of the selection buffer around the pixels, false if it is empty
+    bool getPickingRegion(const helper::vector<MousePosition>& pixels, int& x0, int& y0, int& w, int& h) const;
+    /// Codes of each pixel in a region read back from both targets
+    static void decodeRegion(const helper::vector<MousePosition>& pixels, int x0, int y0, int w, int h,
+            const std::vector<GLfloat>& region,
+            helper::vector<sofa::defaulttype::Vec4f>& elements, helper::vector<sofa::defaulttype::Vec4f>& positions);
+    BodyPicked decodeColourCodes(const sofa::defaulttype::Vec4f& element, const sofa::defaulttype::Vec4f& position,
+            const defaulttype::Vector3& origin, const defaulttype::Vector3& direction) const;
+
+    /// region and ray of the readback queued for the last mouse move
+    int _readbackX0, _readbackY0, _readbackW, _readbackH;
+    MousePosition _readbackPixel;
+    defaulttype::Vector3 _readbackOrigin;
+    defaulttype::Vector3 _readbackDirection;
+#ifdef SOFA_HAVE_GLEW
+    /// signaled when the queued readback is in the pixel buffer, NULL if none is queued
+    GLsync _readbackFence;
+
+    /// Render both targets of the single pass picking in the region, and queue their
+    /// copy in the pixel buffer. The selection buffer must be started.
+    void queueColourCodes(int x0, int y0, int w, int h);
+    /// Copy the pixel buffer, waiting for the queued copy if it is not done
+    void mapColourCodes(std::vector<GLfloat>& region);
+    /// Queue the readback of the codes under the mouse, and fence it. previous is the
+    /// element to use until it is done. Return false if fences or the single pass
+    /// picking are not supported.
+    bool queueColourPicking(BodyPicked& previous);
+    /// Decode the queued readback. Without wait, return false if it is not done.
+    bool takeColourPicking(BodyPicked& result, bool wait);
+    /// Drop the queued readback
+    void cancelColourPicking();
+#endif
 #endif
 
     ComponentMouseInteraction *interaction;
@@ -162,6 +267,23 @@ protected:
 
     bool useCollisions;
 
+    /// ray query against the collision models, used instead of the pipeline contacts
+    PickingNarrowPhase pickingNarrowPhase;
+    bool narrowPhasePicking;
+
+    /// index of the pickable elements, used when the collision pipeline finds nothing
+    PickingService pickingService;
+    bool asynchronousPicking;
+    /// latest answer of the picking service, used until the next one arrives
+    PickingService::Result lastAsynchronousResult;
+    /// the last ray was posted to the picking service and its answer is not applied yet
+    bool waitingAsynchronousResult;
+    unsigned int lastPostedRay;
+
+    /// identifiers of the collision models in the selection buffer
+    ColourPickingRegistry colourPickingRegistry;
+    /// selection buffer geometry, kept between the picking events
+    ColourPickingRenderer colourPickingRenderer;
 
 
     //NONE is the number of Operations in use.
@@ -174,15 +296,23 @@ protected:
     PickingMethod pickingMethod;
 
     bool _fboAllocated;
+    bool _fboFormatInitialized;
+    int  _fboWidth;
+    int  _fboHeight;
 
 
     BodyPicked findCollision();
     BodyPicked findCollisionUsingPipeline();
-    BodyPicked findCollisionUsingBruteForce();
+    BodyPicked findCollisionUsingNarrowPhase();
+    BodyPicked findCollisionUsingBVH();
+    void findCollisionsUsingColourCoding(const helper::vector<PickingRay>& rays, helper::vector<BodyPicked>& results);
+    static BodyPicked toBodyPicked(const PickingBVH::Hit& hit);
     BodyPicked findCollisionUsingColourCoding();
 
     bool needToCastRay();
     void setCompatibleInteractor();
+    /// Give lastPicked to the interactor and to the callbacks
+    void notifyPicked();
 
 
 };
@@ -0,0 +1,572 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "PickingBVH.h"
+
+#include <SofaMeshCollision/TriangleModel.h>
+#include <SofaBaseCollision/SphereModel.h>
+#include <sofa/core/objectmodel/BaseContext.h>
+#include <sofa/core/objectmodel/Tag.h>
+#include <sofa/core/VecId.h>
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+using namespace sofa::component::collision;
+using sofa::defaulttype::Vector3;
+
+namespace
+{
+
+const unsigned int MaxLeafSize = 4;
+
+/// Moller-Trumbore ray/triangle intersection
+bool intersectTriangle(const Vector3& origin, const Vector3& direction,
+        const Vector3& p1, const Vector3& p2, const Vector3& p3, double& t, double& u, double& v)
+{
+    const Vector3 e1 = p2 - p1;
+    const Vector3 e2 = p3 - p1;
+    const Vector3 p = direction.cross(e2);
+    const double det = e1 * p;
+    if (std::fabs(det) < std::numeric_limits<double>::epsilon() * e1.norm2() * e2.norm2()) return false;
+    const double invDet = 1.0 / det;
+    const Vector3 s = origin - p1;
+    u = (s * p) * invDet;
+    if (u < 0.0 || u > 1.0) return false;
+    const Vector3 q = s.cross(e1);
+    v = (direction * q) * invDet;
+    if (v < 0.0 || u + v > 1.0) return false;
+    t = (e2 * q) * invDet;
+    return t >= 0.0;
+}
+
+bool intersectSphere(const Vector3& origin, const Vector3& direction, const Vector3& center, double r, double& t)
+{
+    const Vector3 oc = origin - center;
+    const double b = oc * direction;
+    const double c = oc.norm2() - r*r;
+    const double delta = b*b - c;
+    if (delta < 0.0) return false;
+    const double sq = std::sqrt(delta);
+    t = -b - sq;
+    // origin inside the sphere
+    if (t < 0.0) t = -b + sq;
+    return t >= 0.0;
+}
+
+/// Order elements by the center of their box along one axis
+struct CenterCompare
+{
+    const std::vector<Vector3>& minBBox;
+    const std::vector<Vector3>& maxBBox;
+    int axis;
+    CenterCompare(const std::vector<Vector3>& minB, const std::vector<Vector3>& maxB, int a)
+        : minBBox(minB), maxBBox(maxB), axis(a) {}
+    bool operator()(unsigned int a, unsigned int b) const
+    {
+        return minBBox[a][axis] + maxBBox[a][axis] < minBBox[b][axis] + maxBBox[b][axis];
+    }
+};
+
+} // anonymous namespace
+
+
+bool PickingBVH::intersectBox(const Vector3& origin, const Vector3& invDirection, const Vector3& minBBox, const Vector3& maxBBox,
+        double maxLength, double& tEntry)
+{
+    double tmin = 0;
+    double tmax = maxLength;
+    for (int c=0; c<3; ++c)
+    {
+        double t0 = (minBBox[c] - origin[c]) * invDirection[c];
+        double t1 = (maxBBox[c] - origin[c]) * invDirection[c];
+        if (t0 > t1) std::swap(t0, t1);
+        // NaN when the ray lies on a slab plane, keep the current interval
+        if (t0 > tmin) tmin = t0;
+        if (t1 < tmax) tmax = t1;
+        if (tmin > tmax) return false;
+    }
+    tEntry = tmin;
+    return true;
+}
+
+PickingBVH::PickingBVH()
+    : particleRadius(0.0)
+    , particleSlope(0.01)
+{
+}
+
+void PickingBVH::clear()
+{
+    surfaces = Tree();
+    particles = Tree();
+}
+
+bool PickingBVH::addComponent(core::objectmodel::BaseObject* object)
+{
+    const core::objectmodel::Tag noPicking("NoPicking");
+    if (object->hasTag(noPicking)) return false;
+
+    Source s;
+    s.size = 0;
+    s.counter = -1;
+    core::CollisionModel* model = core::CollisionModel::DynamicCast(object);
+    if (model)
+    {
+        if (!model->isSimulated()) return false;
+        if (TriangleModel::DynamicCast(model) != NULL) s.type = TRIANGLE;
+        else if (SphereModel::DynamicCast(model) != NULL) s.type = SPHERE;
+        else return false;
+        s.model = model;
+        // the state may be added after the model, it is then found by update()
+        s.mstate = model->getContext()->getMechanicalState();
+        // the new source has no element yet, the next update rebuilds the tree
+        surfaces.sources.push_back(s);
+        return true;
+    }
+
+    core::behavior::BaseMechanicalState* mstate = core::behavior::BaseMechanicalState::DynamicCast(object);
+    if (!mstate) return false;
+    s.type = PARTICLE;
+    s.model = NULL;
+    s.mstate = mstate;
+    particles.sources.push_back(s);
+    return true;
+}
+
+void PickingBVH::removeComponent(core::objectmodel::BaseObject* object)
+{
+    bool removed = false;
+    for (unsigned int i=0; i<surfaces.sources.size();)
+    {
+        Source& s = surfaces.sources[i];
+        if (s.mstate == object)
+        {
+            s.mstate = NULL;
+            s.counter = -1;
+        }
+        if (s.model == object)
+        {
+            surfaces.sources.erase(surfaces.sources.begin() + i);
+            removed = true;
+        }
+        else ++i;
+    }
+    if (removed) invalidate(surfaces);
+
+    removed = false;
+    for (unsigned int i=0; i<particles.sources.size();)
+    {
+        if (particles.sources[i].mstate == object)
+        {
+            particles.sources.erase(particles.sources.begin() + i);
+            removed = true;
+        }
+        else ++i;
+    }
+    if (removed) invalidate(particles);
+}
+
+bool PickingBVH::contains(const Hit& hit) const
+{
+    if (hit.model)
+    {
+        for (unsigned int i=0; i<surfaces.sources.size(); ++i)
+            if (surfaces.sources[i].model == hit.model) return true;
+        return false;
+    }
+    for (unsigned int i=0; i<particles.sources.size(); ++i)
+        if (particles.sources[i].mstate == hit.mstate) return true;
+    return false;
+}
+
+void PickingBVH::invalidate(Tree& tree)
+{
+    // the elements refer to the sources by index
+    tree.elements.clear();
+    tree.minBBox.clear();
+    tree.maxBBox.clear();
+    tree.points.clear();
+    tree.order.clear();
+    tree.nodes.clear();
+}
+
+unsigned int PickingBVH::getSize(const Source& s)
+{
+    if (s.model) return (unsigned int)s.model->getSize();
+    return (unsigned int)s.mstate->getSize();
+}
+
+int PickingBVH::getCounter(const Source& s)
+{
+    if (!s.mstate) return -1;
+    const core::objectmodel::BaseData* position = s.mstate->baseRead(core::ConstVecCoordId::position());
+    return position ? position->getCounter() : -1;
+}
+
+void PickingBVH::readElement(Tree& tree, unsigned int e)
+{
+    const Element& element = tree.elements[e];
+    const Source& s = tree.sources[element.source];
+    switch (s.type)
+    {
+    case TRIANGLE:
+    {
+        Vector3* p = &tree.points[3*e];
+        Triangle t(TriangleModel::DynamicCast(s.model), element.index);
+        p[0] = t.p1();
+        p[1] = t.p2();
+        p[2] = t.p3();
+        for (int c=0; c<3; ++c)
+        {
+            tree.minBBox[e][c] = std::min(p[0][c], std::min(p[1][c], p[2][c]));
+            tree.maxBBox[e][c] = std::max(p[0][c], std::max(p[1][c], p[2][c]));
+        }
+        break;
+    }
+    case SPHERE:
+    {
+        Sphere sphere(SphereModel::DynamicCast(s.model), element.index);
+        const Vector3 r(sphere.r(), sphere.r(), sphere.r());
+        Vector3* p = &tree.points[3*e];
+        p[0] = sphere.center();
+        p[1] = Vector3(sphere.r(), 0, 0);
+        tree.minBBox[e] = p[0] - r;
+        tree.maxBBox[e] = p[0] + r;
+        break;
+    }
+    case PARTICLE:
+    {
+        // the box of a particle is its position
+        tree.minBBox[e] = Vector3(s.mstate->getPX(element.index), s.mstate->getPY(element.index), s.mstate->getPZ(element.index));
+        tree.maxBBox[e] = tree.minBBox[e];
+        break;
+    }
+    }
+}
+
+void PickingBVH::update(Tree& tree)
+{
+    bool resized = tree.nodes.empty() && !tree.sources.empty();
+    std::vector<bool> moved(tree.sources.size(), false);
+    bool anyMoved = false;
+    for (unsigned int i=0; i<tree.sources.size(); ++i)
+    {
+        Source& s = tree.sources[i];
+        if (s.model && !s.mstate)
+            s.mstate = s.model->getContext()->getMechanicalState();
+        const unsigned int size = getSize(s);
+        const int counter = getCounter(s);
+        if (size != s.size)
+        {
+            s.size = size;
+            resized = true;
+        }
+        if (counter != s.counter)
+        {
+            s.counter = counter;
+            moved[i] = anyMoved = true;
+        }
+    }
+    if (resized) build(tree);
+    else if (anyMoved) refit(tree, moved);
+}
+
+void PickingBVH::build(Tree& tree)
+{
+    tree.elements.clear();
+    for (unsigned int i=0; i<tree.sources.size(); ++i)
+    {
+        for (unsigned int j=0; j<tree.sources[i].size; ++j)
+        {
+            Element e;
+            e.source = i;
+            e.index = j;
+            tree.elements.push_back(e);
+        }
+    }
+    const unsigned int nbElements = (unsigned int)tree.elements.size();
+    tree.minBBox.resize(nbElements);
+    tree.maxBBox.resize(nbElements);
+    // trees hold either surfaces or particles
+    const bool surfaceTree = !tree.sources.empty() && tree.sources[0].type != PARTICLE;
+    tree.points.resize(surfaceTree ? 3*nbElements : 0);
+    tree.order.resize(nbElements);
+    for (unsigned int e=0; e<nbElements; ++e)
+    {
+        readElement(tree, e);
+        tree.order[e] = e;
+    }
+    tree.nodes.clear();
+    if (nbElements) buildNode(tree, 0, nbElements);
+}
+
+unsigned int PickingBVH::buildNode(Tree& tree, unsigned int first, unsigned int count)
+{
+    const unsigned int index = (unsigned int)tree.nodes.size();
+    tree.nodes.push_back(TreeNode());
+
+    Vector3 minBBox = tree.minBBox[tree.order[first]];
+    Vector3 maxBBox = tree.maxBBox[tree.order[first]];
+    Vector3 minCenter = (tree.minBBox[tree.order[first]] + tree.maxBBox[tree.order[first]]) * 0.5;
+    Vector3 maxCenter = minCenter;
+    for (unsigned int i=first+1; i<first+count; ++i)
+    {
+        const unsigned int e = tree.order[i];
+        const Vector3 center = (tree.minBBox[e] + tree.maxBBox[e]) * 0.5;
+        for (int c=0; c<3; ++c)
+        {
+            minBBox[c] = std::min(minBBox[c], tree.minBBox[e][c]);
+            maxBBox[c] = std::max(maxBBox[c], tree.maxBBox[e][c]);
+            minCenter[c] = std::min(minCenter[c], center[c]);
+            maxCenter[c] = std::max(maxCenter[c], center[c]);
+        }
+    }
+
+    TreeNode node;
+    node.minBBox = minBBox;
+    node.maxBBox = maxBBox;
+    node.first = first;
+    node.count = count;
+    node.right = 0;
+
+    const Vector3 extent = maxCenter - minCenter;
+    if (count > MaxLeafSize && (extent[0] > 0 || extent[1] > 0 || extent[2] > 0))
+    {
+        int axis = 0;
+        if (extent[1] > extent[axis]) axis = 1;
+        if (extent[2] > extent[axis]) axis = 2;
+        const unsigned int half = count / 2;
+        std::nth_element(tree.order.begin() + first, tree.order.begin() + first + half, tree.order.begin() + first + count,
+                CenterCompare(tree.minBBox, tree.maxBBox, axis));
+        node.count = 0;
+        buildNode(tree, first, half);
+        node.right = buildNode(tree, first + half, count - half);
+    }
+    tree.nodes[index] = node;
+    return index;
+}
+
+void PickingBVH::refit(Tree& tree, const std::vector<bool>& moved)
+{
+    for (unsigned int e=0; e<tree.elements.size(); ++e)
+    {
+        if (moved[tree.elements[e].source]) readElement(tree, e);
+    }
+    // children are stored after their parent
+    for (unsigned int i=(unsigned int)tree.nodes.size(); i-- > 0;)
+    {
+        TreeNode& node = tree.nodes[i];
+        if (node.count)
+        {
+            node.minBBox = tree.minBBox[tree.order[node.first]];
+            node.maxBBox = tree.maxBBox[tree.order[node.first]];
+            for (unsigned int j=node.first+1; j<node.first+node.count; ++j)
+            {
+                const unsigned int e = tree.order[j];
+                for (int c=0; c<3; ++c)
+                {
+                    node.minBBox[c] = std::min(node.minBBox[c], tree.minBBox[e][c]);
+                    node.maxBBox[c] = std::max(node.maxBBox[c], tree.maxBBox[e][c]);
+                }
+            }
+        }
+        else
+        {
+            const TreeNode& left = tree.nodes[i+1];
+            const TreeNode& right = tree.nodes[node.right];
+            for (int c=0; c<3; ++c)
+            {
+                node.minBBox[c] = std::min(left.minBBox[c], right.minBBox[c]);
+                node.maxBBox[c] = std::max(left.maxBBox[c], right.maxBBox[c]);
+            }
+        }
+    }
+}
+
+void PickingBVH::update()
+{
+    update(surfaces);
+    update(particles);
+}
+
+bool PickingBVH::intersect(const Vector3& origin, const Vector3& direction, double maxLength, Hit& hit) const
+{
+    if (intersectSurfaces(origin, direction, maxLength, hit)) return true;
+    return intersectParticles(origin, direction, maxLength, hit);
+}
+
+bool PickingBVH::intersectSurfaces(const Vector3& origin, const Vector3& direction, double maxLength, Hit& hit) const
+{
+    if (surfaces.nodes.empty()) return false;
+    const Tree& tree = surfaces;
+    const Vector3 invDirection(1.0/direction[0], 1.0/direction[1], 1.0/direction[2]);
+    double best = maxLength;
+    bool found = false;
+
+    std::vector<unsigned int> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const unsigned int nodeIndex = stack.back();
+        const TreeNode& node = tree.nodes[nodeIndex];
+        stack.pop_back();
+        double tEntry;
+        if (!intersectBox(origin, invDirection, node.minBBox, node.maxBBox, best, tEntry)) continue;
+        if (node.count == 0)
+        {
+            // visit the closest child first
+            const TreeNode& left = tree.nodes[nodeIndex+1];
+            const TreeNode& right = tree.nodes[node.right];
+            const Vector3 leftCenter = (left.minBBox + left.maxBBox) * 0.5;
+            const Vector3 rightCenter = (right.minBBox + right.maxBBox) * 0.5;
+            if ((leftCenter - origin) * direction < (rightCenter - origin) * direction)
+            {
+                stack.push_back(node.right);
+                stack.push_back(nodeIndex+1);
+            }
+            else
+            {
+                stack.push_back(nodeIndex+1);
+                stack.push_back(node.right);
+            }
+            continue;
+        }
+        for (unsigned int i=node.first; i<node.first+node.count; ++i)
+        {
+            const unsigned int e = tree.order[i];
+            const Element& element = tree.elements[e];
+            const Source& s = tree.sources[element.source];
+            const Vector3* p = &tree.points[3*e];
+            if (s.type == TRIANGLE)
+            {
+                double d, u, v;
+                if (intersectTriangle(origin, direction, p[0], p[1], p[2], d, u, v) && d <= best)
+                {
+                    best = d;
+                    hit.model = s.model;
+                    hit.mstate = NULL;
+                    hit.index = element.index;
+                    hit.point = origin + direction * d;
+                    hit.baryCoords = Vector3(1.0 - u - v, u, v);
+                    hit.rayLength = d;
+                    found = true;
+                }
+            }
+            else
+            {
+                double d;
+                if (intersectSphere(origin, direction, p[0], p[1][0], d) && d <= best)
+                {
+                    best = d;
+                    hit.model = s.model;
+                    hit.mstate = NULL;
+                    hit.index = element.index;
+                    hit.point = origin + direction * d;
+                    hit.baryCoords = Vector3();
+                    hit.rayLength = d;
+                    found = true;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+bool PickingBVH::intersectParticles(const Vector3& origin, const Vector3& direction, double maxLength, Hit& hit) const
+{
+    if (particles.nodes.empty()) return false;
+    const Tree& tree = particles;
+    const Vector3 invDirection(1.0/direction[0], 1.0/direction[1], 1.0/direction[2]);
+    double best = maxLength;
+    bool found = false;
+
+    std::vector<unsigned int> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const unsigned int nodeIndex = stack.back();
+        const TreeNode& node = tree.nodes[nodeIndex];
+        stack.pop_back();
+
+        // inflate the box by the widest section of the cone it can contain
+        const Vector3 halfDiagonal = (node.maxBBox - node.minBBox) * 0.5;
+        const Vector3 center = node.minBBox + halfDiagonal;
+        const double farthest = std::min(best, (center - origin).norm() + halfDiagonal.norm());
+        const double r = particleRadius + particleSlope * farthest;
+        const Vector3 margin(r, r, r);
+        double tEntry;
+        if (!intersectBox(origin, invDirection, node.minBBox - margin, node.maxBBox + margin, best, tEntry)) continue;
+
+        if (node.count == 0)
+        {
+            const TreeNode& left = tree.nodes[nodeIndex+1];
+            const TreeNode& right = tree.nodes[node.right];
+            const Vector3 leftCenter = (left.minBBox + left.maxBBox) * 0.5;
+            const Vector3 rightCenter = (right.minBBox + right.maxBBox) * 0.5;
+            if ((leftCenter - origin) * direction < (rightCenter - origin) * direction)
+            {
+                stack.push_back(node.right);
+                stack.push_back(nodeIndex+1);
+            }
+            else
+            {
+                stack.push_back(nodeIndex+1);
+                stack.push_back(node.right);
+            }
+            continue;
+        }
+        for (unsigned int i=node.first; i<node.first+node.count; ++i)
+        {
+            const unsigned int e = tree.order[i];
+            const Vector3& p = tree.minBBox[e];
+            const double d = (p - origin) * direction;
+            if (d < 0.0 || d > best) continue;
+            const double maxr = particleRadius + particleSlope * d;
+            if ((p - origin - direction * d).norm2() > maxr * maxr) continue;
+            best = d;
+            hit.model = NULL;
+            hit.mstate = tree.sources[tree.elements[e].source].mstate;
+            hit.index = tree.elements[e].index;
+            hit.point = p;
+            hit.baryCoords = Vector3();
+            hit.rayLength = d;
+            found = true;
+        }
+    }
+    return found;
+}
+
+} // namespace gui
+
+} // namespace sofa
@@ -0,0 +1,170 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_PICKINGBVH_H
+#define SOFA_GUI_PICKINGBVH_H
+
+#include "SofaGUI.h"
+#include <sofa/core/CollisionModel.h>
+#include <sofa/core/behavior/BaseMechanicalState.h>
+#include <sofa/core/objectmodel/BaseObject.h>
+#include <sofa/defaulttype/Vec.h>
+#include <vector>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+/// Bounding volume hierarchy over the pickable elements of a scene, used to cast
+/// the mouse ray without visiting every mechanical state.
+/// Triangles and spheres of the collision models are stored in one tree, the
+/// particles of the mechanical states in another one which is only queried when
+/// the ray misses every surface. The trees are built when the pickable components
+/// or their sizes change, and refitted when the positions of their states change.
+///
+/// The components are given by the owner, which must remove them before they are
+/// deleted (see PickingService, which follows the graph mutations).
+///
+/// update() copies the geometry of the elements, and intersect() only reads this
+/// copy, so queries can run in another thread than the simulation as long as they
+/// do not overlap with update().
+class SOFA_SOFAGUI_API PickingBVH
+{
+public:
+    typedef sofa::defaulttype::Vector3 Vector3;
+
+    struct Hit
+    {
+        Hit() : model(NULL), mstate(NULL), index(0), rayLength(0) {}
+        /// triangle or sphere model hit by the ray, NULL for a particle
+        core::CollisionModel* model;
+        /// mechanical state of the picked particle, NULL for a surface
+        core::behavior::BaseMechanicalState* mstate;
+        unsigned int index;
+        Vector3 point;
+        /// weights of the three vertices of the triangle at the hit point
+        Vector3 baryCoords;
+        double rayLength;
+    };
+
+    PickingBVH();
+
+    /// Add the component if it is a triangle or sphere model or a mechanical state,
+    /// not tagged NoPicking. Return false if it is not pickable.
+    bool addComponent(core::objectmodel::BaseObject* object);
+    /// Remove the component, and the elements read from it
+    void removeComponent(core::objectmodel::BaseObject* object);
+    /// Return true if the components of the hit are still in the trees
+    bool contains(const Hit& hit) const;
+    /// Forget all the components and trees
+    void clear();
+
+    /// Particles are picked inside a cone around the ray, of radius r0 + slope * distance
+    void setParticleCone(double r0, double slope) { particleRadius = r0; particleSlope = slope; }
+
+    /// Read the current positions of the components, rebuilding the trees if a
+    /// component changed size and refitting them if a component moved.
+    void update();
+
+    /// Return the closest element hit by the ray, direction being normalized.
+    bool intersect(const Vector3& origin, const Vector3& direction, double maxLength, Hit& hit) const;
+
+    /// Slab test, return the entry distance of the ray in the box or false if it is
+    /// missed before maxLength. invDirection is the componentwise inverse of the direction.
+    static bool intersectBox(const Vector3& origin, const Vector3& invDirection, const Vector3& minBBox, const Vector3& maxBBox,
+            double maxLength, double& tEntry);
+
+    unsigned int getNbSurfaceElements() const { return (unsigned int)surfaces.elements.size(); }
+    unsigned int getNbParticles() const { return (unsigned int)particles.elements.size(); }
+
+protected:
+    enum ElementType { TRIANGLE, SPHERE, PARTICLE };
+
+    struct Source
+    {
+        ElementType type;
+        core::CollisionModel* model;
+        /// state whose position counter triggers the refit
+        core::behavior::BaseMechanicalState* mstate;
+        unsigned int size;
+        int counter;
+    };
+
+    struct Element
+    {
+        unsigned int source;
+        unsigned int index;
+    };
+
+    /// Nodes are stored in depth-first order: the first child of an inner node
+    /// follows it, the second one is at index right. Leaves have count > 0.
+    struct TreeNode
+    {
+        Vector3 minBBox, maxBBox;
+        unsigned int first, count, right;
+    };
+
+    struct Tree
+    {
+        std::vector<Source> sources;
+        std::vector<Element> elements;
+        std::vector<Vector3> minBBox, maxBBox;
+        /// copy of the surface geometry, three points per element: the vertices
+        /// of a triangle, or the center and (radius,0,0) of a sphere.
+        /// Particles are only stored in minBBox.
+        std::vector<Vector3> points;
+        /// permutation of the elements, leaves store ranges of it
+        std::vector<unsigned int> order;
+        std::vector<TreeNode> nodes;
+    };
+
+    /// Drop the elements of the tree, so that it is rebuilt by the next update
+    static void invalidate(Tree& tree);
+    static unsigned int getSize(const Source& s);
+    static int getCounter(const Source& s);
+
+    /// Rebuild the tree if a source changed size, refit it if a source moved
+    void update(Tree& tree);
+    void build(Tree& tree);
+    unsigned int buildNode(Tree& tree, unsigned int first, unsigned int count);
+    void refit(Tree& tree, const std::vector<bool>& moved);
+    /// Copy the geometry of the element and compute its bounding box
+    void readElement(Tree& tree, unsigned int e);
+
+    bool intersectSurfaces(const Vector3& origin, const Vector3& direction, double maxLength, Hit& hit) const;
+    bool intersectParticles(const Vector3& origin, const Vector3& direction, double maxLength, Hit& hit) const;
+
+    Tree surfaces;
+    Tree particles;
+    double particleRadius;
+    double particleSlope;
+};
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_PICKINGBVH_H
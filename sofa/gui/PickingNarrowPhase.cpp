@@ -0,0 +1,256 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "PickingNarrowPhase.h"
+#include "PickingBVH.h"
+
+#include <SofaBaseCollision/CubeModel.h>
+#include <sofa/core/collision/DetectionOutput.h>
+#include <sofa/core/objectmodel/BaseContext.h>
+#include <sofa/core/objectmodel/Tag.h>
+#include <sofa/helper/vector.h>
+
+#include <algorithm>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+using namespace sofa::component::collision;
+using sofa::helper::system::thread::CTime;
+
+namespace
+{
+
+bool lessIndex(const core::CollisionElementIterator& a, const core::CollisionElementIterator& b)
+{
+    return a.getIndex() < b.getIndex();
+}
+
+bool sameIndex(const core::CollisionElementIterator& a, const core::CollisionElementIterator& b)
+{
+    return a.getIndex() == b.getIndex();
+}
+
+} // anonymous namespace
+
+PickingNarrowPhase::PickingNarrowPhase()
+    : ignoredNode(NULL)
+{
+}
+
+PickingNarrowPhase::~PickingNarrowPhase()
+{
+    detach();
+}
+
+void PickingNarrowPhase::attach(simulation::Node* node, simulation::Node* ignored, core::CollisionModel* ray)
+{
+    rayModel = ray;
+    if (node == root.get()) return;
+    detach();
+    root = node;
+    ignoredNode = ignored;
+    // register the existing models and listen to the whole graph
+    if (root) addChild(NULL, root.get());
+}
+
+void PickingNarrowPhase::detach()
+{
+    if (!root) return;
+    // forget the models first, so that the removal events below find nothing to do
+    models.clear();
+    removeChild(NULL, root.get());
+    root->removeListener(this);
+    root.reset();
+    ignoredNode = NULL;
+}
+
+void PickingNarrowPhase::clear()
+{
+    detach();
+    rayModel.reset();
+    lastStats = Stats();
+}
+
+void PickingNarrowPhase::addChild(simulation::Node* parent, simulation::Node* child)
+{
+    if (child == ignoredNode) return;
+    MutationListener::addChild(parent, child);
+}
+
+void PickingNarrowPhase::removeChild(simulation::Node* parent, simulation::Node* child)
+{
+    if (child == ignoredNode) return;
+    MutationListener::removeChild(parent, child);
+}
+
+void PickingNarrowPhase::addObject(simulation::Node* parent, core::objectmodel::BaseObject* object)
+{
+    core::CollisionModel* model = core::CollisionModel::DynamicCast(object);
+    if (model && model != rayModel.get()) models.push_back(model);
+    MutationListener::addObject(parent, object);
+}
+
+void PickingNarrowPhase::removeObject(simulation::Node* parent, core::objectmodel::BaseObject* object)
+{
+    MutationListener::removeObject(parent, object);
+    core::CollisionModel* model = core::CollisionModel::DynamicCast(object);
+    if (!model) return;
+    for (std::size_t i = models.size(); i-- > 0; )
+    {
+        if (models[i].get() != model) continue;
+        models[i] = models.back();
+        models.pop_back();
+    }
+}
+
+core::collision::Intersection* PickingNarrowPhase::getIntersection() const
+{
+    core::collision::Intersection* intersection = NULL;
+    if (root) root->getContext()->get(intersection, core::objectmodel::BaseContext::SearchRoot);
+    return intersection;
+}
+
+void PickingNarrowPhase::collectCandidates(core::CollisionModel* model, const Vector3& origin, const Vector3& invDirection,
+        double maxLength, std::vector<core::CollisionElementIterator>& candidates) const
+{
+    core::CollisionModel* first = model->getFirst();
+    bool cubeTree = (first != model);
+    for (core::CollisionModel* level = first; cubeTree && level != model; level = level->getNext())
+        if (CubeModel::DynamicCast(level) == NULL) cubeTree = false;
+
+    if (!cubeTree)
+    {
+        // no usable bounding tree, every element is a candidate
+        for (int i=0; i<model->getSize(); ++i)
+            candidates.push_back(core::CollisionElementIterator(model, i));
+        return;
+    }
+
+    std::vector<core::CollisionElementIterator> stack;
+    for (int i=0; i<first->getSize(); ++i)
+        stack.push_back(core::CollisionElementIterator(first, i));
+    const std::size_t firstCandidate = candidates.size();
+    while (!stack.empty())
+    {
+        const core::CollisionElementIterator it = stack.back();
+        stack.pop_back();
+        if (it.getCollisionModel() == model)
+        {
+            candidates.push_back(it);
+            continue;
+        }
+        const Cube cube(it);
+        double tEntry;
+        if (!PickingBVH::intersectBox(origin, invDirection, cube.minVect(), cube.maxVect(), maxLength, tEntry)) continue;
+        std::pair<core::CollisionElementIterator,core::CollisionElementIterator> children = it.getInternalChildren();
+        for (core::CollisionElementIterator c = children.first; c != children.second; ++c)
+            stack.push_back(c);
+        children = it.getExternalChildren();
+        for (core::CollisionElementIterator c = children.first; c != children.second; ++c)
+            stack.push_back(c);
+    }
+
+    // leaves of several cells can share elements
+    std::sort(candidates.begin()+firstCandidate, candidates.end(), lessIndex);
+    candidates.erase(std::unique(candidates.begin()+firstCandidate, candidates.end(), sameIndex), candidates.end());
+}
+
+BodyPicked PickingNarrowPhase::intersect(const Vector3& origin, const Vector3& direction, double maxLength)
+{
+    const ctime_t start = CTime::getRefTime();
+    BodyPicked result;
+    lastStats = Stats();
+    core::collision::Intersection* intersection = getIntersection();
+    if (!rayModel || !intersection) return result;
+
+    const core::objectmodel::Tag noPicking("NoPicking");
+    const Vector3 invDirection(1.0/direction[0], 1.0/direction[1], 1.0/direction[2]);
+    const core::CollisionElementIterator ray(rayModel.get(), 0);
+    std::vector<core::CollisionElementIterator> candidates;
+    for (unsigned int m=0; m<models.size(); ++m)
+    {
+        core::CollisionModel* model = models[m].get();
+        // the levels of the bounding trees are reached through their final model
+        if (model->getNext() != NULL || !model->isSimulated() || model->hasTag(noPicking)) continue;
+        ++lastStats.nbModels;
+        if (!model->isActive() || model->getSize() == 0) continue;
+
+        candidates.clear();
+        collectCandidates(model, origin, invDirection, maxLength, candidates);
+        if (candidates.empty()) continue;
+        ++lastStats.nbCandidateModels;
+        lastStats.nbCandidateElements += (unsigned int)candidates.size();
+
+        bool swapModels = false;
+        core::collision::ElementIntersector* intersector = intersection->findIntersector(rayModel.get(), model, swapModels);
+        if (intersector == NULL) continue;
+
+        core::collision::DetectionOutputVector* outputs = NULL;
+        if (swapModels) intersector->beginIntersect(model, rayModel.get(), outputs);
+        else            intersector->beginIntersect(rayModel.get(), model, outputs);
+        for (unsigned int e=0; e<candidates.size(); ++e)
+        {
+            if (swapModels) intersector->intersect(candidates[e], ray, outputs);
+            else            intersector->intersect(ray, candidates[e], outputs);
+        }
+
+        const helper::vector<core::collision::DetectionOutput>* contacts =
+            dynamic_cast<const helper::vector<core::collision::DetectionOutput>*>(outputs);
+        if (contacts)
+        {
+            lastStats.nbContacts += (unsigned int)contacts->size();
+            for (unsigned int i=0; i<contacts->size(); ++i)
+            {
+                const core::collision::DetectionOutput& output = (*contacts)[i];
+                // side of the picked element in the contact
+                const int s = (output.elem.first.getCollisionModel() == rayModel.get()) ? 1 : 0;
+                const double d = (output.point[s]-origin)*direction;
+                if (d<0.0 || d>maxLength) continue;
+                if (result.body == NULL || d < result.rayLength)
+                {
+                    result.body = model;
+                    result.indexCollisionElement = (s == 1) ? output.elem.second.getIndex() : output.elem.first.getIndex();
+                    result.point = output.point[s];
+#ifdef DETECTIONOUTPUT_BARYCENTRICINFO
+                    result.baryCoords = output.baryCoords[s];
+#endif
+                    result.dist = (output.point[1]-output.point[0]).norm();
+                    result.rayLength = d;
+                }
+            }
+        }
+        if (outputs) outputs->release();
+    }
+
+    lastStats.time = CTime::getRefTime() - start;
+    return result;
+}
+
+} // namespace gui
+
+} // namespace sofa
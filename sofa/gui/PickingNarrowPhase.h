@@ -0,0 +1,119 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_PICKINGNARROWPHASE_H
+#define SOFA_GUI_PICKINGNARROWPHASE_H
+
+#include "SofaGUI.h"
+#include <sofa/core/CollisionModel.h>
+#include <sofa/core/collision/Intersection.h>
+#include <sofa/simulation/common/Node.h>
+#include <sofa/simulation/common/MutationListener.h>
+#include <sofa/defaulttype/Vec.h>
+#include <sofa/helper/system/thread/CTime.h>
+#include <SofaUserInteraction/MouseInteractor.h>
+#include <vector>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+/// Intersects the mouse ray with the collision models of the scene using the
+/// narrow phase of the scene intersection method, without running the collision
+/// pipeline. The bounding trees computed by the last broad phase prune the
+/// elements, so only the leaves crossed by the ray are tested, and no contact
+/// is created.
+///
+/// The collision models are registered when attached to a scene and kept up to
+/// date through the graph mutation events, like in PickingService, so that a
+/// model removed while the mouse interacts is never tested.
+class SOFA_SOFAGUI_API PickingNarrowPhase : public simulation::MutationListener
+{
+public:
+    typedef sofa::defaulttype::Vector3 Vector3;
+    typedef sofa::helper::system::thread::ctime_t ctime_t;
+
+    struct Stats
+    {
+        Stats() : nbModels(0), nbCandidateModels(0), nbCandidateElements(0), nbContacts(0), time(0) {}
+        unsigned int nbModels;
+        /// models whose bounding tree is crossed by the ray
+        unsigned int nbCandidateModels;
+        /// elements in the leaves crossed by the ray, each one tested by the intersector
+        unsigned int nbCandidateElements;
+        unsigned int nbContacts;
+        /// duration of the query, in CTime ticks
+        ctime_t time;
+    };
+
+    PickingNarrowPhase();
+    ~PickingNarrowPhase();
+
+    /// Register the collision models below root and follow the graph mutations.
+    /// The subtree of ignored (the mouse node) is never registered.
+    /// Nothing is done if already attached to root.
+    void attach(simulation::Node* root, simulation::Node* ignored, core::CollisionModel* rayModel);
+    /// Stop following the graph and forget the models
+    void detach();
+    void clear();
+    /// False if the scene has no intersection method
+    bool isReady() const { return rayModel && getIntersection() != NULL; }
+
+    virtual void addChild(simulation::Node* parent, simulation::Node* child);
+    virtual void removeChild(simulation::Node* parent, simulation::Node* child);
+    virtual void addObject(simulation::Node* parent, core::objectmodel::BaseObject* object);
+    virtual void removeObject(simulation::Node* parent, core::objectmodel::BaseObject* object);
+
+    /// Return the closest element hit by the first ray of the ray model, whose
+    /// origin and direction are given.
+    component::collision::BodyPicked intersect(const Vector3& origin, const Vector3& direction, double maxLength);
+
+    /// Statistics of the last query, empty if the last picking did not use the narrow phase
+    const Stats& getLastStats() const { return lastStats; }
+    void resetStats() { lastStats = Stats(); }
+
+protected:
+    /// Intersection method of the root node, looked up at each query
+    core::collision::Intersection* getIntersection() const;
+    /// Append the elements of model in the leaves of its bounding tree crossed by the ray
+    void collectCandidates(core::CollisionModel* model, const Vector3& origin, const Vector3& invDirection,
+            double maxLength, std::vector<core::CollisionElementIterator>& candidates) const;
+
+    /// held so that detaching never walks a deleted graph
+    simulation::Node::SPtr root;
+    simulation::Node* ignoredNode;
+    core::CollisionModel::SPtr rayModel;
+    /// the levels of the bounding trees and the models not pickable are skipped at query time,
+    /// as the trees are only built when the models are initialized
+    std::vector<core::CollisionModel::SPtr> models;
+    Stats lastStats;
+};
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_PICKINGNARROWPHASE_H
@@ -0,0 +1,252 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "PickingService.h"
+
+#include <algorithm>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+using sofa::helper::system::thread::CTime;
+
+PickingService::PickingService()
+    : ignoredNode(NULL)
+    , pending(false)
+    , stopRequested(false)
+    , nextRayId(1)
+    , newResult(false)
+{
+}
+
+PickingService::~PickingService()
+{
+    stop();
+    detach();
+}
+
+void PickingService::start()
+{
+    if (worker.joinable()) return;
+    stopRequested = false;
+    worker = std::thread(&PickingService::run, this);
+}
+
+void PickingService::stop()
+{
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopRequested = true;
+        pending = false;
+    }
+    queueCondition.notify_one();
+    worker.join();
+}
+
+void PickingService::attach(simulation::Node* node, simulation::Node* ignored)
+{
+    if (node == root.get()) return;
+    detach();
+    root = node;
+    ignoredNode = ignored;
+    // register the existing components and listen to the whole graph
+    if (root) addChild(NULL, root.get());
+}
+
+void PickingService::detach()
+{
+    if (!root) return;
+    {
+        // forget the components first, so that the removal events below find nothing to do
+        std::lock_guard<std::mutex> lock(bvhMutex);
+        bvh.clear();
+    }
+    removeChild(NULL, root.get());
+    root->removeListener(this);
+    root.reset();
+    ignoredNode = NULL;
+}
+
+void PickingService::addChild(simulation::Node* parent, simulation::Node* child)
+{
+    if (child == ignoredNode) return;
+    MutationListener::addChild(parent, child);
+}
+
+void PickingService::removeChild(simulation::Node* parent, simulation::Node* child)
+{
+    if (child == ignoredNode) return;
+    MutationListener::removeChild(parent, child);
+}
+
+void PickingService::addObject(simulation::Node* parent, core::objectmodel::BaseObject* object)
+{
+    {
+        std::lock_guard<std::mutex> lock(bvhMutex);
+        bvh.addComponent(object);
+    }
+    MutationListener::addObject(parent, object);
+}
+
+void PickingService::removeObject(simulation::Node* parent, core::objectmodel::BaseObject* object)
+{
+    MutationListener::removeObject(parent, object);
+    // wait for a running query, it reads the elements of the component
+    std::lock_guard<std::mutex> lock(bvhMutex);
+    bvh.removeComponent(object);
+}
+
+bool PickingService::updateSnapshot(bool wait)
+{
+    std::unique_lock<std::mutex> lock(bvhMutex, std::defer_lock);
+    if (wait) lock.lock();
+    else if (!lock.try_lock()) return false;
+    bvh.update();
+    return true;
+}
+
+void PickingService::clear()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pending = false;
+        newResult = false;
+        lastResult = Result();
+    }
+    detach();
+}
+
+bool PickingService::isValid(const Result& result)
+{
+    if (!result.found) return true;
+    std::lock_guard<std::mutex> lock(bvhMutex);
+    return bvh.contains(result.hit);
+}
+
+unsigned int PickingService::post(const Vector3& origin, const Vector3& direction, double maxLength)
+{
+    unsigned int id;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        id = nextRayId++;
+        pendingRay.origin = origin;
+        pendingRay.direction = direction;
+        pendingRay.maxLength = maxLength;
+        pendingRay.id = id;
+        pendingRay.time = CTime::getRefTime();
+        pending = true;
+    }
+    queueCondition.notify_one();
+    return id;
+}
+
+bool PickingService::takeResult(Result& result)
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (!newResult) return false;
+    result = lastResult;
+    newResult = false;
+    return true;
+}
+
+bool PickingService::pick(const Vector3& origin, const Vector3& direction, double maxLength, PickingBVH::Hit& hit)
+{
+    std::lock_guard<std::mutex> lock(bvhMutex);
+    return bvh.intersect(origin, direction, maxLength, hit);
+}
+
+void PickingService::pick(const std::vector<Query>& queries, std::vector<Result>& results)
+{
+    results.clear();
+    results.resize(queries.size());
+    std::lock_guard<std::mutex> lock(bvhMutex);
+
+    const unsigned int n = (unsigned int)queries.size();
+    unsigned int nbThreads = std::thread::hardware_concurrency();
+    if (nbThreads == 0 || n < (unsigned int)MinParallelBatch) nbThreads = 1;
+    if (nbThreads > n / (unsigned int)MinParallelBatch + 1) nbThreads = n / (unsigned int)MinParallelBatch + 1;
+
+    const PickingBVH& tree = bvh;
+    auto answer = [&tree, &queries, &results](unsigned int begin, unsigned int end)
+    {
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            const Query& query = queries[i];
+            Result& result = results[i];
+            result.rayId = i;
+            result.rayTime = CTime::getRefTime();
+            result.found = tree.intersect(query.origin, query.direction, query.maxLength, result.hit);
+            result.hitTime = CTime::getRefTime();
+        }
+    };
+
+    // the calling thread takes the first range
+    std::vector<std::thread> helpers;
+    const unsigned int chunk = (n + nbThreads - 1) / nbThreads;
+    for (unsigned int t = 1; t < nbThreads; ++t)
+    {
+        const unsigned int begin = t*chunk;
+        const unsigned int end = std::min(n, begin+chunk);
+        if (begin < end) helpers.push_back(std::thread(answer, begin, end));
+    }
+    answer(0, std::min(n, chunk));
+    for (unsigned int t = 0; t < helpers.size(); ++t)
+        helpers[t].join();
+}
+
+void PickingService::run()
+{
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true)
+    {
+        while (!pending && !stopRequested)
+            queueCondition.wait(lock);
+        if (stopRequested) return;
+
+        const Ray ray = pendingRay;
+        pending = false;
+        lock.unlock();
+
+        Result result;
+        result.rayId = ray.id;
+        result.rayTime = ray.time;
+        {
+            std::lock_guard<std::mutex> bvhLock(bvhMutex);
+            result.found = bvh.intersect(ray.origin, ray.direction, ray.maxLength, result.hit);
+        }
+        result.hitTime = CTime::getRefTime();
+
+        lock.lock();
+        lastResult = result;
+        newResult = true;
+    }
+}
+
+} // namespace gui
+
+} // namespace sofa
@@ -0,0 +1,165 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_PICKINGSERVICE_H
+#define SOFA_GUI_PICKINGSERVICE_H
+
+#include "SofaGUI.h"
+#include "PickingBVH.h"
+
+#include <sofa/simulation/common/Node.h>
+#include <sofa/simulation/common/MutationListener.h>
+#include <sofa/helper/system/thread/CTime.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+/// Answers the mouse ray queries in a worker thread, on the copy of the scene
+/// geometry held by a PickingBVH.
+///
+/// The thread owning the scene refreshes the copy and posts the rays. A ray posted
+/// while the worker is busy replaces the one still waiting, so that only the latest
+/// mouse position is processed. Results carry the time at which their ray was
+/// posted and the time at which the query finished.
+///
+/// The pickable components are registered when attached to a scene and kept up to
+/// date through the graph mutation events, so that the BVH never refers to a
+/// component removed from the graph.
+class SOFA_SOFAGUI_API PickingService : public simulation::MutationListener
+{
+public:
+    typedef sofa::helper::system::thread::ctime_t ctime_t;
+    typedef PickingBVH::Vector3 Vector3;
+
+    struct Query
+    {
+        Vector3 origin;
+        Vector3 direction;
+        double maxLength;
+    };
+
+    struct Result
+    {
+        Result() : found(false), rayId(0), rayTime(0), hitTime(0) {}
+        bool found;
+        PickingBVH::Hit hit;
+        unsigned int rayId;
+        /// CTime::getRefTime() when the ray was posted
+        ctime_t rayTime;
+        /// CTime::getRefTime() when the query finished
+        ctime_t hitTime;
+    };
+
+    PickingService();
+    ~PickingService();
+
+    /// Start the worker thread, if it is not running yet
+    void start();
+    /// Stop the worker thread, dropping the ray waiting to be processed
+    void stop();
+    bool isRunning() const { return worker.joinable(); }
+
+    /// Register the pickable components below root and follow the graph mutations.
+    /// The subtree of ignored (the mouse node) is never registered.
+    /// Nothing is done if already attached to root.
+    void attach(simulation::Node* root, simulation::Node* ignored);
+    /// Stop following the graph and forget the components
+    void detach();
+    simulation::Node* getRoot() const { return root.get(); }
+
+    virtual void addChild(simulation::Node* parent, simulation::Node* child);
+    virtual void removeChild(simulation::Node* parent, simulation::Node* child);
+    virtual void addObject(simulation::Node* parent, core::objectmodel::BaseObject* object);
+    virtual void removeObject(simulation::Node* parent, core::objectmodel::BaseObject* object);
+    /// Copy the current positions of the scene. If wait is false and a query is
+    /// running, nothing is done and false is returned.
+    bool updateSnapshot(bool wait = true);
+    /// Forget the components and the pending ray and result
+    void clear();
+    /// Return true if the components of the result are still in the scene
+    bool isValid(const Result& result);
+
+    PickingBVH& getBVH() { return bvh; }
+
+    /// Queue a ray for the worker and return its id
+    unsigned int post(const Vector3& origin, const Vector3& direction, double maxLength);
+    /// Get the result of the latest processed ray.
+    /// Return false if no result arrived since the last call.
+    bool takeResult(Result& result);
+
+    /// Answer a ray in the calling thread
+    bool pick(const Vector3& origin, const Vector3& direction, double maxLength, PickingBVH::Hit& hit);
+    /// Answer many rays in the calling thread, split across the hardware threads
+    /// when there are enough of them. The snapshot is read under a single lock.
+    void pick(const std::vector<Query>& queries, std::vector<Result>& results);
+
+    /// Below this number of rays a batch is answered by the calling thread alone
+    enum { MinParallelBatch = 64 };
+
+protected:
+    struct Ray
+    {
+        Vector3 origin;
+        Vector3 direction;
+        double maxLength;
+        unsigned int id;
+        ctime_t time;
+    };
+
+    void run();
+
+    /// held so that detaching never walks a deleted graph
+    simulation::Node::SPtr root;
+    simulation::Node* ignoredNode;
+
+    PickingBVH bvh;
+    /// protects bvh
+    std::mutex bvhMutex;
+
+    /// protects the members below
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    bool pending;
+    bool stopRequested;
+    Ray pendingRay;
+    unsigned int nextRayId;
+    bool newResult;
+    Result lastResult;
+
+    std::thread worker;
+};
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_PICKINGSERVICE_H
@@ -0,0 +1,526 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "ViewerOverlayRenderer.h"
+
+#include <sofa/helper/gl/RAII.h>
+
+#include <cmath>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+using namespace sofa::helper::gl;
+using sofa::defaulttype::Vector3;
+
+namespace
+{
+
+void pushVertex(std::vector<GLfloat>& v, double x, double y, double z)
+{
+    v.push_back((GLfloat)x);
+    v.push_back((GLfloat)y);
+    v.push_back((GLfloat)z);
+}
+
+void pushVertex(std::vector<GLfloat>& v, double x, double y, double z, double nx, double ny, double nz)
+{
+    pushVertex(v, x, y, z);
+    pushVertex(v, nx, ny, nz);
+}
+
+/// Map the (a,b) coordinates of a grid and its offset o to a world position,
+/// for the XY, YZ and XZ planes.
+void pushPlaneVertex(std::vector<GLfloat>& v, int plane, double a, double b, double o)
+{
+    switch (plane)
+    {
+    case 0:  pushVertex(v, a, b, o); break;
+    case 1:  pushVertex(v, o, a, b); break;
+    default: pushVertex(v, a, o, b); break;
+    }
+}
+
+}
+
+ViewerOverlayRenderer::Buffer::Buffer()
+    : vbo(0)
+    , mode(GL_LINES)
+    , layout(POSITION)
+    , count(0)
+    , uploaded(false)
+{
+}
+
+void ViewerOverlayRenderer::Buffer::upload(GLenum m, Layout l, const std::vector<GLfloat>& vertices)
+{
+    mode = m;
+    layout = l;
+    const int stride = (layout == POSITION_NORMAL) ? 6 : (layout == POSITION_TEXCOORD) ? 5 : 3;
+    count = (GLsizei)(vertices.size() / stride);
+    uploaded = true;
+
+#ifdef SOFA_HAVE_GLEW
+    if (useVBO())
+    {
+        if (!vbo)
+            glGenBuffers(1, &vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size()*sizeof(GLfloat), vertices.empty() ? NULL : &vertices[0], GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        clientData.clear();
+        return;
+    }
+#endif
+    clientData = vertices;
+}
+
+void ViewerOverlayRenderer::Buffer::draw() const
+{
+    if (!count) return;
+
+    const GLfloat* base = NULL;
+#ifdef SOFA_HAVE_GLEW
+    if (vbo)
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    else
+#endif
+        base = &clientData[0];
+
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    switch (layout)
+    {
+    case POSITION_NORMAL:
+        glVertexPointer(3, GL_FLOAT, 6*sizeof(GLfloat), base);
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glNormalPointer(GL_FLOAT, 6*sizeof(GLfloat), base+3);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        break;
+    case POSITION_TEXCOORD:
+        glVertexPointer(3, GL_FLOAT, 5*sizeof(GLfloat), base);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glTexCoordPointer(2, GL_FLOAT, 5*sizeof(GLfloat), base+3);
+        glDisableClientState(GL_NORMAL_ARRAY);
+        break;
+    case POSITION:
+    default:
+        glVertexPointer(3, GL_FLOAT, 3*sizeof(GLfloat), base);
+        glDisableClientState(GL_NORMAL_ARRAY);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        break;
+    }
+    glDrawArrays(mode, 0, count);
+    glPopClientAttrib();
+
+#ifdef SOFA_HAVE_GLEW
+    if (vbo)
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+}
+
+void ViewerOverlayRenderer::Buffer::release()
+{
+#ifdef SOFA_HAVE_GLEW
+    if (vbo)
+        glDeleteBuffers(1, &vbo);
+#endif
+    vbo = 0;
+    count = 0;
+    uploaded = false;
+    clientData.clear();
+}
+
+ViewerOverlayRenderer::ViewerOverlayRenderer()
+    : primitivesInitialized(false)
+    , texturedRectKey(0,0,0,0)
+    , stencilLinesKey(0,0)
+{
+}
+
+ViewerOverlayRenderer::~ViewerOverlayRenderer()
+{
+}
+
+bool ViewerOverlayRenderer::useVBO()
+{
+#ifdef SOFA_HAVE_GLEW
+    return GLEW_VERSION_1_5 ? true : false;
+#else
+    return false;
+#endif
+}
+
+void ViewerOverlayRenderer::release()
+{
+    cylinder.release();
+    cone.release();
+    sphere.release();
+    for (int i = 0; i < 3; ++i)
+    {
+        labels[i].release();
+        planes[i].release();
+    }
+    texturedRect.release();
+    stencilLines.release();
+    primitivesInitialized = false;
+}
+
+void ViewerOverlayRenderer::initPrimitives()
+{
+    if (primitivesInitialized) return;
+
+    // same tessellation as the GLU quadrics used previously
+    const int tubeSlices = 10;
+    const int sphereSlices = 20;
+    const int sphereStacks = 10;
+    std::vector<GLfloat> v;
+
+    // --- cylinder
+    for (int i = 0; i < tubeSlices; ++i)
+    {
+        const double a0 = 2*M_PI*i/tubeSlices, a1 = 2*M_PI*(i+1)/tubeSlices;
+        const double c0 = cos(a0), s0 = sin(a0), c1 = cos(a1), s1 = sin(a1);
+        pushVertex(v, c0, s0, 0, c0, s0, 0);
+        pushVertex(v, c1, s1, 0, c1, s1, 0);
+        pushVertex(v, c1, s1, 1, c1, s1, 0);
+        pushVertex(v, c0, s0, 0, c0, s0, 0);
+        pushVertex(v, c1, s1, 1, c1, s1, 0);
+        pushVertex(v, c0, s0, 1, c0, s0, 0);
+    }
+    cylinder.upload(GL_TRIANGLES, Buffer::POSITION_NORMAL, v);
+
+    // --- cone
+    v.clear();
+    const double n = 1.0/sqrt(2.0);
+    for (int i = 0; i < tubeSlices; ++i)
+    {
+        const double a0 = 2*M_PI*i/tubeSlices, a1 = 2*M_PI*(i+1)/tubeSlices, am = 0.5*(a0+a1);
+        const double c0 = cos(a0), s0 = sin(a0), c1 = cos(a1), s1 = sin(a1);
+        pushVertex(v, c0, s0, 0, c0*n, s0*n, n);
+        pushVertex(v, c1, s1, 0, c1*n, s1*n, n);
+        pushVertex(v, 0, 0, 1, cos(am)*n, sin(am)*n, n);
+    }
+    cone.upload(GL_TRIANGLES, Buffer::POSITION_NORMAL, v);
+
+    // --- sphere
+    v.clear();
+    for (int j = 0; j < sphereStacks; ++j)
+    {
+        const double t0 = M_PI*j/sphereStacks, t1 = M_PI*(j+1)/sphereStacks;
+        for (int i = 0; i < sphereSlices; ++i)
+        {
+            const double a0 = 2*M_PI*i/sphereSlices, a1 = 2*M_PI*(i+1)/sphereSlices;
+            const Vector3 p00(sin(t0)*cos(a0), sin(t0)*sin(a0), cos(t0));
+            const Vector3 p01(sin(t0)*cos(a1), sin(t0)*sin(a1), cos(t0));
+            const Vector3 p10(sin(t1)*cos(a0), sin(t1)*sin(a0), cos(t1));
+            const Vector3 p11(sin(t1)*cos(a1), sin(t1)*sin(a1), cos(t1));
+            const Vector3* tris[6] = { &p00, &p10, &p11, &p00, &p11, &p01 };
+            for (int k = 0; k < 6; ++k)
+            {
+                const Vector3& p = *tris[k];
+                pushVertex(v, p[0], p[1], p[2], p[0], p[1], p[2]);
+            }
+        }
+    }
+    sphere.upload(GL_TRIANGLES, Buffer::POSITION_NORMAL, v);
+
+    // --- X, Y and Z labels
+    v.clear();
+    pushVertex(v, -0.3, 0, 0); pushVertex(v,  0.3, 1, 0);
+    pushVertex(v, -0.3, 1, 0); pushVertex(v,  0.3, 0, 0);
+    labels[0].upload(GL_LINES, Buffer::POSITION, v);
+    v.clear();
+    pushVertex(v, -0.3, 1, 0); pushVertex(v,  0.0, 0.5, 0);
+    pushVertex(v,  0.3, 1, 0); pushVertex(v,  0.0, 0.5, 0);
+    pushVertex(v,  0.0, 0.5, 0); pushVertex(v,  0.0, 0, 0);
+    labels[1].upload(GL_LINES, Buffer::POSITION, v);
+    v.clear();
+    pushVertex(v, -0.3, 1, 0); pushVertex(v,  0.3, 1, 0);
+    pushVertex(v,  0.3, 1, 0); pushVertex(v, -0.3, 0, 0);
+    pushVertex(v, -0.3, 0, 0); pushVertex(v,  0.3, 0, 0);
+    labels[2].upload(GL_LINES, Buffer::POSITION, v);
+
+    primitivesInitialized = true;
+}
+
+// ---------------------------------------------------
+// ---
+// ---
+// ---------------------------------------------------
+void ViewerOverlayRenderer::drawAxis(double xpos, double ypos, double zpos, double arrowSize)
+{
+    initPrimitives();
+
+    static const GLfloat colours[3][3] = { {1,0,0}, {0,1,0}, {0,0,1} };
+    static const GLfloat rotations[3][4] = { {90,0,1,0}, {-90,1,0,0}, {0,1,0,0} };
+
+    const double tubeRadius = arrowSize / 50.0;
+    const double arrowRadius = arrowSize / 15.0;
+    const double arrowLength = arrowSize / 5.0;
+
+    Enable<GL_DEPTH_TEST> depth;
+    Enable<GL_LIGHTING> lighting;
+    Enable<GL_COLOR_MATERIAL> colorMat;
+
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glShadeModel(GL_SMOOTH);
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        glPushMatrix();
+        glColor3fv(colours[axis]);
+        glTranslated(xpos, ypos, zpos);
+        glRotatef(rotations[axis][0], rotations[axis][1], rotations[axis][2], rotations[axis][3]);
+
+        glPushMatrix();
+        glScaled(tubeRadius, tubeRadius, arrowSize);
+        cylinder.draw();
+        glPopMatrix();
+
+        glTranslated(0.0, 0.0, arrowSize);
+        glPushMatrix();
+        glScaled(arrowRadius, arrowRadius, arrowLength);
+        cone.draw();
+        glPopMatrix();
+
+        // ---- Display the label near the tip of the arrow
+        glTranslated(0.0, arrowRadius, arrowLength);
+        glScaled(arrowLength, arrowLength, arrowLength);
+        glLineWidth(3.0f);
+        labels[axis].draw();
+        glLineWidth(1.0f);
+
+        glPopMatrix();
+    }
+}
+
+// ---------------------------------------------------
+// ---
+// ---
+// ---------------------------------------------------
+void ViewerOverlayRenderer::drawBox(const SReal* minBBox, const SReal* maxBBox, SReal r)
+{
+    initPrimitives();
+
+    if (r == 0.0)
+        r = (Vector3(maxBBox) - Vector3(minBBox)).norm() / 500;
+
+    Enable<GL_DEPTH_TEST> depth;
+    Enable<GL_LIGHTING> lighting;
+    Enable<GL_COLOR_MATERIAL> colorMat;
+
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glShadeModel(GL_SMOOTH);
+
+    // --- Draw the corners
+    glColor3f(0.0, 1.0, 1.0);
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        glPushMatrix();
+        glTranslated((corner & 1) ? minBBox[0] : maxBBox[0],
+                (corner & 2) ? minBBox[1] : maxBBox[1],
+                (corner & 4) ? minBBox[2] : maxBBox[2]);
+        glScaled(2*r, 2*r, 2*r);
+        sphere.draw();
+        glPopMatrix();
+    }
+
+    glColor3f(1.0, 1.0, 0.0);
+    // --- Draw the X edges
+    for (int corner = 0; corner < 4; ++corner)
+    {
+        glPushMatrix();
+        glTranslated(minBBox[0], (corner & 1) ? minBBox[1] : maxBBox[1],
+                (corner & 2) ? minBBox[2] : maxBBox[2]);
+        glRotatef(90, 0, 1, 0);
+        glScaled(r, r, maxBBox[0] - minBBox[0]);
+        cylinder.draw();
+        glPopMatrix();
+    }
+
+    // --- Draw the Y edges
+    for (int corner = 0; corner < 4; ++corner)
+    {
+        glPushMatrix();
+        glTranslated((corner & 1) ? minBBox[0] : maxBBox[0], minBBox[1],
+                (corner & 2) ? minBBox[2] : maxBBox[2]);
+        glRotatef(-90, 1, 0, 0);
+        glScaled(r, r, maxBBox[1] - minBBox[1]);
+        cylinder.draw();
+        glPopMatrix();
+    }
+
+    // --- Draw the Z edges
+    for (int corner = 0; corner < 4; ++corner)
+    {
+        glPushMatrix();
+        glTranslated((corner & 1) ? minBBox[0] : maxBBox[0],
+                (corner & 2) ? minBBox[1] : maxBBox[1], minBBox[2]);
+        glScaled(r, r, maxBBox[2] - minBBox[2]);
+        cylinder.draw();
+        glPopMatrix();
+    }
+}
+
+// ----------------------------------------------------------------------------------
+// --- Draw a "plane" in wireframe. The lines are only regenerated when one of
+// --- the parameters of the grid changes.
+// ----------------------------------------------------------------------------------
+void ViewerOverlayRenderer::drawPlane(int plane, const PlaneKey& key)
+{
+    if (!planes[plane].isUploaded() || key != planeKeys[plane])
+    {
+        const double o = key[0], amin = key[1], amax = key[2], bmin = key[3], bmax = key[4], step = key[5];
+        std::vector<GLfloat> v;
+        if (step > 0)
+        {
+            for (double a = amin; a <= amax; a += step)
+            {
+                pushPlaneVertex(v, plane, a, bmin, o);
+                pushPlaneVertex(v, plane, a, bmax, o);
+            }
+            for (double b = bmin; b <= bmax; b += step)
+            {
+                pushPlaneVertex(v, plane, amin, b, o);
+                pushPlaneVertex(v, plane, amax, b, o);
+            }
+        }
+        planes[plane].upload(GL_LINES, Buffer::POSITION, v);
+        planeKeys[plane] = key;
+    }
+
+    Enable<GL_DEPTH_TEST> depth;
+    planes[plane].draw();
+}
+
+void ViewerOverlayRenderer::drawXYPlane(double zo, double xmin, double xmax, double ymin, double ymax, double step)
+{
+    drawPlane(0, PlaneKey(zo, xmin, xmax, ymin, ymax, step));
+}
+
+void ViewerOverlayRenderer::drawYZPlane(double xo, double ymin, double ymax, double zmin, double zmax, double step)
+{
+    drawPlane(1, PlaneKey(xo, ymin, ymax, zmin, zmax, step));
+}
+
+void ViewerOverlayRenderer::drawXZPlane(double yo, double xmin, double xmax, double zmin, double zmax, double step)
+{
+    drawPlane(2, PlaneKey(yo, xmin, xmax, zmin, zmax, step));
+}
+
+// -------------------------------------------------------------------
+// ---
+// -------------------------------------------------------------------
+void ViewerOverlayRenderer::drawTexturedRect(int x0, int y0, int width, int height)
+{
+    const RectKey key(x0, y0, width, height);
+    if (!texturedRect.isUploaded() || key != texturedRectKey)
+    {
+        std::vector<GLfloat> v;
+        const GLfloat corners[4][2] = { {0,0}, {1,0}, {1,1}, {0,1} };
+        for (int i = 0; i < 4; ++i)
+        {
+            pushVertex(v, x0 + corners[i][0]*width, y0 + corners[i][1]*height, 0.0);
+            v.push_back(corners[i][0]);
+            v.push_back(corners[i][1]);
+        }
+        texturedRect.upload(GL_QUADS, Buffer::POSITION_TEXCOORD, v);
+        texturedRectKey = key;
+    }
+
+    Enable<GL_TEXTURE_2D> tex;
+    glDisable(GL_DEPTH_TEST);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    texturedRect.draw();
+}
+
+void ViewerOverlayRenderer::drawLogo(sofa::helper::gl::Texture* texLogo, int width, int height)
+{
+    if (!texLogo || !texLogo->getImage())
+        return;
+
+    const int h = texLogo->getImage()->getHeight();
+    const int w = texLogo->getImage()->getWidth();
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(-0.5, width, -0.5, height, -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    texLogo->bind();
+    drawTexturedRect((width - w) / 2, (height - h) / 2, w, h);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+}
+
+void ViewerOverlayRenderer::makeStencilMask(int width, int height)
+{
+    const SizeKey key(width, height);
+    if (!stencilLines.isUploaded() || key != stencilLinesKey)
+    {
+        std::vector<GLfloat> v;
+        for (float f = 0; f < height; f += 2.0)
+        {
+            pushVertex(v, 0.0, f, 0.0);
+            pushVertex(v, width, f, 0.0);
+        }
+        stencilLines.upload(GL_LINES, Buffer::POSITION, v);
+        stencilLinesKey = key;
+    }
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    gluOrtho2D(0, width, 0, height);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glClear(GL_STENCIL_BUFFER_BIT);
+    glStencilFunc(GL_ALWAYS, 0x1, 0x1);
+    glStencilOp(GL_REPLACE, GL_REPLACE, GL_REPLACE);
+    glColor4f(0,0,0,0);
+    stencilLines.draw();
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+}
+
+} // namespace gui
+
+} // namespace sofa
@@ -0,0 +1,145 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_VIEWEROVERLAYRENDERER_H
+#define SOFA_GUI_VIEWEROVERLAYRENDERER_H
+
+#include "SofaGUI.h"
+
+#include <sofa/helper/system/gl.h>
+#include <sofa/helper/gl/Texture.h>
+#include <sofa/defaulttype/Vec.h>
+
+#include <vector>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+/// Draws the debug overlays shared by all the viewers (axis, bounding box,
+/// grid planes, background logo, copy screen quad and stereo stencil mask).
+///
+/// The geometry is kept on the GPU, in vertex buffer objects when they are
+/// supported or in client side arrays otherwise, and is only rebuilt when the
+/// parameters used to generate it change. The axis arrows and the bounding box
+/// are drawn from unit primitives placed with the modelview matrix, so they are
+/// never rebuilt at all.
+///
+/// All the methods must be called with the GL context of the owning viewer current.
+class SOFA_SOFAGUI_API ViewerOverlayRenderer
+{
+public:
+    ViewerOverlayRenderer();
+    ~ViewerOverlayRenderer();
+
+    /// Draw the X (red), Y (green) and Z (blue) arrows with their labels.
+    void drawAxis(double xpos, double ypos, double zpos, double arrowSize);
+
+    /// Draw a box with spheres on its corners and cylinders along its edges.
+    /// If r is 0, the radius of the edges is deduced from the size of the box.
+    void drawBox(const SReal* minBBox, const SReal* maxBBox, SReal r=0.0);
+
+    /// Draw a wireframe grid parallel to the XY (resp. YZ, XZ) plane of the world.
+    void drawXYPlane(double zo, double xmin, double xmax, double ymin, double ymax, double step);
+    void drawYZPlane(double xo, double ymin, double ymax, double zmin, double zmax, double step);
+    void drawXZPlane(double yo, double xmin, double xmax, double zmin, double zmax, double step);
+
+    /// Draw the logo texture centered in a window of the given size.
+    void drawLogo(sofa::helper::gl::Texture* texLogo, int width, int height);
+
+    /// Draw the currently bound 2D texture on a window aligned rectangle.
+    /// The projection must already map window coordinates.
+    void drawTexturedRect(int x0, int y0, int width, int height);
+
+    /// Write one line out of two in the stencil buffer (interlaced stereo).
+    void makeStencilMask(int width, int height);
+
+    /// Release the GL resources. Must be called before the GL context is destroyed.
+    void release();
+
+protected:
+
+    /// Vertices of a primitive, stored in a VBO when possible.
+    class Buffer
+    {
+    public:
+        enum Layout
+        {
+            POSITION,           ///< x y z
+            POSITION_NORMAL,    ///< x y z nx ny nz
+            POSITION_TEXCOORD   ///< x y z u v
+        };
+
+        Buffer();
+
+        void upload(GLenum mode, Layout layout, const std::vector<GLfloat>& vertices);
+        void draw() const;
+        void release();
+        bool empty() const { return count == 0; }
+        /// true once uploaded, even with no vertex, until released
+        bool isUploaded() const { return uploaded; }
+
+    protected:
+        GLuint vbo;
+        GLenum mode;
+        Layout layout;
+        GLsizei count;
+        bool uploaded;
+        /// only used when vertex buffer objects are not supported
+        std::vector<GLfloat> clientData;
+    };
+
+    typedef sofa::defaulttype::Vec<6,double> PlaneKey;
+    typedef sofa::defaulttype::Vec<4,int> RectKey;
+    typedef sofa::defaulttype::Vec<2,int> SizeKey;
+
+    void initPrimitives();
+    void drawPlane(int plane, const PlaneKey& key);
+
+    static bool useVBO();
+
+    bool primitivesInitialized;
+
+    Buffer cylinder;     ///< unit radius, unit length along Z, no caps
+    Buffer cone;         ///< unit base radius at z=0, apex at z=1
+    Buffer sphere;       ///< unit radius
+    Buffer labels[3];    ///< X, Y and Z glyphs in the [-0.3,0.3]x[0,1] square
+
+    Buffer planes[3];
+    PlaneKey planeKeys[3];
+
+    Buffer texturedRect;
+    RectKey texturedRectKey;
+
+    Buffer stencilLines;
+    SizeKey stencilLinesKey;
+};
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_VIEWEROVERLAYRENDERER_H
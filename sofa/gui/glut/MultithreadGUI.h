@@ -27,6 +27,7 @@
 
 #include "../BaseGUI.h"
 #include "../PickHandler.h"
+#include "../ViewerOverlayRenderer.h"
 
 #include <sofa/core/objectmodel/AspectPool.h>
 //#include <sofa/helper/system/thread/CircularQueue.h>
@@ -133,6 +134,7 @@ public:
     static void glut_motion(int x, int y);
     static void glut_special(int k, int x, int y);
     static void glut_idle();
+    static void glut_close();
 
 private:
     //------------------------------------
@@ -196,10 +198,7 @@ private:
     float			_panSpeed;
     //Transformation	_sceneTransform;
     Vector3			_previousEyePos;
-    GLUquadricObj*	_arrow;
-    GLUquadricObj*	_tube;
-    GLUquadricObj*	_sphere;
-    GLUquadricObj*	_disk;
+    sofa::gui::ViewerOverlayRenderer overlay;
     GLuint			_numOBJmodels;
     GLuint			_materialMode;
     GLboolean		_facetNormal;
@@ -229,6 +229,9 @@ SimpleGUI* SimpleGUI::CreateGUI(const sofa::simulation::gui::BaseGUIArgument* a)
     glutMouseFunc ( glut_mouse );
     glutMotionFunc ( glut_motion );
     glutPassiveMotionFunc ( glut_motion );
+#ifdef FREEGLUT
+    glutCloseFunc ( glut_close );
+#endif
 	
 	SimpleGUI* gui = new SimpleGUI(a);
 
@@ -313,6 +316,18 @@ void SimpleGUI::glut_idle()
         else
             CTime::sleep(0.01);
         instance->animate();
+        // answer of the picking service arrived after the mouse stopped
+        if (instance->pick.pollAsynchronousResult())
+            instance->redraw();
+    }
+}
+
+void SimpleGUI::glut_close()
+{
+    // the window is still current, release the buffers of its context
+    if (instance)
+    {
+        instance->overlay.release();
     }
 }
 
@@ -348,26 +363,6 @@ SimpleGUI::SimpleGUI(const sofa::simulation::gui::BaseGUIArgument* a)
     _waitForRender = false;
     texLogo = NULL;
 
-    _arrow = gluNewQuadric();
-    gluQuadricDrawStyle(_arrow, GLU_FILL);
-    gluQuadricOrientation(_arrow, GLU_OUTSIDE);
-    gluQuadricNormals(_arrow, GLU_SMOOTH);
-
-    _tube = gluNewQuadric();
-    gluQuadricDrawStyle(_tube, GLU_FILL);
-    gluQuadricOrientation(_tube, GLU_OUTSIDE);
-    gluQuadricNormals(_tube, GLU_SMOOTH);
-
-    _sphere = gluNewQuadric();
-    gluQuadricDrawStyle(_sphere, GLU_FILL);
-    gluQuadricOrientation(_sphere, GLU_OUTSIDE);
-    gluQuadricNormals(_sphere, GLU_SMOOTH);
-
-    _disk = gluNewQuadric();
-    gluQuadricDrawStyle(_disk, GLU_FILL);
-    gluQuadricOrientation(_disk, GLU_OUTSIDE);
-    gluQuadricNormals(_disk, GLU_SMOOTH);
-
     ////////////////
     // Interactor //
     ////////////////
@@ -406,6 +401,7 @@ SimpleGUI::SimpleGUI(const sofa::simulation::gui::BaseGUIArgument* a)
 // ---------------------------------------------------------
 SimpleGUI::~SimpleGUI()
 {
+    // the overlay buffers are released in glut_close or before exiting, while the window is current
     if (instance == this) instance = NULL;
 }
 
@@ -558,80 +554,7 @@ void SimpleGUI::Display3DText(float x, float y, float z, char* string)
 void SimpleGUI::DrawAxis(double xpos, double ypos, double zpos,
         double arrowSize)
 {
-    float    fontScale    = (float) (arrowSize / 600.0);
-
-    Enable<GL_DEPTH_TEST> depth;
-    Enable<GL_LIGHTING> lighting;
-    Enable<GL_COLOR_MATERIAL> colorMat;
-
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glShadeModel(GL_SMOOTH);
-
-    // --- Draw the "X" axis in red
-    glPushMatrix();
-    glColor3f(1.0, 0.0, 0.0);
-    glTranslated(xpos, ypos, zpos);
-    glRotatef(90.0f, 0.0, 1.0, 0.0);
-    gluCylinder(_tube, arrowSize / 50.0, arrowSize / 50.0, arrowSize, 10, 10);
-    glTranslated(0.0, 0.0, arrowSize);
-    gluCylinder(_arrow, arrowSize / 15.0, 0.0, arrowSize / 5.0, 10, 10);
-    // ---- Display a "X" near the tip of the arrow
-    glTranslated(-0.5 * fontScale * (double)
-            glutStrokeWidth(GLUT_STROKE_ROMAN, 88),
-            arrowSize / 15.0, arrowSize /
-            5.0);
-    glLineWidth(3.0);
-    glScalef(fontScale, fontScale, fontScale);
-    glutStrokeCharacter(GLUT_STROKE_ROMAN, 88);
-    glScalef(1.0f / fontScale, 1.0f / fontScale, 1.0f / fontScale);
-    glLineWidth(1.0f);
-    // --- Undo transforms
-    glTranslated(-xpos, -ypos, -zpos);
-    glPopMatrix();
-
-    // --- Draw the "Y" axis in green
-    glPushMatrix();
-    glColor3f(0.0, 1.0, 0.0);
-    glTranslated(xpos, ypos, zpos);
-    glRotatef(-90.0f, 1.0, 0.0, 0.0);
-    gluCylinder(_tube, arrowSize / 50.0, arrowSize / 50.0, arrowSize, 10, 10);
-    glTranslated(0.0, 0.0, arrowSize);
-    gluCylinder(_arrow, arrowSize / 15.0, 0.0, arrowSize / 5.0, 10, 10);
-    // ---- Display a "Y" near the tip of the arrow
-    glTranslated(-0.5 * fontScale * (double)
-            glutStrokeWidth(GLUT_STROKE_ROMAN, 89),
-            arrowSize / 15.0, arrowSize /
-            5.0);
-    glLineWidth(3.0);
-    glScalef(fontScale, fontScale, fontScale);
-    glutStrokeCharacter(GLUT_STROKE_ROMAN, 89);
-    glScalef(1.0f / fontScale, 1.0f / fontScale, 1.0f / fontScale);
-    glLineWidth(1.0);
-    // --- Undo transforms
-    glTranslated(-xpos, -ypos, -zpos);
-    glPopMatrix();
-
-    // --- Draw the "Z" axis in blue
-    glPushMatrix();
-    glColor3f(0.0, 0.0, 1.0);
-    glTranslated(xpos, ypos, zpos);
-    glRotatef(0.0f, 1.0, 0.0, 0.0);
-    gluCylinder(_tube, arrowSize / 50.0, arrowSize / 50.0, arrowSize, 10, 10);
-    glTranslated(0.0, 0.0, arrowSize);
-    gluCylinder(_arrow, arrowSize / 15.0, 0.0, arrowSize / 5.0, 10, 10);
-    // ---- Display a "Z" near the tip of the arrow
-    glTranslated(-0.5 * fontScale * (double)
-            glutStrokeWidth(GLUT_STROKE_ROMAN, 90),
-            arrowSize / 15.0, arrowSize /
-            5.0);
-    glLineWidth(3.0);
-    glScalef(fontScale, fontScale, fontScale);
-    glutStrokeCharacter(GLUT_STROKE_ROMAN, 90);
-    glScalef(1.0f / fontScale, 1.0f / fontScale, 1.0f / fontScale);
-    glLineWidth(1.0);
-    // --- Undo transforms
-    glTranslated(-xpos, -ypos, -zpos);
-    glPopMatrix();
+    overlay.drawAxis(xpos, ypos, zpos, arrowSize);
 }
 
 // ---------------------------------------------------
@@ -640,102 +563,7 @@ void SimpleGUI::DrawAxis(double xpos, double ypos, double zpos,
 // ---------------------------------------------------
 void SimpleGUI::DrawBox(SReal* minBBox, SReal* maxBBox, double r)
 {
-    //std::cout << "box = < " << minBBox[0] << ' ' << minBBox[1] << ' ' << minBBox[2] << " >-< " << maxBBox[0] << ' ' << maxBBox[1] << ' ' << maxBBox[2] << " >"<< std::endl;
-    if (r==0.0)
-        r = (Vector3(maxBBox) - Vector3(minBBox)).norm() / 500;
-#if 0
-    {
-        Enable<GL_DEPTH_TEST> depth;
-        Disable<GL_LIGHTING> lighting;
-        glColor3f(0.0, 1.0, 1.0);
-        glBegin(GL_LINES);
-        for (int corner=0; corner<4; ++corner)
-        {
-            glVertex3d(           minBBox[0]           ,
-                    (corner&1)?minBBox[1]:maxBBox[1],
-                    (corner&2)?minBBox[2]:maxBBox[2]);
-            glVertex3d(           maxBBox[0]           ,
-                    (corner&1)?minBBox[1]:maxBBox[1],
-                    (corner&2)?minBBox[2]:maxBBox[2]);
-        }
-        for (int corner=0; corner<4; ++corner)
-        {
-            glVertex3d((corner&1)?minBBox[0]:maxBBox[0],
-                    minBBox[1]           ,
-                    (corner&2)?minBBox[2]:maxBBox[2]);
-            glVertex3d((corner&1)?minBBox[0]:maxBBox[0],
-                    maxBBox[1]           ,
-                    (corner&2)?minBBox[2]:maxBBox[2]);
-        }
-
-        // --- Draw the Z edges
-        for (int corner=0; corner<4; ++corner)
-        {
-            glVertex3d((corner&1)?minBBox[0]:maxBBox[0],
-                    (corner&2)?minBBox[1]:maxBBox[1],
-                    minBBox[2]           );
-            glVertex3d((corner&1)?minBBox[0]:maxBBox[0],
-                    (corner&2)?minBBox[1]:maxBBox[1],
-                    maxBBox[2]           );
-        }
-        glEnd();
-        return;
-    }
-#endif
-    Enable<GL_DEPTH_TEST> depth;
-    Enable<GL_LIGHTING> lighting;
-    Enable<GL_COLOR_MATERIAL> colorMat;
-
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glShadeModel(GL_SMOOTH);
-
-    // --- Draw the corners
-    glColor3f(0.0, 1.0, 1.0);
-    for (int corner=0; corner<8; ++corner)
-    {
-        glPushMatrix();
-        glTranslated((corner&1)?minBBox[0]:maxBBox[0],
-                (corner&2)?minBBox[1]:maxBBox[1],
-                (corner&4)?minBBox[2]:maxBBox[2]);
-        gluSphere(_sphere,2*r,20,10);
-        glPopMatrix();
-    }
-
-    glColor3f(1.0, 1.0, 0.0);
-    // --- Draw the X edges
-    for (int corner=0; corner<4; ++corner)
-    {
-        glPushMatrix();
-        glTranslated(           minBBox[0]           ,
-                (corner&1)?minBBox[1]:maxBBox[1],
-                (corner&2)?minBBox[2]:maxBBox[2]);
-        glRotatef(90,0,1,0);
-        gluCylinder(_tube, r, r, maxBBox[0] - minBBox[0], 10, 10);
-        glPopMatrix();
-    }
-
-    // --- Draw the Y edges
-    for (int corner=0; corner<4; ++corner)
-    {
-        glPushMatrix();
-        glTranslated((corner&1)?minBBox[0]:maxBBox[0],
-                minBBox[1]           ,
-                (corner&2)?minBBox[2]:maxBBox[2]);
-        glRotatef(-90,1,0,0);
-        gluCylinder(_tube, r, r, maxBBox[1] - minBBox[1], 10, 10);
-        glPopMatrix();
-    }
-
-    // --- Draw the Z edges
-    for (int corner=0; corner<4; ++corner)
-    {
-        glPushMatrix();
-        glTranslated((corner&1)?minBBox[0]:maxBBox[0],
-                (corner&2)?minBBox[1]:maxBBox[1],
-                minBBox[2]           );
-        gluCylinder(_tube, r, r, maxBBox[2] - minBBox[2], 10, 10);
-        glPopMatrix();
-    }
+    overlay.drawBox(minBBox, maxBBox, r);
 }
 
 
@@ -746,25 +574,7 @@ void SimpleGUI::DrawBox(SReal* minBBox, SReal* maxBBox, double r)
 void SimpleGUI::DrawXYPlane(double zo, double xmin, double xmax, double ymin,
         double ymax, double step)
 {
-    double x, y;
-
-    Enable<GL_DEPTH_TEST> depth;
-
-    glBegin(GL_LINES);
-    for (x = xmin; x <= xmax; x += step)
-    {
-        glVertex3d(x, ymin, zo);
-        glVertex3d(x, ymax, zo);
-    }
-    glEnd();
-
-    glBegin(GL_LINES);
-    for (y = ymin; y <= ymax; y += step)
-    {
-        glVertex3d(xmin, y, zo);
-        glVertex3d(xmax, y, zo);
-    }
-    glEnd();
+    overlay.drawXYPlane(zo, xmin, xmax, ymin, ymax, step);
 }
 
 
@@ -775,25 +585,7 @@ void SimpleGUI::DrawXYPlane(double zo, double xmin, double xmax, double ymin,
 void SimpleGUI::DrawYZPlane(double xo, double ymin, double ymax, double zmin,
         double zmax, double step)
 {
-    double y, z;
-    Enable<GL_DEPTH_TEST> depth;
-
-    glBegin(GL_LINES);
-    for (y = ymin; y <= ymax; y += step)
-    {
-        glVertex3d(xo, y, zmin);
-        glVertex3d(xo, y, zmax);
-    }
-    glEnd();
-
-    glBegin(GL_LINES);
-    for (z = zmin; z <= zmax; z += step)
-    {
-        glVertex3d(xo, ymin, z);
-        glVertex3d(xo, ymax, z);
-    }
-    glEnd();
-
+    overlay.drawYZPlane(xo, ymin, ymax, zmin, zmax, step);
 }
 
 
@@ -804,24 +596,7 @@ void SimpleGUI::DrawYZPlane(double xo, double ymin, double ymax, double zmin,
 void SimpleGUI::DrawXZPlane(double yo, double xmin, double xmax, double zmin,
         double zmax, double step)
 {
-    double x, z;
-    Enable<GL_DEPTH_TEST> depth;
-
-    glBegin(GL_LINES);
-    for (x = xmin; x <= xmax; x += step)
-    {
-        glVertex3d(x, yo, zmin);
-        glVertex3d(x, yo, zmax);
-    }
-    glEnd();
-
-    glBegin(GL_LINES);
-    for (z = zmin; z <= zmax; z += step)
-    {
-        glVertex3d(xmin, yo, z);
-        glVertex3d(xmax, yo, z);
-    }
-    glEnd();
+    overlay.drawXZPlane(yo, xmin, xmax, zmin, zmax, step);
 }
 
 // -------------------------------------------------------------------
@@ -829,48 +604,7 @@ void SimpleGUI::DrawXZPlane(double yo, double xmin, double xmax, double zmin,
 // -------------------------------------------------------------------
 void SimpleGUI::DrawLogo()
 {
-    int w = 0;
-    int h = 0;
-
-    if (texLogo && texLogo->getImage() && texLogo->getImage()->isLoaded())
-    {
-        h = texLogo->getImage()->getHeight();
-        w = texLogo->getImage()->getWidth();
-    }
-    else return;
-
-    Enable <GL_TEXTURE_2D> tex;
-    glDisable(GL_DEPTH_TEST);
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(-0.5, _W, -0.5, _H, -1.0, 1.0);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-
-    if (texLogo)
-        texLogo->bind();
-
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glBegin(GL_QUADS);
-    glTexCoord2d(0.0, 0.0);
-    glVertex3d((_W-w)/2, (_H-h)/2, 0.0);
-
-    glTexCoord2d(1.0, 0.0);
-    glVertex3d( _W-(_W-w)/2, (_H-h)/2, 0.0);
-
-    glTexCoord2d(1.0, 1.0);
-    glVertex3d( _W-(_W-w)/2, _H-(_H-h)/2, 0.0);
-
-    glTexCoord2d(0.0, 1.0);
-    glVertex3d((_W-w)/2, _H-(_H-h)/2, 0.0);
-    glEnd();
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
+    overlay.drawLogo(texLogo, _W, _H);
 }
 
 // -------------------------------------------------------------------
@@ -1308,6 +1042,8 @@ void SimpleGUI::keyPressEvent ( int k )
 
         case 'q': //GLUT_KEY_Escape:
         {
+            // the overlay buffers must be released while the context is current
+            overlay.release();
             exit(0);
         }
 
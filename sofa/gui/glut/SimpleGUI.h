@@ -28,6 +28,7 @@
 #include "../BaseGUI.h"
 
 #include "../PickHandler.h"
+#include "../ViewerOverlayRenderer.h"
 
 #include <sofa/helper/system/config.h>
 #include <sofa/defaulttype/Vec.h>
@@ -125,6 +126,7 @@ public:
     static void glut_motion(int x, int y);
     static void glut_special(int k, int x, int y);
     static void glut_idle();
+    static void glut_close();
 
 private:
 
@@ -169,10 +171,7 @@ private:
     float			_panSpeed;
     //Transformation	_sceneTransform;
     Vector3			_previousEyePos;
-    GLUquadricObj*	_arrow;
-    GLUquadricObj*	_tube;
-    GLUquadricObj*	_sphere;
-    GLUquadricObj*	_disk;
+    sofa::gui::ViewerOverlayRenderer overlay;
     GLuint			_numOBJmodels;
     GLuint			_materialMode;
     GLboolean		_facetNormal;
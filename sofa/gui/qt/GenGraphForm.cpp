@@ -562,6 +562,17 @@ void GenGraphForm::setScene(sofa::simulation::Node* scene)
     graph = scene;
 }
 
+void GenGraphForm::setScene(sofa::simulation::Node* scene, const std::string& sceneFilename)
+{
+    setScene(scene);
+    std::string gname(sceneFilename);
+    std::size_t gpath = gname.find_last_of("/\\");
+    std::size_t gext = gname.rfind('.');
+    if (gext != std::string::npos && (gpath == std::string::npos || gext > gpath))
+        gname = gname.substr(0,gext);
+    filename->setText(gname.c_str());
+}
+
 void GenGraphForm::killAllTasks()
 {
     exportButton->setText("&Export");
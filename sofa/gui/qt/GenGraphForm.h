@@ -39,6 +39,7 @@
 #include <list>
 #include <map>
 #include <set>
+#include <string>
 
 namespace sofa
 {
@@ -56,6 +57,8 @@ public:
     GenGraphForm();
 
     void setScene(sofa::simulation::Node* scene);
+    /// Set the scene, and the exported file next to the scene file, without its extension
+    void setScene(sofa::simulation::Node* scene, const std::string& sceneFilename);
 
 public slots:
     virtual void change();
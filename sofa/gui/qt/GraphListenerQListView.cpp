@@ -33,6 +33,13 @@
 #include "iconwarning.xpm"
 #include "icondata.xpm"
 
+#ifdef SOFA_QT4
+#include <QPainter>
+#else
+#include <qpainter.h>
+#endif
+
+#include <algorithm>
 
 namespace sofa
 {
@@ -56,19 +63,46 @@ static int hexval(char c)
     else return 0;
 }
 
-QPixmap* getPixmap(core::objectmodel::Base* obj)
+namespace
 {
-    using namespace sofa::simulation::Colors;
-    unsigned int flags=0;
 
-    if (core::objectmodel::BaseNode::DynamicCast(obj))
-    {
-        static QPixmap pixNode((const char**)iconnode_xpm);
-        return &pixNode;
-        //flags |= 1 << NODE;
-    }
-    else if (core::objectmodel::BaseObject::DynamicCast(obj))
+/// Categories of a class of components, computed once per class
+struct PixmapClassInfo
+{
+    bool isNode;
+    bool isObject;
+    /// categories which only depend on the class
+    unsigned int flags;
+    /// IFFIELD or FFIELD depending on the mechanical states of the instance
+    bool interactionForceField;
+    bool forceField;
+    /// MMAPPING or MAPPING depending on the instance
+    bool mapping;
+    bool visualModel;
+};
+
+} // namespace
+
+static const PixmapClassInfo& getPixmapClassInfo(core::objectmodel::Base* obj)
+{
+    using namespace sofa::simulation::Colors;
+    // the elements of an unordered_map are not moved when it grows
+    static std::unordered_map<const core::objectmodel::BaseClass*, PixmapClassInfo> classes;
+    const core::objectmodel::BaseClass* c = obj->getClass();
+    std::unordered_map<const core::objectmodel::BaseClass*, PixmapClassInfo>::const_iterator it = classes.find(c);
+    if (it != classes.end()) return it->second;
+
+    PixmapClassInfo info;
+    info.isNode = core::objectmodel::BaseNode::DynamicCast(obj) != NULL;
+    info.isObject = !info.isNode && core::objectmodel::BaseObject::DynamicCast(obj) != NULL;
+    info.flags = 0;
+    info.interactionForceField = false;
+    info.forceField = false;
+    info.mapping = false;
+    info.visualModel = false;
+    if (info.isObject)
     {
+        unsigned int flags = 0;
         if (core::objectmodel::ContextObject::DynamicCast(obj))
             flags |= 1 << CONTEXT;
         if (core::BehaviorModel::DynamicCast(obj))
@@ -81,11 +115,8 @@ QPixmap* getPixmap(core::objectmodel::Base* obj)
             flags |= 1 << PROJECTIVECONSTRAINTSET;
         if (core::behavior::BaseConstraintSet::DynamicCast(obj))
             flags |= 1 << CONSTRAINTSET;
-        if (core::behavior::BaseInteractionForceField::DynamicCast(obj) &&
-            core::behavior::BaseInteractionForceField::DynamicCast(obj)->getMechModel1()!=core::behavior::BaseInteractionForceField::DynamicCast(obj)->getMechModel2())
-            flags |= 1 << IFFIELD;
-        else if (core::behavior::BaseForceField::DynamicCast(obj))
-            flags |= 1 << FFIELD;
+        info.interactionForceField = core::behavior::BaseInteractionForceField::DynamicCast(obj) != NULL;
+        info.forceField = core::behavior::BaseForceField::DynamicCast(obj) != NULL;
         if (core::behavior::BaseAnimationLoop::DynamicCast(obj)
             || core::behavior::OdeSolver::DynamicCast(obj))
             flags |= 1 << SOLVER;
@@ -95,8 +126,7 @@ QPixmap* getPixmap(core::objectmodel::Base* obj)
             || core::collision::ContactManager::DynamicCast(obj)
             || core::collision::CollisionGroupManager::DynamicCast(obj))
             flags |= 1 << COLLISION;
-        if (core::BaseMapping::DynamicCast(obj))
-            flags |= 1 << ((core::BaseMapping::DynamicCast(obj))->isMechanical()?MMAPPING:MAPPING);
+        info.mapping = core::BaseMapping::DynamicCast(obj) != NULL;
         if (core::behavior::BaseMass::DynamicCast(obj))
             flags |= 1 << MASS;
         if (core::topology::Topology::DynamicCast(obj)
@@ -106,13 +136,39 @@ QPixmap* getPixmap(core::objectmodel::Base* obj)
             flags |= 1 << LOADER;
         if (core::objectmodel::ConfigurationSetting::DynamicCast(obj))
             flags |= 1 << CONFIGURATIONSETTING;
-        if (core::visual::VisualModel::DynamicCast(obj) && !flags)
-            flags |= 1 << VMODEL;
-        if (!flags)
-            flags |= 1 << OBJECT;
+        info.visualModel = core::visual::VisualModel::DynamicCast(obj) != NULL;
+        info.flags = flags;
     }
-    else return NULL;
+    return classes.insert(std::make_pair(c, info)).first->second;
+}
 
+static unsigned int getPixmapFlags(core::objectmodel::Base* obj, const PixmapClassInfo& info)
+{
+    using namespace sofa::simulation::Colors;
+    unsigned int flags = info.flags;
+    core::behavior::BaseInteractionForceField* iff = info.interactionForceField ? core::behavior::BaseInteractionForceField::DynamicCast(obj) : NULL;
+    if (iff && iff->getMechModel1() != iff->getMechModel2())
+        flags |= 1 << IFFIELD;
+    else if (info.forceField)
+        flags |= 1 << FFIELD;
+    if (info.mapping)
+        flags |= 1 << ((core::BaseMapping::DynamicCast(obj))->isMechanical()?MMAPPING:MAPPING);
+    if (info.visualModel && !flags)
+        flags |= 1 << VMODEL;
+    if (!flags)
+        flags |= 1 << OBJECT;
+    return flags;
+}
+
+static QPixmap* getNodePixmap()
+{
+    static QPixmap pixNode((const char**)iconnode_xpm);
+    return &pixNode;
+}
+
+static QPixmap* getFlagsPixmap(unsigned int flags)
+{
+    using namespace sofa::simulation::Colors;
     static std::map<unsigned int, QPixmap*> pixmaps;
     if (!pixmaps.count(flags))
     {
@@ -167,17 +223,86 @@ QPixmap* getPixmap(core::objectmodel::Base* obj)
     return pixmaps[flags];
 }
 
+QPixmap* getPixmap(core::objectmodel::Base* obj)
+{
+    if (!obj) return NULL;
+    const PixmapClassInfo& info = getPixmapClassInfo(obj);
+    if (info.isNode) return getNodePixmap();
+    if (!info.isObject) return NULL;
+    return getFlagsPixmap(getPixmapFlags(obj, info));
+}
+
+void getPixmaps(const std::vector<core::objectmodel::Base*>& objs, std::vector<QPixmap*>& pixmaps)
+{
+    pixmaps.resize(objs.size());
+    const core::objectmodel::BaseClass* lastClass = NULL;
+    const PixmapClassInfo* info = NULL;
+    unsigned int lastFlags = 0;
+    QPixmap* lastPixmap = NULL;
+    for (unsigned int i=0; i<objs.size(); ++i)
+    {
+        core::objectmodel::Base* obj = objs[i];
+        pixmaps[i] = NULL;
+        if (!obj) continue;
+        // the components of a node are often of the same class, e.g. the elements of a model
+        const core::objectmodel::BaseClass* c = obj->getClass();
+        if (c != lastClass)
+        {
+            info = &getPixmapClassInfo(obj);
+            lastClass = c;
+        }
+        if (info->isNode)
+            pixmaps[i] = getNodePixmap();
+        else if (info->isObject)
+        {
+            const unsigned int flags = getPixmapFlags(obj, *info);
+            if (flags != lastFlags)
+            {
+                lastPixmap = getFlagsPixmap(flags);
+                lastFlags = flags;
+            }
+            pixmaps[i] = lastPixmap;
+        }
+    }
+}
+
 
 
+/*****************************************************************************************************************/
+int GraphListViewItem::compare(Q3ListViewItem* i, int col, bool ascending) const
+{
+    if (col != 1)
+        return Q3ListViewItem::compare(i, col, ascending);
+    const double t = static_cast<GraphListViewItem*>(i)->stepTime;
+    if (stepTime < t) return -1;
+    if (stepTime > t) return 1;
+    return 0;
+}
+
+void GraphListViewItem::paintCell(QPainter* p, const QColorGroup& cg, int column, int width, int align)
+{
+    if (column != 1 || stepTime < 0)
+    {
+        Q3ListViewItem::paintCell(p, cg, column, width, align);
+        return;
+    }
+    // from green to red through yellow
+    QColor color;
+    color.setHsv((int)(120*(1-std::min(stepRatio, 1.0))), 160, 255);
+    QColorGroup heat(cg);
+    heat.setColor(QColorGroup::Base, color);
+    Q3ListViewItem::paintCell(p, heat, column, width, align);
+}
+
 /*****************************************************************************************************************/
 Q3ListViewItem* GraphListenerQListView::createItem(Q3ListViewItem* parent)
 {
     Q3ListViewItem* last = parent->firstChild();
     if (last == NULL)
-        return new Q3ListViewItem(parent);
+        return new GraphListViewItem(parent);
     while (last->nextSibling()!=NULL)
         last = last->nextSibling();
-    return new Q3ListViewItem(parent, last);
+    return new GraphListViewItem(parent, last);
 }
 
 
@@ -185,8 +310,10 @@ Q3ListViewItem* GraphListenerQListView::createItem(Q3ListViewItem* parent)
 /*****************************************************************************************************************/
 void GraphListenerQListView::addChild(Node* parent, Node* child)
 {
+    ++revision;
 
-    if (frozen) return;
+    if (recordAddition(parent, NULL, child, NULL)) return;
+    applyBatch();
     if (items.count(child))
     {
         Q3ListViewItem* item = items[child];
@@ -215,6 +342,7 @@ void GraphListenerQListView::addChild(Node* parent, Node* child)
                 QString name=QString("MultiNode ") + QString(child->getName().c_str());
                 item->setText(0, name);
                 nodeWithMultipleParents.insert(std::make_pair(items[child], item));
+                multiNodeItems[item] = items[child];
                 static QPixmap pixMultiNode((const char**)iconmultinode_xpm);
                 item->setPixmap(0, pixMultiNode);
             }
@@ -224,7 +352,7 @@ void GraphListenerQListView::addChild(Node* parent, Node* child)
     {
         Q3ListViewItem* item;
         if (parent == NULL)
-            item = new Q3ListViewItem(widget);
+            item = new GraphListViewItem(widget);
         else if (items.count(parent))
             item = createItem(items[parent]);
         else
@@ -250,6 +378,8 @@ void GraphListenerQListView::addChild(Node* parent, Node* child)
 
         item->setOpen(true);
         items[child] = item;
+        itemObjects[item] = child;
+        searchIndex.add(child, parent);
     }
     // Add all objects and grand-children
     MutationListener::addChild(parent, child);
@@ -258,29 +388,33 @@ void GraphListenerQListView::addChild(Node* parent, Node* child)
 /*****************************************************************************************************************/
 void GraphListenerQListView::removeChild(Node* parent, Node* child)
 {
+    ++revision;
+    cancelAddition(child, parent);
     MutationListener::removeChild(parent, child);
     if (items.count(child))
     {
-        delete items[child];
+        Q3ListViewItem* item = items[child];
+        std::pair<std::multimap<Q3ListViewItem *, Q3ListViewItem*>::iterator,
+            std::multimap<Q3ListViewItem *, Q3ListViewItem*>::iterator> range = nodeWithMultipleParents.equal_range(item);
+        for (std::multimap<Q3ListViewItem *, Q3ListViewItem*>::iterator it = range.first; it != range.second; ++it)
+            multiNodeItems.erase(it->second);
+        nodeWithMultipleParents.erase(range.first, range.second);
+        itemObjects.erase(item);
+        delete item;
         items.erase(child);
+        searchIndex.remove(child);
     }
 }
 
 /*****************************************************************************************************************/
 void GraphListenerQListView::moveChild(Node* previous, Node* parent, Node* child)
 {
-    if (frozen && items.count(child))
+    ++revision;
+    if (pendingAdditions.count(child))
     {
-        Q3ListViewItem* itemChild = items[child];
-        if (items.count(previous)) //itemChild->listView() != NULL)
-        {
-            Q3ListViewItem* itemPrevious = items[previous];
-            itemPrevious->takeItem(itemChild);
-        }
-        else
-        {
-            removeChild(previous, child);
-        }
+        // moved before its addition was applied
+        cancelAddition(child, previous);
+        addChild(parent, child);
         return;
     }
     if (!items.count(child) || !items.count(previous))
@@ -298,13 +432,16 @@ void GraphListenerQListView::moveChild(Node* previous, Node* parent, Node* child
         Q3ListViewItem* itemParent = items[parent];
         itemPrevious->takeItem(itemChild);
         itemParent->insertItem(itemChild);
+        searchIndex.add(child, parent);
     }
 }
 
 /*****************************************************************************************************************/
 void GraphListenerQListView::addObject(Node* parent, core::objectmodel::BaseObject* object)
 {
-    if (frozen) return;
+    ++revision;
+    if (recordAddition(parent, NULL, NULL, object)) return;
+    applyBatch();
     if (items.count(object))
     {
         Q3ListViewItem* item = items[object];
@@ -355,6 +492,8 @@ void GraphListenerQListView::addObject(Node* parent, core::objectmodel::BaseObje
 
 
         items[object] = item;
+        itemObjects[item] = object;
+        searchIndex.add(object, parent);
     }
     // Add all slaves
     MutationListener::addObject(parent, object);
@@ -364,23 +503,31 @@ void GraphListenerQListView::addObject(Node* parent, core::objectmodel::BaseObje
 /*****************************************************************************************************************/
 void GraphListenerQListView::removeObject(Node* parent, core::objectmodel::BaseObject* object)
 {
+    ++revision;
+    cancelAddition(object, parent);
     // Remove all slaves
     MutationListener::removeObject(parent, object);
     if (items.count(object))
     {
+        // the items of the datas are deleted with the item of the object
+        if (objectsShowingDatas.erase(object))
+            removeDatas(object);
+        itemObjects.erase(items[object]);
         delete items[object];
         items.erase(object);
+        searchIndex.remove(object);
     }
 }
 
 /*****************************************************************************************************************/
 void GraphListenerQListView::moveObject(Node* previous, Node* parent, core::objectmodel::BaseObject* object)
 {
-    if (frozen && items.count(object))
+    ++revision;
+    if (pendingAdditions.count(object))
     {
-        Q3ListViewItem* itemObject = items[object];
-        Q3ListViewItem* itemPrevious = items[previous];
-        itemPrevious->takeItem(itemObject);
+        // moved before its addition was applied
+        cancelAddition(object, previous);
+        addObject(parent, object);
         return;
     }
     if (!items.count(object) || !items.count(previous))
@@ -398,13 +545,16 @@ void GraphListenerQListView::moveObject(Node* previous, Node* parent, core::obje
         Q3ListViewItem* itemParent = items[parent];
         itemPrevious->takeItem(itemObject);
         itemParent->insertItem(itemObject);
+        searchIndex.add(object, parent);
     }
 }
 
 /*****************************************************************************************************************/
 void GraphListenerQListView::addSlave(core::objectmodel::BaseObject* master, core::objectmodel::BaseObject* slave)
 {
-    if (frozen) return;
+    ++revision;
+    if (recordAddition(NULL, master, NULL, slave)) return;
+    applyBatch();
     if (items.count(slave))
     {
         Q3ListViewItem* item = items[slave];
@@ -455,6 +605,8 @@ void GraphListenerQListView::addSlave(core::objectmodel::BaseObject* master, cor
 
 
         items[slave] = item;
+        itemObjects[item] = slave;
+        searchIndex.add(slave, master);
     }
     // Add all slaves
     MutationListener::addSlave(master, slave);
@@ -464,23 +616,30 @@ void GraphListenerQListView::addSlave(core::objectmodel::BaseObject* master, cor
 /*****************************************************************************************************************/
 void GraphListenerQListView::removeSlave(core::objectmodel::BaseObject* master, core::objectmodel::BaseObject* slave)
 {
+    ++revision;
+    cancelAddition(slave, master);
     // Remove all slaves
     MutationListener::removeSlave(master, slave);
     if (items.count(slave))
     {
+        if (objectsShowingDatas.erase(slave))
+            removeDatas(slave);
+        itemObjects.erase(items[slave]);
         delete items[slave];
         items.erase(slave);
+        searchIndex.remove(slave);
     }
 }
 
 /*****************************************************************************************************************/
 void GraphListenerQListView::moveSlave(core::objectmodel::BaseObject* previous, core::objectmodel::BaseObject* master, core::objectmodel::BaseObject* slave)
 {
-    if (frozen && items.count(slave))
+    ++revision;
+    if (pendingAdditions.count(slave))
     {
-        Q3ListViewItem* itemSlave = items[slave];
-        Q3ListViewItem* itemPrevious = items[previous];
-        itemPrevious->takeItem(itemSlave);
+        // moved before its addition was applied
+        cancelAddition(slave, previous);
+        addSlave(master, slave);
         return;
     }
     if (!items.count(slave) || !items.count(previous))
@@ -498,6 +657,7 @@ void GraphListenerQListView::moveSlave(core::objectmodel::BaseObject* previous,
         Q3ListViewItem* itemMaster = items[master];
         itemPrevious->takeItem(itemSlave);
         itemMaster->insertItem(itemSlave);
+        searchIndex.add(slave, master);
     }
 }
 
@@ -515,58 +675,122 @@ void GraphListenerQListView::unfreeze(Node* groot)
 {
     if (!items.count(groot)) return;
     frozen = false;
-    addChild(NULL, groot);
+    // only the additions recorded while frozen are applied, not the whole graph
+    applyBatch();
 }
 
 /*****************************************************************************************************************/
-core::objectmodel::Base* GraphListenerQListView::findObject(const Q3ListViewItem* item)
+bool GraphListenerQListView::recordAddition(Node* parent, core::objectmodel::BaseObject* master, Node* child, core::objectmodel::BaseObject* object)
 {
-    core::objectmodel::Base* base = NULL;
+    if (!batching && !frozen) return false;
+    Base* component = child ? (Base*)child : (Base*)object;
+    Mutation m;
+    m.parent = parent;
+    m.master = master;
+    m.child = child;
+    m.object = object;
+    pendingAdditions.insert(std::make_pair(component, (unsigned int)journal.size()));
+    journal.push_back(m);
+    return true;
+}
 
-    if(item)
+void GraphListenerQListView::cancelAddition(Base* component, Base* parent)
+{
+    std::pair<std::unordered_multimap<Base*, unsigned int>::iterator, std::unordered_multimap<Base*, unsigned int>::iterator> range = pendingAdditions.equal_range(component);
+    for (std::unordered_multimap<Base*, unsigned int>::iterator it = range.first; it != range.second;)
     {
-        for ( std::map<core::objectmodel::Base*, Q3ListViewItem* >::iterator it = items.begin() ; it != items.end() ; ++ it )
+        Mutation& m = journal[it->second];
+        Base* mparent = m.master ? (Base*)m.master : (Base*)m.parent;
+        if (parent == NULL || mparent == parent)
         {
-            if ( ( *it ).second == item )
-            {
-                base = (*it).first;
-                return base;
-            }
+            m.child = NULL;
+            m.object = NULL;
+            it = pendingAdditions.erase(it);
+            ++cancelledMutations;
         }
+        else
+            ++it;
     }
-    if (!base) //Can be a multi node
+    // components created and deleted at each step while frozen must not make the journal grow
+    if (cancelledMutations > 64 && 2*cancelledMutations > journal.size())
+        compactBatch();
+}
+
+void GraphListenerQListView::compactBatch()
+{
+    std::vector<Mutation> mutations;
+    mutations.reserve(journal.size() - cancelledMutations);
+    pendingAdditions.clear();
+    for (unsigned int i=0; i<journal.size(); ++i)
     {
-        std::multimap<Q3ListViewItem *, Q3ListViewItem*>::iterator it;
-        for (it=nodeWithMultipleParents.begin(); it!=nodeWithMultipleParents.end(); ++it)
-        {
-            if (it->second == item) return findObject(it->first);
-        }
+        const Mutation& m = journal[i];
+        if (!m.child && !m.object) continue;
+        Base* component = m.child ? (Base*)m.child : (Base*)m.object;
+        pendingAdditions.insert(std::make_pair(component, (unsigned int)mutations.size()));
+        mutations.push_back(m);
+    }
+    journal.swap(mutations);
+    cancelledMutations = 0;
+}
+
+void GraphListenerQListView::clearBatch()
+{
+    journal.clear();
+    pendingAdditions.clear();
+    cancelledMutations = 0;
+}
+
+void GraphListenerQListView::applyBatch()
+{
+    if (journal.empty() || frozen) return;
+    // the additions done here must not be recorded again, nor apply the batch recursively
+    std::vector<Mutation> mutations;
+    mutations.swap(journal);
+    pendingAdditions.clear();
+    cancelledMutations = 0;
+    const bool wasBatching = batching;
+    batching = false;
+    for (unsigned int i=0; i<mutations.size(); ++i)
+    {
+        const Mutation& m = mutations[i];
+        if (m.child)
+            addChild(m.parent, m.child);
+        else if (m.object && m.master)
+            addSlave(m.master, m.object);
+        else if (m.object)
+            addObject(m.parent, m.object);
     }
-    return base;
+    batching = wasBatching;
+}
+
+/*****************************************************************************************************************/
+core::objectmodel::Base* GraphListenerQListView::findObject(const Q3ListViewItem* item)
+{
+    if(!item) return NULL;
+
+    std::unordered_map<const Q3ListViewItem*, core::objectmodel::Base* >::const_iterator it = itemObjects.find(item);
+    if (it != itemObjects.end()) return it->second;
+
+    //Can be a multi node
+    std::unordered_map<const Q3ListViewItem*, Q3ListViewItem* >::const_iterator multi = multiNodeItems.find(item);
+    if (multi != multiNodeItems.end()) return findObject(multi->second);
+    return NULL;
 }
 
 /*****************************************************************************************************************/
 core::objectmodel::BaseData* GraphListenerQListView::findData(const Q3ListViewItem* item)
 // returns NULL if nothing is found.
 {
-    BaseData* data = NULL;
-    if(item)
-    {
-        std::map<BaseData*,Q3ListViewItem*>::const_iterator it;
-        for( it = datas.begin(); it != datas.end(); ++it)
-        {
-            if((*it).second == item)
-            {
-                data = (*it).first;
-            }
-        }
-    }
-    return data;
+    if(!item) return NULL;
+
+    std::unordered_map<const Q3ListViewItem*, core::objectmodel::BaseData* >::const_iterator it = itemDatas.find(item);
+    if (it != itemDatas.end()) return it->second;
+    return NULL;
 }
 /*****************************************************************************************************************/
 void GraphListenerQListView::removeDatas(core::objectmodel::BaseObject* parent)
 {
-    if (frozen) return;
+    ++revision;
 
     if( items.count(parent) )
     {
@@ -578,6 +802,7 @@ void GraphListenerQListView::removeDatas(core::objectmodel::BaseObject* parent)
             BaseData* data = (*it);
             if(datas.count(data))
             {
+                itemDatas.erase(datas[data]);
                 delete datas[data];
                 datas.erase(data);
             }
@@ -588,7 +813,7 @@ void GraphListenerQListView::removeDatas(core::objectmodel::BaseObject* parent)
 /*****************************************************************************************************************/
 void GraphListenerQListView::addDatas(sofa::core::objectmodel::BaseObject *parent)
 {
-    if (frozen) return;
+    ++revision;
     std::string name;
     if(items.count(parent))
     {
@@ -605,15 +830,47 @@ void GraphListenerQListView::addDatas(sofa::core::objectmodel::BaseObject *paren
                 name += "  ";
                 name += data->getName();
                 datas.insert(std::pair<BaseData*,Q3ListViewItem*>(data,new_item));
+                itemDatas[new_item] = data;
                 new_item->setText(0, name.c_str());
                 new_item->setPixmap(0,pixData);
-                widget->ensureItemVisible(new_item);
                 name.clear();
             }
         }
     }
 }
 
+/*****************************************************************************************************************/
+void GraphListenerQListView::setShowDatas(core::objectmodel::BaseObject* object, bool show)
+{
+    Q3ListViewItem* item = findItem(object);
+    if (show)
+    {
+        objectsShowingDatas.insert(object);
+        if (item == NULL) return;
+        item->setExpandable(true);
+        if (item->isOpen())
+            addDatas(object);
+    }
+    else
+    {
+        objectsShowingDatas.erase(object);
+        if (item == NULL) return;
+        removeDatas(object);
+        if (item->childCount() == 0)
+            item->setExpandable(false);
+    }
+}
+
+void GraphListenerQListView::openItem(Q3ListViewItem* item)
+{
+    Base* base = findObject(item);
+    if (base == NULL || !objectsShowingDatas.count(base)) return;
+    // the items of the datas created at a previous opening are kept
+    BaseObject* object = BaseObject::DynamicCast(base);
+    if (object)
+        addDatas(object);
+}
+
 
 
 
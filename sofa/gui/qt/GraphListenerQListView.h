@@ -28,6 +28,7 @@
 
 
 #include "SofaGUIQt.h"
+#include "SceneSearchIndex.h"
 
 #ifdef SOFA_QT4
 #include <Q3ListViewItem>
@@ -44,6 +45,10 @@ typedef QListView Q3ListView;
 #include <sofa/simulation/common/Simulation.h>
 #include <sofa/simulation/common/MutationListener.h>
 
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 
 
 namespace sofa
@@ -58,22 +63,77 @@ using sofa::simulation::Node;
 using sofa::simulation::Simulation;
 using sofa::simulation::MutationListener;
 
+/// Icon showing the categories of the component, which are computed once per class
 QPixmap* getPixmap(core::objectmodel::Base* obj);
+/// Icons of many components, looking up the class only when it changes between two of them
+void getPixmaps(const std::vector<core::objectmodel::Base*>& objs, std::vector<QPixmap*>& pixmaps);
+
+/// Item of the graph. The second column, when displayed, shows the time spent in the component
+/// or in the subtree of the node during a step, sorted numerically and colored as a heatmap.
+class SOFA_SOFAGUIQT_API GraphListViewItem : public Q3ListViewItem
+{
+public:
+    GraphListViewItem(Q3ListView* parent) : Q3ListViewItem(parent), stepTime(-1), stepRatio(0) {}
+    GraphListViewItem(Q3ListViewItem* parent) : Q3ListViewItem(parent), stepTime(-1), stepRatio(0) {}
+    GraphListViewItem(Q3ListViewItem* parent, Q3ListViewItem* after) : Q3ListViewItem(parent, after), stepTime(-1), stepRatio(0) {}
+
+    virtual int compare(Q3ListViewItem* i, int col, bool ascending) const;
+    virtual void paintCell(QPainter* p, const QColorGroup& cg, int column, int width, int align);
+
+    /// time in ms per step, negative if unknown
+    double stepTime;
+    /// from 0 to 1, part of the whole step giving the color
+    double stepRatio;
+};
 
 class SOFA_SOFAGUIQT_API GraphListenerQListView : public MutationListener
 {
 public:
     Q3ListView* widget;
     bool frozen;
-    std::map<core::objectmodel::Base*, Q3ListViewItem* > items;
+    std::unordered_map<core::objectmodel::Base*, Q3ListViewItem* > items;
     std::map<core::objectmodel::BaseData*, Q3ListViewItem* > datas;
     std::multimap<Q3ListViewItem *, Q3ListViewItem*> nodeWithMultipleParents;
+    /// reverse indices of items, datas and nodeWithMultipleParents, kept in sync with them
+    std::unordered_map<const Q3ListViewItem*, core::objectmodel::Base* > itemObjects;
+    std::unordered_map<const Q3ListViewItem*, core::objectmodel::BaseData* > itemDatas;
+    std::unordered_map<const Q3ListViewItem*, Q3ListViewItem* > multiNodeItems;
+    /// incremented by each mutation, so that a walk of the items done in several steps can detect them
+    unsigned int revision;
+    /// names and paths of the components which have an item
+    SceneSearchIndex searchIndex;
+    /// objects whose datas are shown, their items are only created once the object is opened
+    std::unordered_set<core::objectmodel::Base*> objectsShowingDatas;
+
+    /// Addition to the graph waiting for applyBatch
+    struct Mutation
+    {
+        Node* parent;                            ///< parent of a node or an object
+        core::objectmodel::BaseObject* master;   ///< master of a slave
+        Node* child;
+        core::objectmodel::BaseObject* object;
+    };
+    bool batching;
+    std::vector<Mutation> journal;
+    unsigned int cancelledMutations;
+    /// indices in journal of the pending additions of each component
+    std::unordered_multimap<core::objectmodel::Base*, unsigned int> pendingAdditions;
 
     GraphListenerQListView(Q3ListView* w)
-        : widget(w), frozen(false)
+        : widget(w), frozen(false), revision(0), batching(false), cancelledMutations(0)
     {
     }
 
+    /// Between beginBatch and endBatch, and while frozen, the additions are only recorded in
+    /// the journal. The subtree of an added node is read when the addition is applied, and an
+    /// addition cancelled by a removal is dropped. Removals and moves are always applied
+    /// immediately, as the removed components may be deleted right after.
+    void beginBatch() { batching = true; }
+    void endBatch() { batching = false; }
+    bool hasPendingMutations() const { return !journal.empty(); }
+    /// Apply the recorded additions, in their order. Nothing is done while frozen.
+    void applyBatch();
+
 
     /*****************************************************************************************************************/
     Q3ListViewItem* createItem(Q3ListViewItem* parent);
@@ -89,11 +149,30 @@ public:
     virtual void moveSlave(core::objectmodel::BaseObject* previousMaster, core::objectmodel::BaseObject* master, core::objectmodel::BaseObject* slave);
     virtual void addDatas(core::objectmodel::BaseObject* parent);
     virtual void removeDatas(core::objectmodel::BaseObject* parent);
+    /// Make the item of the object expandable, its datas are added when it is opened
+    void setShowDatas(core::objectmodel::BaseObject* object, bool show);
+    bool isShowingDatas(core::objectmodel::BaseObject* object) const { return objectsShowingDatas.count(object) != 0; }
+    /// Create the items of the datas of the opened item if they are shown
+    void openItem(Q3ListViewItem* item);
     virtual void freeze(Node* groot);
     virtual void unfreeze(Node* groot);
+    /// Item of the object, NULL if it is not in the graph. Unlike items[obj], nothing is inserted.
+    Q3ListViewItem* findItem(core::objectmodel::Base* obj) const
+    {
+        std::unordered_map<core::objectmodel::Base*, Q3ListViewItem* >::const_iterator it = items.find(obj);
+        return it != items.end() ? it->second : NULL;
+    }
     core::objectmodel::Base* findObject(const Q3ListViewItem* item);
     core::objectmodel::BaseData* findData(const Q3ListViewItem* item);
 
+protected:
+    /// Record the addition, return false if the batch is not active
+    bool recordAddition(Node* parent, core::objectmodel::BaseObject* master, Node* child, core::objectmodel::BaseObject* object);
+    /// Drop the pending additions of the component, only those below parent if it is not NULL
+    void cancelAddition(core::objectmodel::Base* component, core::objectmodel::Base* parent = NULL);
+    void clearBatch();
+    void compactBatch();
+
 };
 
 }
@@ -50,6 +50,43 @@ namespace qt
 typedef sofa::helper::system::thread::CTime CTime;
 
 bool cmpTime(const dataTime &a, const dataTime &b) { return a.time > b.time;};
+
+/// Time of the element, or of the timed elements below if it has none
+static double addElementTimes(TiXmlElement* element, std::map<std::string, double>& times)
+{
+    static double conversion=1000.0/(double)CTime::getTicksPerSec();
+    double time=-1;
+    double timeBelow=0;
+    for (TiXmlElement* child=element->FirstChildElement(); child != 0; child=child->NextSiblingElement())
+    {
+        if (std::string(child->Value()) == "Time")
+        {
+            TiXmlAttribute* attribute=child->FirstAttribute();
+            if (attribute) time=atof(attribute->Value())*conversion;
+        }
+        else
+            timeBelow += addElementTimes(child, times);
+    }
+    if (time < 0) return timeBelow;
+
+    if (std::string(element->Value()) == "Component" && time > timeBelow)
+    {
+        const char* ptr=element->Attribute("ptr");
+        if (ptr) times[ptr] += time-timeBelow;
+    }
+    return time;
+}
+
+bool GraphVisitor::addComponentTimes(const std::string &file, std::map<std::string, double>& times)
+{
+    TiXmlDocument doc;
+    doc.Parse(file.c_str());
+    TiXmlElement* pElem=doc.FirstChildElement();
+    if (!pElem) return false;
+    addElementTimes(pElem, times);
+    return true;
+}
+
 bool GraphVisitor::load(std::string &file)
 {
     //Open it using TinyXML
@@ -47,6 +47,7 @@
 #include <tinystr.h>
 
 #include <iostream>
+#include <map>
 #include <set>
 
 namespace sofa
@@ -78,6 +79,9 @@ public:
     void addTime(Q3ListViewItem *element, std::string info);
 
     bool load(std::string &file);
+    /// Add the time in ms spent in each component itself, without the components it called,
+    /// indexed by the "ptr" attribute of the components in the dump
+    static bool addComponentTimes(const std::string &file, std::map<std::string, double>& times);
 
     void setGraph(Q3ListView* g) {graph = g;}
     void clear() {graph->clear();}
@@ -69,7 +69,7 @@ ModifyObject::ModifyObject(
     Q3ListViewItem* item_clicked,
     QWidget* parent,
     const ModifyObjectFlags& dialogFlags,
-    const std::map<core::objectmodel::Base*, Q3ListViewItem* >& items,
+    const std::unordered_map<core::objectmodel::Base*, Q3ListViewItem* >& items,
     const char* name,
     bool modal, Qt::WFlags f )
     :QDialog(parent, name, modal, f),
@@ -191,12 +191,10 @@ void ModifyObject::createDialog(core::objectmodel::Base* base)
             auto parent = data->getParent();
             if (parent)
             {
-                for (std::map<core::objectmodel::Base*, Q3ListViewItem* >::const_iterator it2 = items_.begin(); it2 != items_.end(); ++it2)
+                std::unordered_map<core::objectmodel::Base*, Q3ListViewItem* >::const_iterator it2 = items_.find(parent->getOwner());
+                if (it2 != items_.end())
                 {
-                    if ((*it2).first == parent->getOwner())
-                    {
-                        componentReference = (*it2).second;
-                    }
+                    componentReference = (*it2).second;
                 }
             }
             if (!data->getGroup())
@@ -250,14 +248,12 @@ void ModifyObject::createDialog(core::objectmodel::Base* base)
         {
             core::objectmodel::BaseLink* link=*it;
             sofa::helper::vector<Q3ListViewItem*> componentReference;
-            for (std::map<core::objectmodel::Base*, Q3ListViewItem* >::const_iterator it2 = items_.begin(); it2 != items_.end(); ++it2)
+            for (unsigned i = 0; i < link->getSize() ; ++i)
             {
-                for (unsigned i = 0; i < link->getSize() ; ++i)
+                std::unordered_map<core::objectmodel::Base*, Q3ListViewItem* >::const_iterator it2 = items_.find(link->getLinkedBase(i));
+                if (it2 != items_.end())
                 {
-                    if ((*it2).first == link->getLinkedBase(i))
-                    {
-                        componentReference.push_back((*it2).second);
-                    }
+                    componentReference.push_back((*it2).second);
                 }
             }
             if (link->getName().empty()) continue; // ignore unnamed links
@@ -577,10 +573,57 @@ void ModifyObject::updateValues()
 }
 
 
+//*******************************************************************************************************************
+
+ModifyObject* ModifyObject::openFromGraphView(QWidget* view,
+        core::objectmodel::Base* base,
+        core::objectmodel::BaseData* data,
+        const QString& text,
+        Q3ListViewItem* item_clicked,
+        const std::unordered_map<core::objectmodel::Base*, Q3ListViewItem* >& items,
+        std::map< void*, QDialog* >& dialogs)
+{
+    void* Id = data ? (void*)data : (void*)base;
+    if (Id == NULL) return NULL;
+
+    //Object already being modified: no need to open a new window
+    std::map< void*, QDialog* >::iterator testWindow = dialogs.find(Id);
+    if (testWindow != dialogs.end())
+    {
+        testWindow->second->raise();
+        return NULL;
+    }
+
+    QString title = text;
+    core::objectmodel::BaseObject* baseObj = data ? NULL : core::objectmodel::BaseObject::DynamicCast(base);
+    if (baseObj)
+    {
+        core::objectmodel::BaseNode* bn = core::objectmodel::BaseNode::DynamicCast(baseObj->getContext());
+        if (bn && !bn->getPathName().empty())
+            title = title + QString(" (") + QString(bn->getPathName().c_str()) + QString(")");
+    }
+
+    ModifyObjectFlags dialogFlags = ModifyObjectFlags();
+    dialogFlags.setFlagsForSofa();
+    ModifyObject* dialogModifyObject = new ModifyObject(Id, item_clicked, view, dialogFlags, items, title);
+    if (data)
+        dialogModifyObject->createDialog(data);
+    else
+        dialogModifyObject->createDialog(base);
+
+    dialogs.insert(std::make_pair(Id, dialogModifyObject));
+    connect ( dialogModifyObject, SIGNAL( objectUpdated() ), view, SIGNAL( Updated() ));
+    connect ( view, SIGNAL( Close() ), dialogModifyObject, SLOT( closeNow() ) );
+    connect ( dialogModifyObject, SIGNAL( dialogClosed(void *) ) , view, SLOT( modifyUnlock(void *)));
+    connect ( dialogModifyObject, SIGNAL( dataModified(QString) ), view, SIGNAL( dataModified(QString) ) );
+    return dialogModifyObject;
+}
+
 //*******************************************************************************************************************
 
 void ModifyObject::updateListViewItem()
 {
+    if (item_ == NULL || item_->parent() == NULL) return;
     Q3ListViewItem* parent = item_->parent();
     QString currentName =parent->text(0);
     std::string name = parent->text(0).ascii();
@@ -35,6 +35,9 @@
 #include "WDoubleLineEdit.h"
 #include "QSofaListView.h"
 
+#include <map>
+#include <unordered_map>
+
 #ifdef SOFA_QT4
 #include <QDialog>
 #include <QWidget>
@@ -151,7 +154,7 @@ public:
             Q3ListViewItem* item_clicked,
             QWidget* parent,
             const ModifyObjectFlags& dialogFlags,
-            const std::map<core::objectmodel::Base*, Q3ListViewItem* >& items,
+            const std::unordered_map<core::objectmodel::Base*, Q3ListViewItem* >& items,
             const char* name= 0,
             bool  modal= FALSE,
             Qt::WFlags f= 0 );
@@ -163,6 +166,19 @@ public:
 
     const ModifyObjectFlags& getFlags() { return dialogFlags_;}
 
+    /// Open the dialog of a component or of a Data shown by a scene graph view, titled with
+    /// the text of its row. The dialogs of the view are indexed in dialogs by the component
+    /// or the Data: the opened one is raised and NULL is returned. The signals of the dialog
+    /// are connected to the Updated(), Close(), modifyUnlock(void*) and dataModified(QString)
+    /// signals and slots of the view.
+    static ModifyObject* openFromGraphView(QWidget* view,
+            core::objectmodel::Base* base,
+            core::objectmodel::BaseData* data,
+            const QString& text,
+            Q3ListViewItem* item_clicked,
+            const std::unordered_map<core::objectmodel::Base*, Q3ListViewItem* >& items,
+            std::map< void*, QDialog* >& dialogs);
+
     void createDialog(core::objectmodel::Base* node);
     void createDialog(core::objectmodel::BaseData* data);
     bool hideData(core::objectmodel::BaseData* data) { return (!data->isDisplayed()) && dialogFlags_.HIDE_FLAG;}
@@ -203,7 +219,7 @@ protected:
     QString parseDataModified();
     void* Id_;
     Q3ListViewItem* item_;
-    const std::map<core::objectmodel::Base*, Q3ListViewItem* >& items_;
+    const std::unordered_map<core::objectmodel::Base*, Q3ListViewItem* >& items_;
 
     core::objectmodel::Base* node;
     core::objectmodel::BaseData* data_;
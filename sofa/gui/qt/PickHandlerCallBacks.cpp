@@ -26,8 +26,10 @@
 #include "RealGUI.h"
 #include "viewer/SofaViewer.h"
 #include "QSofaListView.h"
+#include "QSofaTreeView.h"
 #include <sofa/core/objectmodel/BaseObject.h>
 #include <SofaUserInteraction/MouseInteractor.h>
+#include <sofa/helper/system/thread/CTime.h>
 
 #ifdef SOFA_QT4
 #   include <QStatusBar>
@@ -42,12 +44,12 @@ namespace qt
 {
 
 InformationOnPickCallBack::InformationOnPickCallBack()
-    :gui(NULL)
+    :gui(NULL), lastPicked(NULL), lastIndex(-1)
 {
 }
 
 InformationOnPickCallBack::InformationOnPickCallBack(RealGUI *g)
-    :gui(g)
+    :gui(g), lastPicked(NULL), lastIndex(-1)
 {
 }
 
@@ -56,23 +58,32 @@ void InformationOnPickCallBack::execute(const sofa::component::collision::BodyPi
     if(!gui) return;
     core::objectmodel::BaseObject *objectPicked=NULL;
     if (body.body)
-    {
-        Q3ListViewItem* item=gui->simulationGraph->getListener()->items[body.body];
-        gui->simulationGraph->ensureItemVisible(item);
-        gui->simulationGraph->clearSelection();
-        gui->simulationGraph->setSelected(item,true);
         objectPicked=body.body;
-    }
     else if (body.mstate)
-    {
-        Q3ListViewItem* item=gui->simulationGraph->getListener()->items[body.mstate];
-        gui->simulationGraph->ensureItemVisible(item);
-        gui->simulationGraph->clearSelection();
-        gui->simulationGraph->setSelected(item,true);
         objectPicked=body.mstate;
+
+    if (objectPicked == lastPicked && (!objectPicked || body.indexCollisionElement == lastIndex))
+        return;
+
+    // set before the selection, whose change notification compares it with the selected component
+    const bool pickedChanged = (objectPicked != lastPicked);
+    lastPicked = objectPicked;
+    lastIndex = body.indexCollisionElement;
+
+    if (pickedChanged && gui->sceneGraphView)
+    {
+        gui->sceneGraphView->selectComponent(objectPicked);
     }
-    else
+    else if (pickedChanged)
+    {
+        Q3ListViewItem* item = objectPicked ? gui->simulationGraph->getListener()->findItem(objectPicked) : NULL;
         gui->simulationGraph->clearSelection();
+        if (item)
+        {
+            gui->simulationGraph->ensureItemVisible(item);
+            gui->simulationGraph->setSelected(item,true);
+        }
+    }
 
     if (objectPicked)
     {
@@ -85,10 +96,32 @@ void InformationOnPickCallBack::execute(const sofa::component::collision::BodyPi
                 + QString(" : ") + QString(objectPicked->getClassName().c_str());
         if (!objectPicked->getTemplateName().empty())
             messagePicking += QString("<") + QString(objectPicked->getTemplateName().c_str()) + QString(">");
+        // timing of the narrow phase query which found the element, if it was used
+        PickHandler* pick = gui->getViewer() ? gui->getViewer()->getPickHandler() : NULL;
+        if (pick && pick->getLastNarrowPhaseStats().nbModels)
+        {
+            const PickingNarrowPhase::Stats& stats = pick->getLastNarrowPhaseStats();
+            const double ms = 1000.0 * (double)stats.time / (double)sofa::helper::system::thread::CTime::getRefTicksPerSec();
+            messagePicking += QString("  [narrow phase: ") + QString::number(stats.nbCandidateElements)
+                    + QString(" elements of ") + QString::number(stats.nbCandidateModels)
+                    + QString("/") + QString::number(stats.nbModels)
+                    + QString(" models, ") + QString::number(ms, 'f', 3) + QString(" ms]");
+        }
         gui->statusBar()->message(messagePicking,3000); //display message during 3 seconds
     }
 }
 
+void InformationOnPickCallBack::reset()
+{
+    lastPicked = NULL;
+    lastIndex = -1;
+}
+
+void InformationOnPickCallBack::selectionChanged(core::objectmodel::Base* selected)
+{
+    if (selected != lastPicked) reset();
+}
+
 ColourPickingRenderCallBack::ColourPickingRenderCallBack()
     :_viewer(NULL)
 {
@@ -54,9 +54,18 @@ class InformationOnPickCallBack: public CallBackPicker
 public:
     InformationOnPickCallBack();
     InformationOnPickCallBack(RealGUI *g);
+    /// Select the picked component in the graph and show it in the status bar.
+    /// Nothing is done while the same element stays under the mouse, and the
+    /// graph selection only changes when the picked component changes.
     void execute(const sofa::component::collision::BodyPicked &body);
+    /// Forget the last picked element, so that the next pick selects it again
+    void reset();
+    /// To be called when the graph selection changes, reset if it is not the picked component
+    void selectionChanged(core::objectmodel::Base* selected);
 protected:
     RealGUI *gui;
+    core::objectmodel::Base* lastPicked;
+    int lastIndex;
 };
 
 
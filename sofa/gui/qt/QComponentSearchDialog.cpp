@@ -0,0 +1,170 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "QComponentSearchDialog.h"
+#include "QSofaListView.h"
+#include "GraphListenerQListView.h"
+
+#ifdef SOFA_QT4
+#include <QVBoxLayout>
+#include <Q3Header>
+#else
+#include <qlayout.h>
+#include <qheader.h>
+#endif
+
+#include <unordered_set>
+#include <vector>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+namespace qt
+{
+
+using sofa::core::objectmodel::Base;
+
+QComponentSearchDialog::QComponentSearchDialog(QSofaListView* graph, QWidget* parent)
+    : QDialog(parent)
+    , graph(graph)
+{
+    setCaption(QString("Go to component"));
+    QVBoxLayout* layout = new QVBoxLayout(this);
+
+    searchEdit = new QLineEdit(this);
+    layout->addWidget(searchEdit);
+
+    countLabel = new QLabel(this);
+    layout->addWidget(countLabel);
+
+    resultsView = new Q3ListView(this);
+    resultsView->addColumn(QString("Name"));
+    resultsView->addColumn(QString("Class"));
+    resultsView->addColumn(QString("Path"));
+    for (int i = 0; i < resultsView->header()->count(); ++i)
+        resultsView->header()->setResizeEnabled(true, i);
+    resultsView->setSorting(-1);
+    resultsView->setAllColumnsShowFocus(true);
+    resultsView->setResizeMode(Q3ListView::LastColumn);
+    layout->addWidget(resultsView);
+
+    resize(600, 400);
+
+    connect(searchEdit, SIGNAL(textChanged(const QString&)), this, SLOT(search(const QString&)));
+    connect(searchEdit, SIGNAL(returnPressed()), this, SLOT(selectCurrent()));
+#ifdef SOFA_QT4
+    connect(resultsView, SIGNAL(doubleClicked(Q3ListViewItem*)), this, SLOT(selectItem(Q3ListViewItem*)));
+    connect(resultsView, SIGNAL(returnPressed(Q3ListViewItem*)), this, SLOT(selectItem(Q3ListViewItem*)));
+#else
+    connect(resultsView, SIGNAL(doubleClicked(QListViewItem*)), this, SLOT(selectItem(QListViewItem*)));
+    connect(resultsView, SIGNAL(returnPressed(QListViewItem*)), this, SLOT(selectItem(QListViewItem*)));
+#endif
+}
+
+void QComponentSearchDialog::popup()
+{
+    searchEdit->clear();
+    search(QString());
+    show();
+    raise();
+    searchEdit->setFocus();
+}
+
+void QComponentSearchDialog::search(const QString& text)
+{
+    resultsView->clear();
+    resultComponents.clear();
+    countLabel->setText(QString());
+    GraphListenerQListView* listener = graph->getListener();
+    if (listener == NULL || text.isEmpty()) return;
+
+    const SceneSearchIndex& index = listener->searchIndex;
+    const std::string str = SceneSearchIndex::toLower(std::string(text.ascii()));
+    // from the most to the least relevant matches, a component is listed at its first match
+    std::vector<Base*> found;
+    index.findPrefix(str, SceneSearchIndex::NameMask, found);
+    index.findSubstring(str, SceneSearchIndex::NameMask, found);
+    index.findSubstring(str, SceneSearchIndex::ClassNameMask | SceneSearchIndex::TemplateNameMask, found);
+    index.findSubstring(str, SceneSearchIndex::PathMask, found);
+
+    std::unordered_set<Base*> listed;
+    Q3ListViewItem* last = NULL;
+    unsigned int nbResults = 0;
+    for (unsigned int i = 0; i < found.size(); ++i)
+    {
+        if (!listed.insert(found[i]).second) continue;
+        if (++nbResults > MaxResults) continue;
+
+        Base* component = found[i];
+        std::string className = component->getClassName();
+        const std::string templateName = component->getTemplateName();
+        if (!templateName.empty())
+            className += "<" + templateName + ">";
+        Q3ListViewItem* item = last ? new Q3ListViewItem(resultsView, last) : new Q3ListViewItem(resultsView);
+        item->setText(0, QString(component->getName().c_str()));
+        item->setText(1, QString(className.c_str()));
+        item->setText(2, QString(index.getPath(component).c_str()));
+        resultComponents[item] = component;
+        last = item;
+    }
+
+    if (nbResults > MaxResults)
+        countLabel->setText(QString("%1 components, the first %2 are listed").arg(nbResults).arg((int)MaxResults));
+    else
+        countLabel->setText(QString("%1 components").arg(nbResults));
+    if (resultsView->firstChild())
+    {
+        resultsView->setCurrentItem(resultsView->firstChild());
+        resultsView->setSelected(resultsView->firstChild(), true);
+    }
+}
+
+void QComponentSearchDialog::selectCurrent()
+{
+    selectItem(resultsView->currentItem());
+}
+
+void QComponentSearchDialog::selectItem(Q3ListViewItem* item)
+{
+    std::map<Q3ListViewItem*, Base*>::const_iterator it = resultComponents.find(item);
+    if (it == resultComponents.end()) return;
+    // the component may have been removed from the scene since the search
+    GraphListenerQListView* listener = graph->getListener();
+    if (listener == NULL || !listener->searchIndex.contains(it->second))
+    {
+        search(searchEdit->text());
+        return;
+    }
+    emit componentSelected(it->second);
+    hide();
+}
+
+} // namespace qt
+
+} // namespace gui
+
+} // namespace sofa
@@ -0,0 +1,100 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_QT_QCOMPONENTSEARCHDIALOG_H
+#define SOFA_GUI_QT_QCOMPONENTSEARCHDIALOG_H
+
+#include "SofaGUIQt.h"
+
+#ifdef SOFA_QT4
+#include <QDialog>
+#include <QLineEdit>
+#include <QLabel>
+#include <Q3ListView>
+#include <Q3ListViewItem>
+#else
+#include <qdialog.h>
+#include <qlineedit.h>
+#include <qlabel.h>
+#include <qlistview.h>
+#endif
+
+#include <sofa/core/objectmodel/Base.h>
+
+#include <map>
+
+#ifndef SOFA_QT4
+typedef QListView Q3ListView;
+typedef QListViewItem Q3ListViewItem;
+#endif
+
+namespace sofa
+{
+
+namespace gui
+{
+
+namespace qt
+{
+
+class QSofaListView;
+
+/// "Go to component" dialog, looking up the typed text in the search index of the graph.
+/// The components whose name starts with the text come first, then those containing it
+/// in their name, in their class or template, and in their path.
+class SOFA_SOFAGUIQT_API QComponentSearchDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    QComponentSearchDialog(QSofaListView* graph, QWidget* parent);
+
+public slots:
+    /// Show the dialog with an empty query
+    void popup();
+    void search(const QString& text);
+
+signals:
+    void componentSelected(sofa::core::objectmodel::Base*);
+
+protected slots:
+    void selectCurrent();
+    void selectItem(Q3ListViewItem* item);
+
+protected:
+    enum { MaxResults = 200 };
+
+    QSofaListView* graph;
+    QLineEdit* searchEdit;
+    QLabel* countLabel;
+    Q3ListView* resultsView;
+    std::map<Q3ListViewItem*, sofa::core::objectmodel::Base*> resultComponents;
+};
+
+} // namespace qt
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_QT_QCOMPONENTSEARCHDIALOG_H
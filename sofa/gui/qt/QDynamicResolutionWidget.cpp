@@ -0,0 +1,127 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "QDynamicResolutionWidget.h"
+#include "WDoubleLineEdit.h"
+#include "viewer/qt/QtViewer.h"
+
+#ifdef SOFA_QT4
+#include <QVBoxLayout>
+#include <QGridLayout>
+#else
+#include <qlayout.h>
+#endif
+
+namespace sofa
+{
+
+namespace gui
+{
+
+namespace qt
+{
+
+QDynamicResolutionWidget::QDynamicResolutionWidget(viewer::qt::QtViewer* viewer, QWidget* parent)
+    : QWidget(parent)
+    , viewer(viewer)
+{
+    QVBoxLayout* layout = new QVBoxLayout(this);
+
+    enableDynamicResolution = new QCheckBox(QString("Dynamic resolution"), this);
+    enableDynamicResolution->setChecked(viewer->getDynamicResolution());
+    layout->addWidget(enableDynamicResolution);
+
+    QGridLayout* parameters = new QGridLayout();
+    parameters->addWidget(new QLabel(QString("Target frame time (ms)"), this), 0, 0);
+    targetFrameTime = new WDoubleLineEdit(this, "targetFrameTime");
+    targetFrameTime->setMinValue(1.0);
+    targetFrameTime->setMaxValue(1000.0);
+    targetFrameTime->setValue(viewer->getTargetFrameTime());
+    parameters->addWidget(targetFrameTime, 0, 1);
+
+    parameters->addWidget(new QLabel(QString("Minimum scale"), this), 1, 0);
+    minScale = new WDoubleLineEdit(this, "minScale");
+    minScale->setMinValue(0.1);
+    minScale->setMaxValue(2.0);
+    minScale->setValue(viewer->getMinResolutionScale());
+    parameters->addWidget(minScale, 1, 1);
+
+    parameters->addWidget(new QLabel(QString("Maximum scale"), this), 2, 0);
+    maxScale = new WDoubleLineEdit(this, "maxScale");
+    maxScale->setMinValue(0.1);
+    maxScale->setMaxValue(2.0);
+    maxScale->setValue(viewer->getMaxResolutionScale());
+    parameters->addWidget(maxScale, 2, 1);
+    layout->addLayout(parameters);
+
+    scaleLabel = new QLabel(this);
+    layout->addWidget(scaleLabel);
+    layout->addStretch();
+
+    connect(enableDynamicResolution, SIGNAL(toggled(bool)), this, SLOT(setDynamicResolution(bool)));
+    connect(targetFrameTime, SIGNAL(ValueChanged(double)), this, SLOT(setTargetFrameTime(double)));
+    connect(minScale, SIGNAL(ValueChanged(double)), this, SLOT(setScaleLimits()));
+    connect(maxScale, SIGNAL(ValueChanged(double)), this, SLOT(setScaleLimits()));
+    connect(&refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+
+    // the mode can also be toggled from the viewer keyboard shortcut
+    refreshTimer.start(500);
+    refresh();
+}
+
+void QDynamicResolutionWidget::setDynamicResolution(bool enabled)
+{
+    viewer->setDynamicResolution(enabled);
+    refresh();
+}
+
+void QDynamicResolutionWidget::setTargetFrameTime(double ms)
+{
+    viewer->setTargetFrameTime(ms);
+}
+
+void QDynamicResolutionWidget::setScaleLimits()
+{
+    viewer->setResolutionScaleLimits(minScale->Value(), maxScale->Value());
+    // show the limits as corrected by the viewer
+    minScale->setValue(viewer->getMinResolutionScale());
+    maxScale->setValue(viewer->getMaxResolutionScale());
+    refresh();
+}
+
+void QDynamicResolutionWidget::refresh()
+{
+    if (enableDynamicResolution->isChecked() != viewer->getDynamicResolution())
+        enableDynamicResolution->setChecked(viewer->getDynamicResolution());
+    if (viewer->getDynamicResolution())
+        scaleLabel->setText(QString("Current scale : %1").arg(viewer->getResolutionScale(), 0, 'f', 2));
+    else
+        scaleLabel->setText(QString("Current scale : -"));
+}
+
+} // namespace qt
+
+} // namespace gui
+
+} // namespace sofa
@@ -0,0 +1,91 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_QT_QDYNAMICRESOLUTIONWIDGET_H
+#define SOFA_GUI_QT_QDYNAMICRESOLUTIONWIDGET_H
+
+#include "SofaGUIQt.h"
+
+#ifdef SOFA_QT4
+#include <QWidget>
+#include <QCheckBox>
+#include <QLabel>
+#include <QTimer>
+#else
+#include <qwidget.h>
+#include <qcheckbox.h>
+#include <qlabel.h>
+#include <qtimer.h>
+#endif
+
+class WDoubleLineEdit;
+
+namespace sofa
+{
+
+namespace gui
+{
+
+namespace qt
+{
+
+namespace viewer
+{
+namespace qt
+{
+class QtViewer;
+}
+}
+
+/// Viewer tab configuring the dynamic resolution of a QtViewer: target frame time
+/// and limits of the resolution scale.
+class SOFA_SOFAGUIQT_API QDynamicResolutionWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    QDynamicResolutionWidget(viewer::qt::QtViewer* viewer, QWidget* parent);
+
+public slots:
+    void setDynamicResolution(bool enabled);
+    void setTargetFrameTime(double ms);
+    void setScaleLimits();
+    void refresh();
+
+protected:
+    viewer::qt::QtViewer* viewer;
+    QCheckBox* enableDynamicResolution;
+    WDoubleLineEdit* targetFrameTime;
+    WDoubleLineEdit* minScale;
+    WDoubleLineEdit* maxScale;
+    QLabel* scaleLabel;
+    QTimer refreshTimer;
+};
+
+} // namespace qt
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_QT_QDYNAMICRESOLUTIONWIDGET_H
@@ -0,0 +1,147 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "QGLProfilerWidget.h"
+#include "FileManagement.h"
+#include "../GLFrameProfiler.h"
+
+#ifdef SOFA_QT4
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <Q3Header>
+#else
+#include <qlayout.h>
+#include <qheader.h>
+#endif
+
+namespace sofa
+{
+
+namespace gui
+{
+
+namespace qt
+{
+
+QGLProfilerWidget::QGLProfilerWidget(sofa::gui::GLFrameProfiler* profiler, QWidget* parent)
+    : QWidget(parent)
+    , profiler(profiler)
+{
+    QVBoxLayout* layout = new QVBoxLayout(this);
+
+    QHBoxLayout* buttons = new QHBoxLayout();
+    enableProfiling = new QCheckBox(QString("Profile frames"), this);
+    enableProfiling->setChecked(profiler->isEnabled());
+    buttons->addWidget(enableProfiling);
+    logButton = new QPushButton(QString("Log to file..."), this);
+    buttons->addWidget(logButton);
+    layout->addLayout(buttons);
+
+    frameLabel = new QLabel(this);
+    layout->addWidget(frameLabel);
+
+    sectionsView = new Q3ListView(this);
+    sectionsView->addColumn(QString("Section"));
+    sectionsView->addColumn(QString("Calls"));
+    sectionsView->addColumn(QString("CPU (ms)"));
+    sectionsView->addColumn(QString("GPU (ms)"));
+    for (int i = 0; i < sectionsView->header()->count(); ++i)
+        sectionsView->header()->setResizeEnabled(true, i);
+    sectionsView->setSorting(-1);
+    sectionsView->setResizeMode(Q3ListView::LastColumn);
+    layout->addWidget(sectionsView);
+
+    connect(enableProfiling, SIGNAL(toggled(bool)), this, SLOT(setProfilingEnabled(bool)));
+    connect(logButton, SIGNAL(clicked()), this, SLOT(toggleLog()));
+    connect(&refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+
+    setProfilingEnabled(profiler->isEnabled());
+}
+
+void QGLProfilerWidget::setProfilingEnabled(bool enabled)
+{
+    profiler->setEnabled(enabled);
+    if (enabled)
+        refreshTimer.start(500);
+    else
+        refreshTimer.stop();
+    refresh();
+}
+
+void QGLProfilerWidget::toggleLog()
+{
+    if (profiler->isLogging())
+    {
+        profiler->stopLog();
+    }
+    else
+    {
+        QString filename = getSaveFileName(this, QString("frames.csv"), "CSV (*.csv);;All (*)", "save file dialog", "Choose where to log the frame times");
+        if (filename.isEmpty()) return;
+        if (profiler->startLog(filename.toStdString()) && !profiler->isEnabled())
+            enableProfiling->setChecked(true);
+    }
+    logButton->setText(profiler->isLogging() ? QString("Stop log") : QString("Log to file..."));
+}
+
+QString QGLProfilerWidget::formatTime(double ms)
+{
+    if (ms < 0) return QString("-");
+    return QString::number(ms, 'f', 3);
+}
+
+void QGLProfilerWidget::refresh()
+{
+    const sofa::gui::GLFrameProfiler::Section& frame = profiler->getFrame();
+    frameLabel->setText(QString("Frame %1 : CPU %2 ms, GPU %3 ms")
+            .arg(profiler->getFrameCount())
+            .arg(formatTime(frame.cpuTime))
+            .arg(formatTime(frame.gpuTime)));
+
+    const std::vector<sofa::gui::GLFrameProfiler::Section>& sections = profiler->getSections();
+
+    // items are kept in the order of the sections, new sections are appended
+    Q3ListViewItem* item = sectionsView->firstChild();
+    Q3ListViewItem* last = NULL;
+    for (unsigned int i = 0; i < sections.size(); ++i)
+    {
+        const sofa::gui::GLFrameProfiler::Section& s = sections[i];
+        if (!item)
+        {
+            item = last ? new Q3ListViewItem(sectionsView, last) : new Q3ListViewItem(sectionsView);
+            item->setText(0, QString(s.name.c_str()));
+        }
+        item->setText(1, QString::number(s.nbCalls));
+        item->setText(2, formatTime(s.cpuTime));
+        item->setText(3, formatTime(s.gpuTime));
+        last = item;
+        item = item->nextSibling();
+    }
+}
+
+} // namespace qt
+
+} // namespace gui
+
+} // namespace sofa
@@ -0,0 +1,92 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_QT_QGLPROFILERWIDGET_H
+#define SOFA_GUI_QT_QGLPROFILERWIDGET_H
+
+#include "SofaGUIQt.h"
+
+#ifdef SOFA_QT4
+#include <QWidget>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QTimer>
+#include <Q3ListView>
+#include <Q3ListViewItem>
+#else
+#include <qwidget.h>
+#include <qcheckbox.h>
+#include <qpushbutton.h>
+#include <qlabel.h>
+#include <qtimer.h>
+#include <qlistview.h>
+#endif
+
+#ifndef SOFA_QT4
+typedef QListView Q3ListView;
+typedef QListViewItem Q3ListViewItem;
+#endif
+
+namespace sofa
+{
+
+namespace gui
+{
+
+class GLFrameProfiler;
+
+namespace qt
+{
+
+/// Viewer tab displaying the CPU and GPU times measured by a GLFrameProfiler.
+class SOFA_SOFAGUIQT_API QGLProfilerWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    QGLProfilerWidget(sofa::gui::GLFrameProfiler* profiler, QWidget* parent);
+
+public slots:
+    void setProfilingEnabled(bool enabled);
+    void toggleLog();
+    void refresh();
+
+protected:
+    static QString formatTime(double ms);
+
+    sofa::gui::GLFrameProfiler* profiler;
+    QCheckBox* enableProfiling;
+    QPushButton* logButton;
+    QLabel* frameLabel;
+    Q3ListView* sectionsView;
+    QTimer refreshTimer;
+};
+
+} // namespace qt
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_QT_QGLPROFILERWIDGET_H
@@ -34,11 +34,17 @@
 
 #ifdef SOFA_QT4
 #include <Q3PopupMenu>
+#include <QTime>
 #else
 #include <qapplication.h>
 #include <qpopupmenu.h>
+#include <qdatetime.h>
 #endif
 
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
 
 
 using namespace sofa::simulation;
@@ -92,10 +98,16 @@ QSofaListView::QSofaListView(const SofaListViewAttribute& attribute,
     header()->setResizeEnabled(false, header()->count() - 1);
     header()->setLabel(0, QString());
 
-	searchName_ = true;
-	searchType_ = true;
-    activatedFilter_ = true;
-	displayChildrenWhenParentMatches_ = true;
+    filterTimer_ = new QTimer(this);
+    filterRevision_ = 0;
+    filterLocked_ = false;
+    connect(filterTimer_, SIGNAL(timeout()), this, SLOT(processFilterSlice()));
+
+    mutationTimer_ = new QTimer(this);
+    connect(mutationTimer_, SIGNAL(timeout()), this, SLOT(applyMutationBatch()));
+
+    showStepTimes_ = false;
+    stepTimeRevision_ = 0;
 
     setRootIsDecorated(true);
     setTreeStepSize(15);
@@ -105,18 +117,20 @@ QSofaListView::QSofaListView(const SofaListViewAttribute& attribute,
     connect(this,SIGNAL(doubleClicked(Q3ListViewItem*) ), this, SLOT(RunSofaDoubleClicked(Q3ListViewItem*)) );
     connect(this,SIGNAL(clicked(Q3ListViewItem*) ), this, SLOT(updateMatchingObjectmodel(Q3ListViewItem*)) );
     connect(this,SIGNAL(selectionChanged(Q3ListViewItem*)), this, SLOT(updateMatchingObjectmodel(Q3ListViewItem*)));
+    connect(this,SIGNAL(expanded(Q3ListViewItem*)), this, SLOT(itemExpanded(Q3ListViewItem*)));
 #else
     connect(this,SIGNAL(rightButtonClicked(QListViewItem*,const QPoint&, int)) ,this,SLOT(RunSofaRightClicked(QListViewItem*,const QPoint&, int)) );
     connect(this,SIGNAL(doubleClicked(QListViewItem*) ), this, SLOT(RunSofaDoubleClicked(QListViewItem*)) );
     connect(this,SIGNAL(clicked(QListViewItem*) ), this, SLOT(updateMatchingObjectmodel(QListViewItem*)) );
     connect(this,SIGNAL(selectionChanged(QListViewItem*)), this, SLOT(updateMatchingObjectmodel(QListViewItem*)));
+    connect(this,SIGNAL(expanded(QListViewItem*)), this, SLOT(itemExpanded(QListViewItem*)));
 
 #endif
 }
 
 QSofaListView::~QSofaListView()
 {
-
+    stopFilter();
     delete graphListener_;
 }
 
@@ -131,6 +145,9 @@ void QSofaListView::Clear(Node* rootNode)
         delete graphListener_;
     }
 
+    stopFilter();
+    filterKeys_.clear();
+    mutationTimer_->stop();
     CloseAllDialogs();
     clear();
     graphListener_ = new GraphListenerQListView(this);
@@ -138,7 +155,7 @@ void QSofaListView::Clear(Node* rootNode)
     header()->hide();
     graphListener_->addChild ( NULL, rootNode );
     graphListener_->freeze ( rootNode );
-    std::map<Base*, Q3ListViewItem* >::iterator graph_iterator;
+    std::unordered_map<Base*, Q3ListViewItem* >::iterator graph_iterator;
 
     for (graph_iterator = graphListener_->items.begin();
             graph_iterator != graphListener_->items.end();
@@ -153,6 +170,14 @@ void QSofaListView::Clear(Node* rootNode)
         }
     }
 
+    stepTimeItems_.clear();
+    sceneOrder_.clear();
+    if (showStepTimes_)
+    {
+        recordSceneOrder();
+        setSorting(1, false);
+        header()->show();
+    }
 }
 
 void QSofaListView::CloseAllDialogs()
@@ -169,214 +194,175 @@ void QSofaListView::modifyUnlock(void* Id)
     map_modifyObjectWindow.erase( Id );
 }
 
-bool QSofaListView::nameMatchesFilter(Q3ListViewItem* item, QString filter, bool bIsNode, bool exactMatch = false)
+const SceneGraphFilter::Keys& QSofaListView::getFilterKeys(Q3ListViewItem* item)
 {
-    if (!searchName_) return false;
+    SceneGraphFilter::Keys& keys = filterKeys_[item];
+    keys.set(item->text(0));
+    return keys;
+}
 
-    bool match = false;
+bool QSofaListView::shouldDisplayNode(Q3ListViewItem* item, bool parentMatched, bool bIsNode)
+{
+    // the components are looked up in the matches of the words, only the other items,
+    // such as the datas, are compared to their text
+    Base* base = graphListener_->findObject(item);
+    return filter_.matches(base, base ? NULL : &getFilterKeys(item), bIsNode, parentMatched);
+}
 
-    emit Lock(true);
+bool QSofaListView::isItemANode(Q3ListViewItem* item)
+{
+	Base* base;
+	Node* node;
+
+	base = graphListener_->findObject(item);
+	node = Node::DynamicCast(base);
+
+	return node != NULL;
+}
 
-    if (bIsNode)
+typedef std::vector< std::pair<Q3ListViewItem*, bool> > MatchingNodesList;
+
+// Decides the Visible value of the item based on options and filter, and which of its children must be visited
+void QSofaListView::pushFilterFrame(Q3ListViewItem* item, bool parentMatched)
+{
+    FilterFrame frame;
+    frame.item = item;
+    frame.nextChild = NULL;
+    frame.childrenParentMatched = false;
+    frame.visibleIfChildVisible = false;
+    frame.hasVisibleChild = false;
+    frame.visible = false;
+
+    if (shouldDisplayNode(item, parentMatched, isItemANode(item)))
     {
-        if (exactMatch)
+        if (filter_.showsContent(graphListener_->findObject(item)))
         {
-            match = (item->text(0).compare(filter, Qt::CaseInsensitive)) == 0;
-        }
-        else
-        {
-            match = item->text(0).contains(filter, Qt::CaseInsensitive);
+            frame.visible = true;
+            frame.nextChild = item->firstChild();
+            frame.childrenParentMatched = true;
         }
     }
     else
     {
-        QStringList list = item->text(0).split(' ');
-
-        if (list.size() >= 2)
-        {
-            list.pop_front();
-            if (exactMatch)
-            {
-                match = (list.back().compare(filter, Qt::CaseInsensitive)) == 0;
-            }
-            else
-            {
-                match = list.join(" ").contains(filter, Qt::CaseInsensitive);
-            }
-        }
-
+        frame.nextChild = item->firstChild();
+        frame.visibleIfChildVisible = true;
     }
-
-    emit Lock(false);
-
-    return match;
+    filterStack_.push_back(frame);
 }
 
-bool QSofaListView::typeMatchesFilter(Q3ListViewItem* item, QString filter, bool bIsNode, bool exactMatch = false)
+void QSofaListView::restartFilter()
 {
-    if (bIsNode || !searchType_) return false;
-
-    bool match = false;
-
-    emit Lock(true);
-
-    QStringList list = item->text(0).split(' ');
-
-    emit Lock(false);
+    filterStack_.clear();
+    filterResults_.clear();
+    filterRevision_ = graphListener_ ? graphListener_->revision : 0;
+    if (!graphListener_ || !firstChild()) return;
+
+    // the components added since the last walk are in the index
+    filter_.findMatches(graphListener_->searchIndex);
+
+    // the top level items are visited as the children of a frame without item
+    FilterFrame top;
+    top.item = NULL;
+    top.nextChild = firstChild();
+    top.childrenParentMatched = false;
+    top.visibleIfChildVisible = false;
+    top.hasVisibleChild = false;
+    top.visible = false;
+    filterStack_.push_back(top);
+}
 
-    if (!list.isEmpty())
+void QSofaListView::stopFilter()
+{
+    filterTimer_->stop();
+    filterStack_.clear();
+    filterResults_.clear();
+    if (filterLocked_)
     {
-        if (exactMatch)
-        {
-            match = (list.front().compare(filter, Qt::CaseInsensitive)) == 0;
-        }
-        else
-        {
-            match = list.front().contains(filter, Qt::CaseInsensitive);
-        }
+        filterLocked_ = false;
+        emit Lock(false);
     }
-
-    return match;
 }
 
-bool QSofaListView::shouldDisplayNode(Q3ListViewItem* item, bool parentMatched, bool bIsNode)
+void QSofaListView::processFilterSlice()
 {
-	emit Lock(true);
-
-	bool noOption = !searchName_ && !searchType_ ; // No option activated : ignore filter and display node anyway
-
-    bool display = noOption || filter_.isEmpty() ||
-        (parentMatched && displayChildrenWhenParentMatches_);
-    
-    if (!display)
+    if (!graphListener_)
     {
-        QStringList filterList = filter_.split(' ');
+        stopFilter();
+        return;
+    }
+    // the items changed since the last slice, the walk may refer to deleted ones
+    if (graphListener_->revision != filterRevision_)
+        restartFilter();
+
+    QTime sliceTime;
+    sliceTime.start();
+    unsigned int nbProcessed = 0;
+    while (!filterStack_.empty())
+    {
+        if ((++nbProcessed % 64) == 0 && sliceTime.elapsed() >= FilterTimeSlice)
+            return; // the timer calls this slot again once the events are processed
 
-        display = true;
-        for (int fl = 0; fl < filterList.size(); ++fl)
+        FilterFrame& frame = filterStack_.back();
+        if (frame.nextChild)
         {
-            QString str = filterList.at(fl);
+            Q3ListViewItem* child = frame.nextChild;
+            const bool parentMatched = frame.childrenParentMatched;
+            frame.nextChild = child->nextSibling();
+            pushFilterFrame(child, parentMatched);
+            continue;
+        }
 
-            bool exactMatch = false;
-            if (str.contains("\"")) //search for exact match
-            {
-                str = str.remove(QChar('"'));
-                exactMatch = true;
-            }
+        // all the children of the item are done
+        const FilterFrame done = frame;
+        filterStack_.pop_back();
+        if (!done.item) continue;
+        const bool visible = done.visible || (done.visibleIfChildVisible && done.hasVisibleChild);
+        filterResults_.push_back(std::make_pair(done.item, visible));
+        if (visible && !filterStack_.empty())
+            filterStack_.back().hasVisibleChild = true;
+    }
 
-            if (str.contains("/"))
-            {
-                if (bIsNode)
-                {
-                    str = str.remove(QChar('/'));
-                    display &= nameMatchesFilter(item, str, bIsNode, exactMatch) || typeMatchesFilter(item, str, bIsNode, exactMatch);
-                }
-                else
-                    display = false;
-            }
-            else if (str.contains("!"))
-            {
-                Base* base = graphListener_->findObject(item);
-                Node* node = Node::DynamicCast(base);
-                BaseObject * bo = dynamic_cast<BaseObject *>(base);
-                bool warn = node;
-                warn |= (bo && bo->getWarnings().empty());
+    showMatchingNodes(filterResults_);
 
-                display = !warn;
-            }
-            else
-            {
-                display &= nameMatchesFilter(item, str, bIsNode, exactMatch) || typeMatchesFilter(item, str, bIsNode, exactMatch);
-            }
+    // forget the keys of the deleted items
+    if (filterKeys_.size() > 2*filterResults_.size())
+    {
+        std::unordered_map<const Q3ListViewItem*, SceneGraphFilter::Keys> keys;
+        for (MatchingNodesList::const_iterator it = filterResults_.begin(); it != filterResults_.end(); ++it)
+        {
+            std::unordered_map<const Q3ListViewItem*, SceneGraphFilter::Keys>::iterator k = filterKeys_.find(it->first);
+            if (k != filterKeys_.end()) keys.insert(*k);
         }
+        filterKeys_.swap(keys);
     }
-
-	emit Lock(false);
-
-	return display;
-}
-
-bool QSofaListView::isItemANode(Q3ListViewItem* item)
-{
-	Base* base;
-	Node* node;
-
-	base = graphListener_->findObject(item);
-	node = Node::DynamicCast(base);
-
-	return node != NULL;
-}
-
-typedef std::vector< std::pair<Q3ListViewItem*, bool> > MatchingNodesList;
-
-// Updates the Visible value of the nodes based on options and filter
-bool QSofaListView::fillFilteredList(MatchingNodesList& nodesList, Q3ListViewItem* item, bool parentMatched)
-{
-	bool hasVisibleItem = false;
-
-    emit Lock(true);
-	while (item)
-	{
-		std::pair<Q3ListViewItem*, bool> itemDisplayValue;
-		itemDisplayValue.first = item;
-
-		if (shouldDisplayNode(item, parentMatched, isItemANode(item)))
-		{
-            Base* base = graphListener_->findObject(item);
-            Node* node = Node::DynamicCast(base);
-            if (!node || (node->isActive() || !activatedFilter_))
-            {
-                itemDisplayValue.second = true; // setVisible value
-                fillFilteredList(nodesList, item->firstChild(), true);
-                hasVisibleItem = true;
-            }
-		}
-		else
-		{
-			bool hasVisibleChild = fillFilteredList(nodesList, item->firstChild(), false);
-			if (hasVisibleChild)
-			{
-				itemDisplayValue.second = true; // setVisible value
-				hasVisibleItem = true;
-			}
-			else
-			{
-				itemDisplayValue.second = false; // setVisible value
-			}
-		}
-		nodesList.push_back(itemDisplayValue);
-
-		item = item->nextSibling();
-	}
-    emit Lock(false);
-
-	return hasVisibleItem;
+    stopFilter();
 }
 
 void QSofaListView::showMatchingNodes(const MatchingNodesList& nodesList)
 {
-	emit Lock(true);
-
 	for (MatchingNodesList::const_reverse_iterator it = nodesList.rbegin(); it != nodesList.rend(); ++it)
 	{
-		if (it->first)
+		if (it->first && it->first->isVisible() != it->second)
 		{
 			it->first->setVisible(it->second);
 		}
 	}
-
-	emit Lock(false);
 }
 
 void QSofaListView::applyFilter()
 {
-	//Must setVisible on parent before children to prevent bugs -> need to store in a temporary list and setVisible after algorithm is finished.
-	MatchingNodesList nodesList;
-
-    Q3ListViewItem* root = firstChild();
-	fillFilteredList(nodesList, root, false);
+    // the animation is locked once for the whole filtering, which restarts from the first item
+    if (!filterLocked_)
+    {
+        filterLocked_ = true;
+        emit Lock(true);
+    }
+    restartFilter();
 
-	showMatchingNodes(nodesList);
+	//Must setVisible on parent before children to prevent bugs -> the results are applied once all the items are done.
+    processFilterSlice();
+    if (isFiltering())
+        filterTimer_->start(0);
 }
 
 void QSofaListView::collapseNode()
@@ -487,6 +473,197 @@ void QSofaListView::Unfreeze()
     graphListener_->unfreeze(groot);
 }
 
+void QSofaListView::beginMutationBatch()
+{
+    if (graphListener_) graphListener_->beginBatch();
+}
+
+void QSofaListView::endMutationBatch()
+{
+    if (!graphListener_) return;
+    graphListener_->endBatch();
+    if (!graphListener_->frozen && graphListener_->hasPendingMutations() && !mutationTimer_->isActive())
+        mutationTimer_->start(MutationBatchPeriod);
+}
+
+void QSofaListView::applyMutationBatch()
+{
+    mutationTimer_->stop();
+    if (!graphListener_ || !graphListener_->hasPendingMutations()) return;
+    // the items are created without repainting the view for each of them
+    const bool updatesEnabled = isUpdatesEnabled();
+    setUpdatesEnabled(false);
+    graphListener_->applyBatch();
+    setUpdatesEnabled(updatesEnabled);
+    triggerUpdate();
+}
+
+namespace
+{
+
+struct SceneOrderLess
+{
+    const std::unordered_map<const Q3ListViewItem*, unsigned int>& order;
+    SceneOrderLess(const std::unordered_map<const Q3ListViewItem*, unsigned int>& o) : order(o) {}
+    unsigned int get(const Q3ListViewItem* item) const
+    {
+        std::unordered_map<const Q3ListViewItem*, unsigned int>::const_iterator it = order.find(item);
+        return it != order.end() ? it->second : (unsigned int)-1;
+    }
+    bool operator()(const Q3ListViewItem* a, const Q3ListViewItem* b) const { return get(a) < get(b); }
+};
+
+}
+
+void QSofaListView::showStepTimes(bool show)
+{
+    if (show == showStepTimes_) return;
+    showStepTimes_ = show;
+    if (show)
+    {
+        recordSceneOrder();
+        addColumn(QString("ms/step"));
+        setColumnAlignment(1, Qt::AlignRight);
+        header()->show();
+        setSorting(1, false);
+    }
+    else
+    {
+        setSorting(-1);
+        removeColumn(1);
+        header()->hide();
+        restoreSceneOrder();
+        stepTimeItems_.clear();
+    }
+}
+
+void QSofaListView::setStepTimes(const std::map<std::string, double>& times, unsigned int nbSteps)
+{
+    if (!showStepTimes_ || graphListener_ == NULL || nbSteps == 0) return;
+
+    if (stepTimeItems_.empty() || stepTimeRevision_ != graphListener_->revision)
+    {
+        stepTimeItems_.clear();
+        std::unordered_map<const Q3ListViewItem*, Base*>::const_iterator it;
+        for (it = graphListener_->itemObjects.begin(); it != graphListener_->itemObjects.end(); ++it)
+        {
+            BaseObject* object = BaseObject::DynamicCast(it->second);
+            if (object == NULL) continue;
+            std::ostringstream ptr;
+            ptr << object;
+            stepTimeItems_[ptr.str()] = const_cast<Q3ListViewItem*>(it->first);
+        }
+        stepTimeRevision_ = graphListener_->revision;
+    }
+
+    std::unordered_map<const Q3ListViewItem*, double> componentTimes;
+    for (std::map<std::string, double>::const_iterator it = times.begin(); it != times.end(); ++it)
+    {
+        std::unordered_map<std::string, Q3ListViewItem*>::const_iterator item = stepTimeItems_.find(it->first);
+        if (item != stepTimeItems_.end())
+            componentTimes[item->second] += it->second / nbSteps;
+    }
+
+    stepTimeResults_.clear();
+    double totalTime = 0;
+    for (Q3ListViewItem* item = firstChild(); item != NULL; item = item->nextSibling())
+        totalTime += accumulateStepTimes(item, componentTimes);
+
+    const bool updatesEnabled = isUpdatesEnabled();
+    setUpdatesEnabled(false);
+    for (unsigned int i = 0; i < stepTimeResults_.size(); ++i)
+    {
+        GraphListViewItem* item = static_cast<GraphListViewItem*>(stepTimeResults_[i].first);
+        const double time = stepTimeResults_[i].second;
+        item->stepTime = time;
+        item->stepRatio = totalTime > 0 ? std::sqrt(time / totalTime) : 0;
+        const QString text = time > 0 ? QString::number(time, 'f', 3) : QString();
+        if (item->text(1) != text)
+            item->setText(1, text);
+    }
+    stepTimeResults_.clear();
+    setUpdatesEnabled(updatesEnabled);
+    if (sortColumn() == 1)
+        sort();
+    triggerUpdate();
+}
+
+/// Time of the component and of the items below it. The datas and the additional parents
+/// of the nodes are not timed.
+double QSofaListView::accumulateStepTimes(Q3ListViewItem* item, const std::unordered_map<const Q3ListViewItem*, double>& componentTimes)
+{
+    if (graphListener_->itemDatas.count(item) || graphListener_->multiNodeItems.count(item))
+        return 0;
+    std::unordered_map<const Q3ListViewItem*, double>::const_iterator it = componentTimes.find(item);
+    double time = (it != componentTimes.end()) ? it->second : 0;
+    for (Q3ListViewItem* child = item->firstChild(); child != NULL; child = child->nextSibling())
+        time += accumulateStepTimes(child, componentTimes);
+    stepTimeResults_.push_back(std::make_pair(item, time));
+    return time;
+}
+
+void QSofaListView::recordSceneOrder()
+{
+    sceneOrder_.clear();
+    unsigned int order = 0;
+    std::vector<Q3ListViewItem*> stack;
+    for (Q3ListViewItem* item = firstChild(); item != NULL; item = item->nextSibling())
+    {
+        sceneOrder_[item] = order++;
+        stack.push_back(item);
+    }
+    while (!stack.empty())
+    {
+        Q3ListViewItem* item = stack.back();
+        stack.pop_back();
+        for (Q3ListViewItem* child = item->firstChild(); child != NULL; child = child->nextSibling())
+        {
+            sceneOrder_[child] = order++;
+            stack.push_back(child);
+        }
+    }
+}
+
+void QSofaListView::restoreSceneOrder()
+{
+    // the items added after recordSceneOrder are kept at the end
+    SceneOrderLess lessInScene(sceneOrder_);
+    std::vector<Q3ListViewItem*> parents(1, (Q3ListViewItem*)NULL);
+    std::vector<Q3ListViewItem*> children;
+    while (!parents.empty())
+    {
+        Q3ListViewItem* parent = parents.back();
+        parents.pop_back();
+        children.clear();
+        for (Q3ListViewItem* child = parent ? parent->firstChild() : firstChild(); child != NULL; child = child->nextSibling())
+        {
+            children.push_back(child);
+            if (child->firstChild()) parents.push_back(child);
+        }
+        std::stable_sort(children.begin(), children.end(), lessInScene);
+        for (unsigned int i = 1; i < children.size(); ++i)
+            children[i]->moveItem(children[i-1]);
+    }
+    sceneOrder_.clear();
+}
+
+void QSofaListView::updateSearchIndex()
+{
+    // the name of an object may have been changed in its dialog
+    if (graphListener_)
+        graphListener_->searchIndex.updateNames();
+}
+
+void QSofaListView::selectComponent(Base* component)
+{
+    Q3ListViewItem* item = (component && graphListener_) ? graphListener_->findItem(component) : NULL;
+    clearSelection();
+    if (item == NULL) return;
+    ensureItemVisible(item);
+    setCurrentItem(item);
+    setSelected(item, true);
+}
+
 void QSofaListView::focusObject()
 {
     if( object_.isObject())
@@ -563,9 +740,14 @@ void QSofaListView::RunSofaRightClicked( Q3ListViewItem *item,
         }
     }
     contextMenu->insertItem ( "Modify", this, SLOT ( Modify() ) );
+    if ( object_.type == typeNode )
+    {
+        contextMenu->insertItem("Show Datas below", this, SLOT ( ShowDatas() ) );
+        contextMenu->insertItem("Hide Datas below", this, SLOT ( HideDatas() ) );
+    }
     if(object_hasData)
     {
-        if(item->childCount() > 0)
+        if(graphListener_->isShowingDatas(object_.ptr.Object))
         {
             contextMenu->insertItem("Hide Datas",this, SLOT ( HideDatas() ) );
         }
@@ -593,6 +775,7 @@ void QSofaListView::RunSofaDoubleClicked(Q3ListViewItem* item)
 void QSofaListView::nodeNameModification(simulation::Node* node)
 {
     Q3ListViewItem *item=graphListener_->items[node];
+    graphListener_->searchIndex.update(node);
 
     QString nameToUse(node->getName().c_str());
     item->setText(0,nameToUse);
@@ -691,67 +874,31 @@ void QSofaListView::RemoveNode()
 }
 void QSofaListView::Modify()
 {
-    void *current_Id_modifyDialog = NULL;
     emit Lock(true);
 
     if ( currentItem() != NULL )
     {
-        ModifyObjectFlags dialogFlags = ModifyObjectFlags();
-        dialogFlags.setFlagsForSofa();
-        ModifyObject* dialogModifyObject = NULL;
-
-        QString title = currentItem()->text(0);
-
+        Base* base = NULL;
+        BaseData* data = NULL;
         if (object_.type == typeData)       //user clicked on a data
-        {
-            current_Id_modifyDialog = object_.ptr.Data;
-        }
+            data = object_.ptr.Data;
         if (object_.type == typeNode)
-        {
-            current_Id_modifyDialog = object_.ptr.Node;
-        }
+            base = object_.ptr.Node;
         if(object_.type == typeObject)
-        {
-            current_Id_modifyDialog = object_.ptr.Object;
-
-            sofa::core::objectmodel::BaseObject* baseObj = sofa::core::objectmodel::BaseObject::DynamicCast(object_.ptr.Object);
-            if (baseObj)
-            {
-                sofa::core::objectmodel::BaseNode * bn = sofa::core::objectmodel::BaseNode::DynamicCast(baseObj->getContext());
-                if (bn && !bn->getPathName().empty())
-                    title = title + QString(" (") + QString(bn->getPathName().c_str()) + QString(")");
-            }
-        }
-        assert(current_Id_modifyDialog != NULL);
+            base = object_.ptr.Object;
 
         //Opening of a dialog window automatically created
-
-        std::map< void*, QDialog* >::iterator testWindow =  map_modifyObjectWindow.find( current_Id_modifyDialog);
-        if ( testWindow != map_modifyObjectWindow.end())
+        ModifyObject* dialogModifyObject = ModifyObject::openFromGraphView(this, base, data, currentItem()->text(0),
+                currentItem(), graphListener_->items, map_modifyObjectWindow);
+        if (dialogModifyObject)
         {
-            //Object already being modified: no need to open a new window
-            (*testWindow).second->raise();
-            emit Lock(false);
-            return;
+            void* current_Id_modifyDialog = data ? (void*)data : (void*)base;
+            map_modifyDialogOpened.insert( std::make_pair ( current_Id_modifyDialog, currentItem()) );
+            connect ( dialogModifyObject, SIGNAL( objectUpdated() ), this, SLOT( updateSearchIndex() ));
+            connect ( dialogModifyObject, SIGNAL( nodeNameModification(simulation::Node*) ) , this, SLOT( nodeNameModification(simulation::Node*) ));
+            dialogModifyObject->show();
+            dialogModifyObject->raise();
         }
-
-        dialogModifyObject = new ModifyObject(current_Id_modifyDialog,currentItem(),this, dialogFlags, graphListener_->items, title);
-        if(object_.type == typeData)
-            dialogModifyObject->createDialog(object_.ptr.Data);
-        if(object_.type == typeNode)
-            dialogModifyObject->createDialog((Base*)object_.ptr.Node);
-        if(object_.type  == typeObject)
-            dialogModifyObject->createDialog((Base*)object_.ptr.Object);
-
-        map_modifyDialogOpened.insert( std::make_pair ( current_Id_modifyDialog, currentItem()) );
-        map_modifyObjectWindow.insert( std::make_pair(current_Id_modifyDialog, dialogModifyObject));
-        connect ( dialogModifyObject, SIGNAL( objectUpdated() ), this, SIGNAL( Updated() ));
-        connect ( this, SIGNAL( Close() ), dialogModifyObject, SLOT( closeNow() ) );
-        connect ( dialogModifyObject, SIGNAL( dialogClosed(void *) ) , this, SLOT( modifyUnlock(void *)));
-        connect ( dialogModifyObject, SIGNAL( nodeNameModification(simulation::Node*) ) , this, SLOT( nodeNameModification(simulation::Node*) ));
-        connect ( dialogModifyObject, SIGNAL( dataModified(QString) ), this, SIGNAL( dataModified(QString) ) );
-        dialogModifyObject->show();
-        dialogModifyObject->raise();
     }
     emit Lock(false);
 }
@@ -768,90 +915,101 @@ void QSofaListView::UpdateOpenedDialogs()
 
 void QSofaListView::setFilter(const QString &newFilter)
 {
-	emit Lock(true);
-
-	filter_ = newFilter;
+	filter_.setFilter(newFilter);
 	applyFilter();
-
-	emit Lock(false);
 }
 
 void QSofaListView::setSearchName(bool value)
 {
-	emit Lock(true);
+	bool oldValue = filter_.getSearchName();
 
-	bool oldValue = searchName_;
+	filter_.setSearchName(value);
 
-	searchName_ = value;
-
-	if (oldValue != searchName_)
+	if (oldValue != value)
 		applyFilter();
-
-	emit Lock(false);
 }
 
 void QSofaListView::setSearchType(bool value)
 {
-	emit Lock(true);
-	bool oldValue = searchType_;
+	bool oldValue = filter_.getSearchType();
 
-	searchType_ = value;
+	filter_.setSearchType(value);
 
-	if (oldValue != searchType_)
+	if (oldValue != value)
 		applyFilter();
-
-	emit Lock(false);
 }
 
 void QSofaListView::setActivatedFilter(bool value)
 {
-    emit Lock(true);
-    bool oldValue = activatedFilter_;
+    bool oldValue = filter_.getActivatedFilter();
 
-    activatedFilter_ = value;
+    filter_.setActivatedFilter(value);
 
-    if (oldValue != activatedFilter_)
+    if (oldValue != value)
         applyFilter();
-
-    emit Lock(false);
 }
 
 void QSofaListView::setDisplayChildrenWhenParentMatches(bool value)
 {
-	emit Lock(true);
-	bool oldValue = displayChildrenWhenParentMatches_;
+	bool oldValue = filter_.getDisplayChildrenWhenParentMatches();
 
-	displayChildrenWhenParentMatches_ = value;
+	filter_.setDisplayChildrenWhenParentMatches(value);
 
-	if (oldValue != displayChildrenWhenParentMatches_)
+	if (oldValue != value)
 		applyFilter();
-
-	emit Lock(false);
 }
 
 void QSofaListView::HideDatas()
 {
     if( object_.type == typeObject )
     {
-        emit Lock(true);
-        Unfreeze();
-        graphListener_->removeDatas(object_.ptr.Object);
-        Freeze();
-        emit Lock(false);
+        graphListener_->setShowDatas(object_.ptr.Object, false);
+    }
+    else if (object_.type == typeNode)
+    {
+        setShowDatasBelow(graphListener_->findItem(object_.ptr.Node), false);
     }
 }
 
 void QSofaListView::ShowDatas()
 {
+    // the items of the datas are created once the object is opened
     if ( object_.type == typeObject )
     {
-        emit Lock(true);
-        Unfreeze();
-        graphListener_->addDatas(object_.ptr.Object);
-        Freeze();
-        emit Lock(false);
+        graphListener_->setShowDatas(object_.ptr.Object, true);
+        Q3ListViewItem* item = graphListener_->findItem(object_.ptr.Object);
+        if (item) setOpen(item, true);
+    }
+    else if (object_.type == typeNode)
+    {
+        setShowDatasBelow(graphListener_->findItem(object_.ptr.Node), true);
     }
 }
+
+void QSofaListView::setShowDatasBelow(Q3ListViewItem* item, bool show)
+{
+    if (item == NULL) return;
+    std::vector<Q3ListViewItem*> stack(1, item);
+    while (!stack.empty())
+    {
+        Q3ListViewItem* current = stack.back();
+        stack.pop_back();
+        BaseObject* object = BaseObject::DynamicCast(graphListener_->findObject(current));
+        if (object)
+            graphListener_->setShowDatas(object, show);
+        for (Q3ListViewItem* child = current->firstChild(); child != NULL; child = child->nextSibling())
+        {
+            if (!graphListener_->itemDatas.count(child) && !graphListener_->multiNodeItems.count(child))
+                stack.push_back(child);
+        }
+    }
+}
+
+void QSofaListView::itemExpanded(Q3ListViewItem* item)
+{
+    if (graphListener_)
+        graphListener_->openItem(item);
+}
 /*****************************************************************************************************************/
 // Test if a node can be erased in the graph : the condition is that none of its children has a menu modify opened
 bool QSofaListView::isNodeErasable ( BaseNode* node)
@@ -887,13 +1045,7 @@ void QSofaListView::Export()
     Node* root = Node::DynamicCast(graphListener_->findObject(firstChild()));
     assert(root);
     GenGraphForm* form = new sofa::gui::qt::GenGraphForm;
-    form->setScene ( root );
-    std::string gname(((RealGUI*) (qApp->mainWidget()))->windowFilePath().ascii());
-    std::size_t gpath = gname.find_last_of("/\\");
-    std::size_t gext = gname.rfind('.');
-    if (gext != std::string::npos && (gpath == std::string::npos || gext > gpath))
-        gname = gname.substr(0,gext);
-    form->filename->setText(gname.c_str());
+    form->setScene ( root, ((RealGUI*) (qApp->mainWidget()))->windowFilePath().ascii() );
     form->show();
 }
 
@@ -909,7 +1061,7 @@ void QSofaListView::loadObject ( std::string path, double dx, double dy, double
     //the object will be added to the root node
     if ( currentItem() == NULL )
     {
-        for ( std::map<core::objectmodel::Base*, Q3ListViewItem* >::iterator it = graphListener_->items.begin() ;
+        for ( std::unordered_map<core::objectmodel::Base*, Q3ListViewItem* >::iterator it = graphListener_->items.begin() ;
                 it != graphListener_->items.end() ; ++ it )
         {
             if ( ( *it ).second->itemPos() == 0 ) //Root node position
@@ -31,14 +31,17 @@
 #include <Q3ListViewItem>
 #include <Q3Header>
 #include <QPushButton>
+#include <QTimer>
 #else
 #include <qwidget.h>
 #include <qlistview.h>
 #include <qheader.h>
 #include <qpushbutton.h>
+#include <qtimer.h>
 #endif
 
 #include "SofaGUIQt.h"
+#include "SceneGraphFilter.h"
 #include <sofa/simulation/common/Node.h>
 #include <sofa/core/objectmodel/BaseData.h>
 #include <sofa/core/objectmodel/BaseObject.h>
@@ -49,6 +52,10 @@ typedef QListViewItem Q3ListViewItem;
 
 #endif
 #include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace sofa
 {
@@ -102,7 +109,23 @@ public:
     void Freeze();
     void Unfreeze();
     SofaListViewAttribute getAttribute() const { return attribute_; };
+    /// Start filtering the items, cancelling the filtering in progress.
+    /// The items are processed by time slices, the visibility is updated once all of them are done.
 	void applyFilter();
+    bool isFiltering() const { return !filterStack_.empty(); }
+    /// The additions to the graph between these calls, during a simulation step, are
+    /// applied together by a timer, at most every MutationBatchPeriod ms
+    void beginMutationBatch();
+    void endMutationBatch();
+    /// Display in a second column the time per step of each component and of the subtree of
+    /// each node, colored as a heatmap and sorted to show the most expensive ones first
+    void showStepTimes(bool);
+    bool isShowingStepTimes() const { return showStepTimes_; }
+    /// Times in ms spent in the components during nbSteps steps, indexed by their
+    /// address as printed in the visitor dump
+    void setStepTimes(const std::map<std::string, double>& times, unsigned int nbSteps);
+    /// Select the item of the component and scroll to it
+    void selectComponent(core::objectmodel::Base* component);
 public Q_SLOTS:
     void Export();
     void CloseAllDialogs();
@@ -141,8 +164,10 @@ protected Q_SLOTS:
     void modifyUnlock(void* Id);
     void RaiseAddObject();
     void RemoveNode();
+    /// On an object, or on all the objects below a node
     void HideDatas();
     void ShowDatas();
+    void itemExpanded(Q3ListViewItem* item);
     void DeactivateNode();
     void ActivateNode();
     void setFilterOnNode();
@@ -155,14 +180,35 @@ protected Q_SLOTS:
     void nodeNameModification( simulation::Node*);
     void focusObject();
     void focusNode();
+    /// Filter items until the time slice is elapsed
+    void processFilterSlice();
+    void applyMutationBatch();
+    void updateSearchIndex();
 protected:
-	bool nameMatchesFilter(Q3ListViewItem*, QString, bool, bool);
-	bool typeMatchesFilter(Q3ListViewItem*, QString, bool, bool);
+    /// Item being filtered, with the next of its children to visit
+    struct FilterFrame
+    {
+        Q3ListViewItem* item;
+        Q3ListViewItem* nextChild;
+        bool childrenParentMatched;
+        bool visibleIfChildVisible;
+        bool hasVisibleChild;
+        bool visible;
+    };
+
 	bool isItemANode(Q3ListViewItem*);
 	bool shouldDisplayNode(Q3ListViewItem*, bool, bool);
-	bool fillFilteredList(std::vector< std::pair<Q3ListViewItem*, bool> >&, Q3ListViewItem*, bool);
+	const SceneGraphFilter::Keys& getFilterKeys(Q3ListViewItem*);
+	void pushFilterFrame(Q3ListViewItem*, bool);
+	void restartFilter();
+	void stopFilter();
 	void showMatchingNodes(const std::vector< std::pair<Q3ListViewItem*, bool> >& nodesList);
+    double accumulateStepTimes(Q3ListViewItem* item, const std::unordered_map<const Q3ListViewItem*, double>& componentTimes);
+    /// The order of the items is lost while they are sorted by time
+    void recordSceneOrder();
+    void restoreSceneOrder();
 
+    void setShowDatasBelow(Q3ListViewItem* item, bool show);
     void collapseNode(Q3ListViewItem* item);
     void expandNode(Q3ListViewItem* item);
     void transformObject ( sofa::simulation::Node *node, double dx, double dy, double dz,  double rx, double ry, double rz, double scale );
@@ -178,12 +224,25 @@ protected:
     sofa::core::objectmodel::Base::SPtr selectedComponent_;
     SofaListViewAttribute attribute_;
 
-	QString	filter_;
-	bool searchName_;
-	bool searchType_;
-    bool activatedFilter_;
-	bool displayChildrenWhenParentMatches_;
-
+    SceneGraphFilter filter_;
+
+    enum { FilterTimeSlice = 10 }; // ms
+    QTimer* filterTimer_;
+    std::vector<FilterFrame> filterStack_;
+    std::vector< std::pair<Q3ListViewItem*, bool> > filterResults_;
+    std::unordered_map<const Q3ListViewItem*, SceneGraphFilter::Keys> filterKeys_;
+    unsigned int filterRevision_;
+    bool filterLocked_;
+
+    enum { MutationBatchPeriod = 40 }; // ms
+    QTimer* mutationTimer_;
+
+    bool showStepTimes_;
+    /// items of the components, indexed by their address as printed in the visitor dump
+    std::unordered_map<std::string, Q3ListViewItem*> stepTimeItems_;
+    unsigned int stepTimeRevision_;
+    std::vector< std::pair<Q3ListViewItem*, double> > stepTimeResults_;
+    std::unordered_map<const Q3ListViewItem*, unsigned int> sceneOrder_;
 };
 
 } //sofa
@@ -25,8 +25,23 @@
 #include "QSofaStatWidget.h"
 #include "GraphListenerQListView.h"
 #include <sofa/core/CollisionModel.h>
+#include <sofa/core/BaseMapping.h>
 #include <sofa/core/objectmodel/BaseContext.h>
+#include <sofa/core/objectmodel/BaseData.h>
 #include <sofa/core/objectmodel/Base.h>
+#include <sofa/core/behavior/BaseMechanicalState.h>
+#include <sofa/core/behavior/BaseMass.h>
+#include <sofa/core/behavior/BaseForceField.h>
+#include <sofa/core/behavior/BaseConstraintSet.h>
+#include <sofa/core/behavior/BaseProjectiveConstraintSet.h>
+#include <sofa/core/behavior/BaseAnimationLoop.h>
+#include <sofa/core/behavior/OdeSolver.h>
+#include <sofa/core/behavior/LinearSolver.h>
+#include <sofa/core/topology/Topology.h>
+#include <sofa/core/topology/BaseMeshTopology.h>
+#include <sofa/core/topology/BaseTopologyObject.h>
+#include <sofa/core/visual/VisualModel.h>
+#include <sofa/defaulttype/DataTypeInfo.h>
 #include <sofa/simulation/common/Node.h>
 
 
@@ -42,6 +57,9 @@
 #include "qlayout.h"
 #endif
 
+#include <unordered_map>
+#include <stdio.h>
+
 using namespace sofa::simulation;
 using namespace sofa::core::objectmodel;
 namespace sofa
@@ -51,11 +69,143 @@ namespace gui
 namespace qt
 {
 
+namespace
+{
+
+enum
+{
+    ColumnName = 0,
+    ColumnType,
+    ColumnCategory,
+    ColumnElements,
+    ColumnDofs,
+    ColumnMemory,
+    ColumnGroup
+};
+
+const char* categoryNames[QSofaStatWidget::NbCategories] =
+{
+    "Mechanical states",
+    "Masses",
+    "Force fields",
+    "Constraints",
+    "Topologies",
+    "Collision models",
+    "Mappings",
+    "Solvers",
+    "Visual models",
+    "Others"
+};
+
+/// Item keeping the values of the numeric columns, to sort them as numbers
+class StatListViewItem : public Q3ListViewItem
+{
+public:
+    StatListViewItem(Q3ListView* parent) : Q3ListViewItem(parent) { values[0] = values[1] = values[2] = 0; }
+    StatListViewItem(Q3ListViewItem* parent) : Q3ListViewItem(parent) { values[0] = values[1] = values[2] = 0; }
+
+    void setValue(int column, double value) { values[column-ColumnElements] = value; }
+
+    virtual int compare(Q3ListViewItem* i, int col, bool ascending) const
+    {
+        if (col < ColumnElements || col > ColumnMemory)
+            return Q3ListViewItem::compare(i, col, ascending);
+        double v0 = values[col-ColumnElements];
+        double v1 = static_cast<StatListViewItem*>(i)->values[col-ColumnElements];
+        return (v0 < v1) ? -1 : (v0 > v1) ? 1 : 0;
+    }
+
+protected:
+    double values[3];
+};
+
+QSofaStatWidget::Category getCategory(BaseObject* obj)
+{
+    // the classification only depends on the class of the component
+    static std::unordered_map<const BaseClass*, QSofaStatWidget::Category> classes;
+    const BaseClass* c = obj->getClass();
+    std::unordered_map<const BaseClass*, QSofaStatWidget::Category>::const_iterator it = classes.find(c);
+    if (it != classes.end()) return it->second;
+
+    QSofaStatWidget::Category category = QSofaStatWidget::CategoryOther;
+    // the masses are force fields, and the mechanical mappings are mappings
+    if (core::behavior::BaseMechanicalState::DynamicCast(obj))
+        category = QSofaStatWidget::CategoryMechanicalState;
+    else if (core::behavior::BaseMass::DynamicCast(obj))
+        category = QSofaStatWidget::CategoryMass;
+    else if (core::behavior::BaseForceField::DynamicCast(obj))
+        category = QSofaStatWidget::CategoryForceField;
+    else if (core::behavior::BaseConstraintSet::DynamicCast(obj)
+             || core::behavior::BaseProjectiveConstraintSet::DynamicCast(obj))
+        category = QSofaStatWidget::CategoryConstraint;
+    else if (core::topology::Topology::DynamicCast(obj)
+             || core::topology::BaseTopologyObject::DynamicCast(obj))
+        category = QSofaStatWidget::CategoryTopology;
+    else if (core::CollisionModel::DynamicCast(obj))
+        category = QSofaStatWidget::CategoryCollisionModel;
+    else if (core::BaseMapping::DynamicCast(obj))
+        category = QSofaStatWidget::CategoryMapping;
+    else if (core::behavior::BaseAnimationLoop::DynamicCast(obj)
+             || core::behavior::OdeSolver::DynamicCast(obj)
+             || core::behavior::LinearSolver::DynamicCast(obj))
+        category = QSofaStatWidget::CategorySolver;
+    else if (core::visual::VisualModel::DynamicCast(obj))
+        category = QSofaStatWidget::CategoryVisualModel;
+    classes.insert(std::make_pair(c, category));
+    return category;
+}
+
+/// Elements of the highest dimension present in the topology
+unsigned int getNbTopologyElements(core::topology::BaseMeshTopology* topology)
+{
+    unsigned int n = topology->getNbTetrahedra() + topology->getNbHexahedra();
+    if (!n) n = topology->getNbTriangles() + topology->getNbQuads();
+    if (!n) n = topology->getNbEdges();
+    return n;
+}
+
+/// Approximate memory used by the values of the datas of the component.
+/// The datas waiting for an update are skipped, reading them would run the engines.
+std::size_t getDatasMemory(Base* base)
+{
+    std::size_t memory = 0;
+    const Base::VecData& fields = base->getDataFields();
+    for (unsigned int i=0; i<fields.size(); ++i)
+    {
+        BaseData* data = fields[i];
+        if (data->isDirty()) continue;
+        const sofa::defaulttype::AbstractTypeInfo* typeinfo = data->getValueTypeInfo();
+        if (!typeinfo->ValidInfo()) continue;
+        memory += typeinfo->size(data->getValueVoidPtr()) * typeinfo->byteSize();
+    }
+    return memory;
+}
+
+QString formatMemory(std::size_t bytes)
+{
+    if (bytes < 1024) return QString::number((unsigned int)bytes) + QString(" B");
+    if (bytes < 1024*1024) return QString::number(bytes/1024.0, 'f', 1) + QString(" KB");
+    return QString::number(bytes/(1024.0*1024.0), 'f', 1) + QString(" MB");
+}
+
+} // namespace
+
 QSofaStatWidget::QSofaStatWidget(QWidget* parent):QWidget(parent)
+    , root(NULL)
+    , nextComponent(NULL)
+    , summaryDirty(true)
 {
+    for (int c=0; c<NbCategories; ++c)
+    {
+        totals[c].components = 0;
+        totals[c].elements = 0;
+        totals[c].dofs = 0;
+        totals[c].memory = 0;
+    }
+
     QVBoxLayout* layout = new QVBoxLayout(this);
     statsLabel = new QLabel(this);
-    statsLabel->setText(QString("Collision Elements present :"));
+    statsLabel->setText(QString("Components present :"));
 //        statsLabel->setObjectName(QString("statsLabel"));
 
 #ifdef SOFA_QT4
@@ -63,107 +213,282 @@ QSofaStatWidget::QSofaStatWidget(QWidget* parent):QWidget(parent)
 #endif
     layout->addWidget(statsLabel);
     statsCounter = new Q3ListView(this);
-    statsCounter->addColumn(QString("Name"));
-    statsCounter->header()->setClickEnabled(true, statsCounter->header()->count() - 1);
-    statsCounter->header()->setResizeEnabled(true, statsCounter->header()->count() - 1);
-    statsCounter->addColumn(QString("Type"));
-    statsCounter->header()->setClickEnabled(true, statsCounter->header()->count() - 1);
-    statsCounter->header()->setResizeEnabled(true, statsCounter->header()->count() - 1);
-    statsCounter->addColumn(QString("Size"));
-    statsCounter->header()->setClickEnabled(true, statsCounter->header()->count() - 1);
-    statsCounter->header()->setResizeEnabled(true, statsCounter->header()->count() - 1);
-    statsCounter->addColumn(QString("Group"));
-    statsCounter->header()->setClickEnabled(true, statsCounter->header()->count() - 1);
-    statsCounter->header()->setResizeEnabled(true, statsCounter->header()->count() - 1);
+    const char* columns[] = { "Name", "Type", "Category", "Elements", "DOFs", "Memory", "Group" };
+    for (int c=ColumnName; c<=ColumnGroup; ++c)
+    {
+        statsCounter->addColumn(QString(columns[c]));
+        statsCounter->header()->setClickEnabled(true, statsCounter->header()->count() - 1);
+        statsCounter->header()->setResizeEnabled(true, statsCounter->header()->count() - 1);
+    }
+    for (int c=ColumnElements; c<=ColumnMemory; ++c)
+        statsCounter->setColumnAlignment(c, Qt::AlignRight);
     statsCounter->setResizeMode(Q3ListView::LastColumn);
-    statsCounter->header()->setLabel(0, QString("Name"));
-    statsCounter->header()->setLabel(1, QString("Type"));
-    statsCounter->header()->setLabel(2, QString("Size"));
-    statsCounter->header()->setLabel(3, QString("Group"));
+    for (int c=ColumnName; c<=ColumnGroup; ++c)
+        statsCounter->header()->setLabel(c, QString(columns[c]));
     layout->addWidget(statsCounter);
 
+    timerRefresh = new QTimer(this);
+    connect(timerRefresh, SIGNAL(timeout()), this, SLOT(refresh()));
+    timerRefresh->start(RefreshPeriod);
+}
+
+QSofaStatWidget::~QSofaStatWidget()
+{
+    detach();
+}
 
+void QSofaStatWidget::CreateStats(Node* node)
+{
+    if (node != root.get())
+    {
+        detach();
+        root = node;
+        // register the existing components and listen to the whole graph
+        if (root) addChild(NULL, root.get());
+    }
+    refresh();
+}
 
+void QSofaStatWidget::detach()
+{
+    if (!root) return;
+    // forget the components first, so that the removal events below find nothing to do
+    statsCounter->clear();
+    components.clear();
+    nodes.clear();
+    pendingComponents.clear();
+    collisionElements.clear();
+    nextComponent = NULL;
+    for (int c=0; c<NbCategories; ++c)
+    {
+        totals[c].components = 0;
+        totals[c].elements = 0;
+        totals[c].dofs = 0;
+        totals[c].memory = 0;
+    }
+    removeChild(NULL, root.get());
+    root->removeListener(this);
+    root.reset();
+    summaryDirty = true;
 }
 
-void QSofaStatWidget::CreateStats(Node* root)
+void QSofaStatWidget::removeChild(Node* parent, Node* child)
 {
-    sofa::helper::vector< sofa::core::CollisionModel* > list_collisionModels;
-    root->get< sofa::core::CollisionModel >( &list_collisionModels, BaseContext::SearchDown);
+    MutationListener::removeChild(parent, child);
+    // the items of the objects of the node are already removed
+    std::map<Node*, NodeStats>::iterator it = nodes.find(child);
+    if (it == nodes.end()) return;
+    delete it->second.item;
+    nodes.erase(it);
+}
 
-    if (items_stats.size() != 0)
+void QSofaStatWidget::addObject(Node* parent, core::objectmodel::BaseObject* object)
+{
+    if (!components.count(object))
     {
-        delete items_stats[0].second;
-        items_stats.clear();
+        ComponentStats stats;
+        stats.node = parent;
+        stats.category = getCategory(object);
+        stats.elements = 0;
+        stats.dofs = 0;
+        stats.memory = 0;
+        stats.item = NULL;
+        components.insert(std::make_pair(object, stats));
+        pendingComponents.push_back(object);
+        ++totals[stats.category].components;
+        summaryDirty = true;
     }
-    statsCounter->clear();
+    MutationListener::addObject(parent, object);
+}
+
+void QSofaStatWidget::removeObject(Node* parent, core::objectmodel::BaseObject* object)
+{
+    MutationListener::removeObject(parent, object);
+    ComponentMap::iterator it = components.find(object);
+    if (it == components.end()) return;
+    ComponentStats& stats = it->second;
+    CategoryStats& total = totals[stats.category];
+    --total.components;
+    total.elements -= stats.elements;
+    total.dofs -= stats.dofs;
+    total.memory -= stats.memory;
+    if (stats.category == CategoryCollisionModel)
+        collisionElements[object->getClassName()] -= stats.elements;
+    if (stats.item)
+    {
+        delete stats.item;
+        std::map<Node*, NodeStats>::iterator itNode = nodes.find(stats.node);
+        if (itNode != nodes.end() && --itNode->second.nbComponents == 0)
+        {
+            delete itNode->second.item;
+            nodes.erase(itNode);
+        }
+    }
+    if (nextComponent == object)
+    {
+        ComponentMap::iterator next = it;
+        ++next;
+        nextComponent = (next != components.end()) ? next->first : NULL;
+    }
+    components.erase(it);
+    summaryDirty = true;
+}
 
-    addCollisionModelsStat(list_collisionModels);
+void QSofaStatWidget::refresh()
+{
+    if (!root || !isVisible()) return;
 
-    addSummary();
+    // create the items of the components added since the last refresh
+    for (unsigned int i=0; i<pendingComponents.size(); ++i)
+    {
+        ComponentMap::iterator it = components.find(pendingComponents[i]);
+        if (it == components.end() || it->second.item) continue;
+        createItem(it->first, it->second);
+        updateComponent(it->first, it->second);
+    }
+    pendingComponents.clear();
 
+    // then refresh the sizes of a batch of components, resuming after the last one refreshed
+    ComponentMap::iterator it = nextComponent ? components.lower_bound(nextComponent) : components.begin();
+    for (unsigned int n=0; n<RefreshBatch && n<components.size(); ++n)
+    {
+        if (it == components.end()) it = components.begin();
+        updateComponent(it->first, it->second);
+        ++it;
+    }
+    nextComponent = (it != components.end()) ? it->first : NULL;
 
+    if (summaryDirty) addSummary();
 }
 
-void QSofaStatWidget::addCollisionModelsStat(const sofa::helper::vector< sofa::core::CollisionModel* >& v)
+void QSofaStatWidget::createItem(core::objectmodel::BaseObject* object, ComponentStats& stats)
 {
-    std::map< BaseContext*, Q3ListViewItem* > listStats;
-    for (unsigned int i=0; i<v.size(); i++)
+    std::map<Node*, NodeStats>::iterator it = nodes.find(stats.node);
+    if (it == nodes.end())
     {
-        if ( !v[i]->isActive()) continue;
-        std::map< BaseContext*, Q3ListViewItem* >::iterator it = listStats.find(v[i]->getContext());
-        Q3ListViewItem *item;
-        if (it != listStats.end())
-        {
-            item = new Q3ListViewItem((*it).second);
-        }
-        else
-        {
-            Q3ListViewItem *node = new Q3ListViewItem(statsCounter);
-            node->setText(0,QString(v[i]->getContext()->getName().c_str()));
-            QPixmap* pix = getPixmap(v[i]->getContext());
-            if (pix) node->setPixmap(0,*pix);
-            listStats.insert(std::make_pair(v[i]->getContext(), node));
-            item = new Q3ListViewItem(node);
-            node->setOpen(true);
-        }
-        assert(item);
-        item->setText(0,v[i]->getName().c_str());
-        item->setText(1,QString(v[i]->getClassName().c_str()));
-        item->setText(0,v[i]->getName().c_str());
-        item->setText(2,QString::number(v[i]->getSize()));
-        {
-        const helper::set<int>& groups = v[i]->getGroups();
+        NodeStats node;
+        node.item = new StatListViewItem(statsCounter);
+        node.item->setText(ColumnName, QString(stats.node->getName().c_str()));
+        QPixmap* pix = getPixmap(stats.node);
+        if (pix) node.item->setPixmap(ColumnName, *pix);
+        node.item->setOpen(true);
+        node.nbComponents = 0;
+        it = nodes.insert(std::make_pair(stats.node, node)).first;
+    }
+    ++it->second.nbComponents;
+
+    stats.item = new StatListViewItem(it->second.item);
+    stats.item->setText(ColumnName, QString(object->getName().c_str()));
+    stats.item->setText(ColumnType, QString(object->getClassName().c_str()));
+    stats.item->setText(ColumnCategory, QString(categoryNames[stats.category]));
+    QPixmap* pix = getPixmap(object);
+    if (pix) stats.item->setPixmap(ColumnName, *pix);
+    core::CollisionModel* model = core::CollisionModel::DynamicCast(object);
+    if (model)
+    {
+        const helper::set<int>& groups = model->getGroups();
         QString groupString;
-        helper::set<int>::const_iterator it = groups.begin(), itend = groups.end();
-        for( ; it != itend ; ++it ) groupString += QString::number(*it) + ", ";
-        item->setText(3,groupString);
-        }
-        items_stats.push_back(std::make_pair(v[i], item));
+        helper::set<int>::const_iterator itGroup = groups.begin(), itGroupEnd = groups.end();
+        for( ; itGroup != itGroupEnd ; ++itGroup ) groupString += QString::number(*itGroup) + ", ";
+        stats.item->setText(ColumnGroup, groupString);
     }
 }
 
-void QSofaStatWidget::addSummary()
+void QSofaStatWidget::updateComponent(core::objectmodel::BaseObject* object, ComponentStats& stats)
 {
-    std::set< std::string > nameElement;
-    std::map< std::string, int > mapElement;
-    for (unsigned int i=0; i < items_stats.size(); i++)
-        nameElement.insert(items_stats[i].first->getClassName());
+    unsigned int elements = 0;
+    unsigned int dofs = 0;
+    switch (stats.category)
+    {
+    case CategoryMechanicalState:
+    {
+        core::behavior::BaseMechanicalState* mstate = core::behavior::BaseMechanicalState::DynamicCast(object);
+        elements = mstate->getSize();
+        dofs = elements * (unsigned int)mstate->getDerivDimension();
+        break;
+    }
+    case CategoryTopology:
+    {
+        core::topology::BaseMeshTopology* topology = core::topology::BaseMeshTopology::DynamicCast(object);
+        if (topology) elements = getNbTopologyElements(topology);
+        break;
+    }
+    case CategoryCollisionModel:
+    {
+        // the inactive models are not counted, as they do not take part in the collision detection
+        core::CollisionModel* model = core::CollisionModel::DynamicCast(object);
+        if (model->isActive()) elements = model->getSize();
+        break;
+    }
+    default:
+        break;
+    }
+    std::size_t memory = getDatasMemory(object);
+
+    if (elements == stats.elements && dofs == stats.dofs && memory == stats.memory) return;
 
+    CategoryStats& total = totals[stats.category];
+    total.elements += elements - stats.elements;
+    total.dofs += dofs - stats.dofs;
+    total.memory += memory - stats.memory;
+    if (stats.category == CategoryCollisionModel)
+        collisionElements[object->getClassName()] += elements - stats.elements;
+    stats.elements = elements;
+    stats.dofs = dofs;
+    stats.memory = memory;
+    summaryDirty = true;
 
-    for (unsigned int i=0; i < items_stats.size(); i++)
-        mapElement[items_stats[i].first->getClassName()] += atoi(items_stats[i].second->text(2));
+    if (!stats.item) return;
+    StatListViewItem* item = static_cast<StatListViewItem*>(stats.item);
+    item->setValue(ColumnElements, elements);
+    item->setValue(ColumnDofs, dofs);
+    item->setValue(ColumnMemory, (double)memory);
+    item->setText(ColumnElements, elements ? QString::number(elements) : QString());
+    item->setText(ColumnDofs, dofs ? QString::number(dofs) : QString());
+    item->setText(ColumnMemory, formatMemory(memory));
+}
 
+void QSofaStatWidget::addSummary()
+{
+    summaryDirty = false;
+    unsigned int nbComponents = 0;
+    std::size_t memory = 0;
+    for (int c=0; c<NbCategories; ++c)
+    {
+        nbComponents += totals[c].components;
+        memory += totals[c].memory;
+    }
 
-    std::string textStats("<hr>Collision Elements present: <ul>");
-    std::map< std::string, int >::const_iterator it;
+    char buf[200];
+    sprintf ( buf, "<hr>Components present: %u (%s)<ul>", nbComponents, formatMemory(memory).ascii() );
+    std::string textStats(buf);
+    for (int c=0; c<NbCategories; ++c)
+    {
+        const CategoryStats& total = totals[c];
+        if (!total.components) continue;
+        sprintf ( buf, "<li><b>%s:</b> %u", categoryNames[c], total.components );
+        textStats += buf;
+        if (total.elements)
+        {
+            sprintf ( buf, ", %u elements", total.elements );
+            textStats += buf;
+        }
+        if (total.dofs)
+        {
+            sprintf ( buf, ", %u DOFs", total.dofs );
+            textStats += buf;
+        }
+        sprintf ( buf, ", %s</li>", formatMemory(total.memory).ascii() );
+        textStats += buf;
+    }
+    textStats += "</ul>Collision Elements present: <ul>";
 
-    for (it=mapElement.begin(); it!=mapElement.end(); ++it)
+    std::map< std::string, unsigned int >::const_iterator it;
+    for (it=collisionElements.begin(); it!=collisionElements.end(); ++it)
     {
         if (it->second)
         {
-            char buf[100];
-            sprintf ( buf, "<li><b>%s:</b> %d</li>", it->first.c_str(), it->second );
+            sprintf ( buf, "<li><b>%s:</b> %u</li>", it->first.c_str(), it->second );
             textStats += buf;
         }
     }
@@ -27,20 +27,27 @@
 
 #include "SofaGUIQt.h"
 #include <sofa/helper/vector.h>
+#include <sofa/simulation/common/Node.h>
+#include <sofa/simulation/common/MutationListener.h>
 
 #ifdef SOFA_QT4
 #include <QLabel>
 #include <QWidget>
+#include <QTimer>
 #include <Q3ListView>
 #include <Q3ListViewItem>
 #include <Q3Header>
 #else
 #include <qlabel.h>
 #include <qwidget.h>
+#include <qtimer.h>
 #include <qlistview.h>
 #include <qheader.h>
 #endif
 
+#include <map>
+#include <string>
+
 #ifndef SOFA_QT4
 typedef QListView Q3ListView;
 typedef QListViewItem Q3ListViewItem;
@@ -48,37 +55,102 @@ typedef QListViewItem Q3ListViewItem;
 
 namespace sofa
 {
-namespace core
-{
-class CollisionModel;
-namespace objectmodel
-{
-class Base;
-}
-}
-namespace simulation
-{
-class Node;
-}
 
 namespace gui
 {
 namespace qt
 {
 
-class SOFA_SOFAGUIQT_API QSofaStatWidget : public QWidget
+/// Statistics of the components of the scene: elements, degrees of freedom and
+/// memory of each component, and their totals per category.
+/// The components are registered through the graph mutation events, so that the
+/// graph is never searched. Their sizes are refreshed at a low rate, a batch of
+/// components at a time, and the totals are updated from the differences.
+class SOFA_SOFAGUIQT_API QSofaStatWidget : public QWidget, public sofa::simulation::MutationListener
 {
     Q_OBJECT
 public:
+    typedef sofa::simulation::Node Node;
+
+    enum Category
+    {
+        CategoryMechanicalState = 0,
+        CategoryMass,
+        CategoryForceField,
+        CategoryConstraint,
+        CategoryTopology,
+        CategoryCollisionModel,
+        CategoryMapping,
+        CategorySolver,
+        CategoryVisualModel,
+        CategoryOther,
+        NbCategories
+    };
+
     QSofaStatWidget(QWidget* parent);
-    void CreateStats(sofa::simulation::Node* root);
+    virtual ~QSofaStatWidget();
+
+    /// Listen to the given scene if it is not already the case, and refresh the statistics
+    void CreateStats(Node* root);
+    /// Stop listening to the scene, to be called before it is unloaded
+    void detach();
+
+    virtual void removeChild(Node* parent, Node* child);
+    virtual void addObject(Node* parent, core::objectmodel::BaseObject* object);
+    virtual void removeObject(Node* parent, core::objectmodel::BaseObject* object);
+
+public slots:
+    void refresh();
+
 protected:
+    enum { RefreshPeriod = 1000, RefreshBatch = 512 };
+
+    struct ComponentStats
+    {
+        Node* node;
+        Category category;
+        unsigned int elements;
+        unsigned int dofs;
+        std::size_t memory;
+        Q3ListViewItem* item;
+    };
+
+    struct CategoryStats
+    {
+        unsigned int components;
+        unsigned int elements;
+        unsigned int dofs;
+        std::size_t memory;
+    };
+
+    struct NodeStats
+    {
+        Q3ListViewItem* item;
+        unsigned int nbComponents;
+    };
+
+    typedef std::map<core::objectmodel::BaseObject*, ComponentStats> ComponentMap;
+
     QLabel* statsLabel;
     Q3ListView* statsCounter;
-    void addSummary();
-    void addCollisionModelsStat(const sofa::helper::vector< sofa::core::CollisionModel* >& v);
-    std::vector<std::pair<core::objectmodel::Base*, Q3ListViewItem*> > items_stats;
+    QTimer* timerRefresh;
 
+    /// kept alive until detached, so that the listeners can always be removed
+    Node::SPtr root;
+    ComponentMap components;
+    std::map<Node*, NodeStats> nodes;
+    /// components registered since the last refresh, without item yet
+    std::vector<core::objectmodel::BaseObject*> pendingComponents;
+    /// next component to refresh, the batches go round the components
+    core::objectmodel::BaseObject* nextComponent;
+    CategoryStats totals[NbCategories];
+    /// number of collision elements per class of collision model
+    std::map<std::string, unsigned int> collisionElements;
+    bool summaryDirty;
+
+    void createItem(core::objectmodel::BaseObject* object, ComponentStats& stats);
+    void updateComponent(core::objectmodel::BaseObject* object, ComponentStats& stats);
+    void addSummary();
 };
 } //qt
 } //gui
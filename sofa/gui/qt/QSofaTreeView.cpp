@@ -0,0 +1,583 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "QSofaTreeView.h"
+#include "ModifyObject.h"
+#include "GenGraphForm.h"
+#include "RealGUI.h"
+#include <sofa/simulation/common/DeleteVisitor.h>
+
+#include <QMenu>
+#include <QHeaderView>
+#include <QApplication>
+#include <QTime>
+
+using namespace sofa::simulation;
+using namespace sofa::core::objectmodel;
+namespace sofa
+{
+namespace gui
+{
+namespace qt
+{
+
+QSofaTreeView::QSofaTreeView(QWidget* parent)
+    : QTreeView(parent)
+    , model_(new SceneGraphModel(this))
+    , filterTimer_(new QTimer(this))
+    , filterRevision_(0)
+    , filterLocked_(false)
+{
+    setModel(model_);
+    setUniformRowHeights(true);
+    header()->hide();
+    setRootIsDecorated(true);
+    setIndentation(15);
+    setContextMenuPolicy(Qt::CustomContextMenu);
+
+    connect(this, SIGNAL(customContextMenuRequested(const QPoint&)), this, SLOT(showContextMenu(const QPoint&)));
+    connect(this, SIGNAL(doubleClicked(const QModelIndex&)), this, SLOT(indexDoubleClicked(const QModelIndex&)));
+    connect(selectionModel(), SIGNAL(currentChanged(const QModelIndex&, const QModelIndex&)),
+            this, SLOT(currentIndexChanged(const QModelIndex&, const QModelIndex&)));
+    connect(model_, SIGNAL(rowsInserted(const QModelIndex&, int, int)), this, SLOT(filterInsertedRows(const QModelIndex&, int, int)));
+    connect(filterTimer_, SIGNAL(timeout()), this, SLOT(processFilterSlice()));
+}
+
+QSofaTreeView::~QSofaTreeView()
+{
+    stopFilter();
+    model_->setRoot(NULL);
+}
+
+void QSofaTreeView::Clear(Node* rootNode)
+{
+    stopFilter();
+    CloseAllDialogs();
+    selectedComponent_.reset();
+    hidden_.clear();
+    model_->setRoot(rootNode);
+    model_->freeze();
+    if (!rootNode) return;
+
+    expand(model_->index(0, 0));
+
+    // same requests as QSofaListView for the nodes loaded inactive
+    std::vector<Node*> nodes(1, rootNode);
+    while (!nodes.empty())
+    {
+        Node* node = nodes.back();
+        nodes.pop_back();
+        if (!node->isActive())
+            emit RequestActivation(node, node->isActive());
+        for (Node::ChildIterator it = node->child.begin(); it != node->child.end(); ++it)
+            nodes.push_back(it->get());
+    }
+}
+
+void QSofaTreeView::Freeze()
+{
+    model_->freeze();
+}
+
+void QSofaTreeView::Unfreeze()
+{
+    model_->unfreeze();
+}
+
+void QSofaTreeView::CloseAllDialogs()
+{
+    emit( Close() );
+    assert( map_modifyObjectWindow.empty() );
+}
+
+void QSofaTreeView::UpdateOpenedDialogs()
+{
+    std::map<void*,QDialog*>::const_iterator iter;
+    for(iter = map_modifyObjectWindow.begin(); iter != map_modifyObjectWindow.end() ; ++iter)
+    {
+        ModifyObject* modify = reinterpret_cast<ModifyObject*>(iter->second);
+        modify->updateTables();
+    }
+}
+
+void QSofaTreeView::modifyUnlock(void* Id)
+{
+    map_modifyObjectWindow.erase( Id );
+}
+
+void QSofaTreeView::refresh()
+{
+    viewport()->update();
+}
+
+void QSofaTreeView::updateSearchIndex()
+{
+    // the name of a component may have been changed in its dialog
+    model_->getSearchIndex().updateNames();
+}
+
+void QSofaTreeView::selectComponent(Base* base)
+{
+    const QModelIndex index = model_->indexOf(base);
+    if (!index.isValid())
+    {
+        clearSelection();
+        return;
+    }
+    scrollTo(index);
+    selectionModel()->setCurrentIndex(index, QItemSelectionModel::ClearAndSelect);
+}
+
+Node* QSofaTreeView::currentNode() const
+{
+    return Node::DynamicCast(model_->getBase(currentIndex()));
+}
+
+BaseObject* QSofaTreeView::currentObject() const
+{
+    return BaseObject::DynamicCast(model_->getBase(currentIndex()));
+}
+
+void QSofaTreeView::currentIndexChanged(const QModelIndex& current, const QModelIndex& /*previous*/)
+{
+    Base* base = model_->getBase(current);
+    if (!base && model_->getData(current))
+        base = model_->getData(current)->getOwner();
+    if (base != selectedComponent_.get())
+    {
+        selectedComponent_ = base;
+        emit selectedComponentChanged(base);
+    }
+}
+
+void QSofaTreeView::indexDoubleClicked(const QModelIndex& index)
+{
+    if (!index.isValid()) return;
+    setExpanded(index, !isExpanded(index));
+    Modify();
+}
+
+/*****************************************************************************************************************/
+// n-th child of a component in the display order of the model, NULL past the last one
+static Base* childAt(Base* base, unsigned int n)
+{
+    if (Node* node = Node::DynamicCast(base))
+    {
+        if (n < node->object.size()) return (node->object.begin()+n)->get();
+        n -= (unsigned int)node->object.size();
+        if (n < node->child.size()) return (node->child.begin()+n)->get();
+    }
+    else if (BaseObject* object = BaseObject::DynamicCast(base))
+    {
+        const BaseObject::VecSlaves& slaves = object->getSlaves();
+        if (n < slaves.size()) return slaves[n].get();
+    }
+    return NULL;
+}
+
+void QSofaTreeView::pushFilterFrame(Base* base, bool parentMatched)
+{
+    FilterFrame frame;
+    frame.base = base;
+    frame.nextChild = 0;
+    frame.visitChildren = true;
+    frame.childrenParentMatched = false;
+    frame.visibleIfChildVisible = false;
+    frame.hasVisibleChild = false;
+    frame.visible = false;
+
+    if (filter_.matches(base, NULL, Node::DynamicCast(base) != NULL, parentMatched))
+    {
+        frame.visible = filter_.showsContent(base);
+        frame.visitChildren = frame.visible;
+        frame.childrenParentMatched = true;
+    }
+    else
+    {
+        frame.visibleIfChildVisible = true;
+    }
+    filterStack_.push_back(frame);
+}
+
+void QSofaTreeView::restartFilter()
+{
+    filterStack_.clear();
+    filterHidden_.clear();
+    filterRevision_ = model_->getRevision();
+    if (!model_->getRoot()) return;
+
+    // the components added since the last walk are in the index
+    filter_.findMatches(model_->getSearchIndex());
+    pushFilterFrame(model_->getRoot(), false);
+}
+
+void QSofaTreeView::stopFilter()
+{
+    filterTimer_->stop();
+    filterStack_.clear();
+    filterHidden_.clear();
+    if (filterLocked_)
+    {
+        filterLocked_ = false;
+        emit Lock(false);
+    }
+}
+
+void QSofaTreeView::processFilterSlice()
+{
+    // the graph changed since the last slice, the walk may refer to deleted components
+    if (model_->getRevision() != filterRevision_)
+        restartFilter();
+
+    QTime sliceTime;
+    sliceTime.start();
+    unsigned int nbProcessed = 0;
+    while (!filterStack_.empty())
+    {
+        if ((++nbProcessed % 64) == 0 && sliceTime.elapsed() >= FilterTimeSlice)
+            return; // the timer calls this slot again once the events are processed
+
+        // the graph is walked, not the rows, so that the filter does not create them
+        FilterFrame& frame = filterStack_.back();
+        Base* child = frame.visitChildren ? childAt(frame.base, frame.nextChild) : NULL;
+        if (child)
+        {
+            const bool parentMatched = frame.childrenParentMatched;
+            ++frame.nextChild;
+            pushFilterFrame(child, parentMatched);
+            continue;
+        }
+
+        // all the children of the component are done
+        const FilterFrame done = frame;
+        filterStack_.pop_back();
+        const bool visible = done.visible || (done.visibleIfChildVisible && done.hasVisibleChild);
+        if (!visible) filterHidden_.insert(done.base);
+        else if (!filterStack_.empty()) filterStack_.back().hasVisibleChild = true;
+    }
+
+    hidden_.swap(filterHidden_);
+    applyHiddenRows(QModelIndex());
+    stopFilter();
+}
+
+void QSofaTreeView::applyHiddenRows(const QModelIndex& parent)
+{
+    const int n = model_->rowCount(parent);
+    for (int r = 0; r < n; ++r)
+    {
+        const QModelIndex index = model_->index(r, 0, parent);
+        Base* base = model_->getBase(index);
+        setRowHidden(r, parent, base != NULL && hidden_.count(base) != 0);
+        applyHiddenRows(index);
+    }
+}
+
+void QSofaTreeView::filterInsertedRows(const QModelIndex& parent, int first, int last)
+{
+    if (hidden_.empty()) return;
+    for (int r = first; r <= last; ++r)
+    {
+        Base* base = model_->getBase(model_->index(r, 0, parent));
+        if (base && hidden_.count(base)) setRowHidden(r, parent, true);
+    }
+}
+
+void QSofaTreeView::applyFilter()
+{
+    // the animation is locked once for the whole filtering, which restarts from the root
+    if (!filterLocked_)
+    {
+        filterLocked_ = true;
+        emit Lock(true);
+    }
+    restartFilter();
+
+    processFilterSlice();
+    if (isFiltering())
+        filterTimer_->start(0);
+}
+
+void QSofaTreeView::setFilter(const QString &newFilter)
+{
+    filter_.setFilter(newFilter);
+    applyFilter();
+}
+
+void QSofaTreeView::setSearchName(bool value)
+{
+    if (value == filter_.getSearchName()) return;
+    filter_.setSearchName(value);
+    applyFilter();
+}
+
+void QSofaTreeView::setSearchType(bool value)
+{
+    if (value == filter_.getSearchType()) return;
+    filter_.setSearchType(value);
+    applyFilter();
+}
+
+void QSofaTreeView::setActivatedFilter(bool value)
+{
+    if (value == filter_.getActivatedFilter()) return;
+    filter_.setActivatedFilter(value);
+    applyFilter();
+}
+
+void QSofaTreeView::setDisplayChildrenWhenParentMatches(bool value)
+{
+    if (value == filter_.getDisplayChildrenWhenParentMatches()) return;
+    filter_.setDisplayChildrenWhenParentMatches(value);
+    applyFilter();
+}
+
+/*****************************************************************************************************************/
+void QSofaTreeView::showContextMenu(const QPoint& point)
+{
+    const QModelIndex index = indexAt(point);
+    if (!index.isValid() || model_->isMultiNode(index)) return;
+
+    Node* node = Node::DynamicCast(model_->getBase(index));
+    BaseObject* object = BaseObject::DynamicCast(model_->getBase(index));
+
+    QMenu* contextMenu = new QMenu(this);
+    contextMenu->setAttribute(Qt::WA_DeleteOnClose);
+    if (node)
+    {
+        QAction* action = contextMenu->addAction("Focus", this, SLOT(focusNode()));
+        action->setEnabled(node->f_bbox.getValue().isValid() && !node->f_bbox.getValue().isFlat());
+    }
+    if (object)
+    {
+        QAction* action = contextMenu->addAction("Focus", this, SLOT(focusObject()));
+        action->setEnabled(object->f_bbox.getValue().isValid() && !object->f_bbox.getValue().isFlat());
+    }
+    contextMenu->addSeparator();
+
+    if (node)
+    {
+        contextMenu->addAction("Collapse", this, SLOT(collapseNode()));
+        contextMenu->addAction("Expand", this, SLOT(expandNode()));
+        contextMenu->addSeparator();
+        if (node->isActive())
+            contextMenu->addAction("Deactivate", this, SLOT(DeactivateNode()));
+        else
+            contextMenu->addAction("Activate", this, SLOT(ActivateNode()));
+        contextMenu->addSeparator();
+
+        contextMenu->addAction("Set filter on node", this, SLOT(setFilterOnNode()));
+        contextMenu->addAction("Enable Draw", this, SLOT(enableDraw()));
+        contextMenu->addAction("Disable Draw", this, SLOT(disableDraw()));
+        contextMenu->addSeparator();
+
+        contextMenu->addAction("Save Node", this, SLOT(SaveNode()));
+        contextMenu->addAction("Export OBJ", this, SLOT(exportOBJ()));
+        QAction* remove = contextMenu->addAction("Remove Node", this, SLOT(RemoveNode()));
+        //If one of the elements or child of the current node is beeing modified, you cannot allow the user to erase the node
+        remove->setEnabled(isNodeErasable(node));
+    }
+    contextMenu->addAction("Modify", this, SLOT(Modify()));
+    if (object && !object->getDataFields().empty())
+    {
+        if (model_->isShowingDatas(object))
+            contextMenu->addAction("Hide Datas", this, SLOT(HideDatas()));
+        else
+            contextMenu->addAction("Show Datas", this, SLOT(ShowDatas()));
+    }
+    contextMenu->popup(viewport()->mapToGlobal(point));
+}
+
+void QSofaTreeView::focusObject()
+{
+    if (BaseObject* object = currentObject())
+        emit( focusChanged(object) );
+}
+
+void QSofaTreeView::focusNode()
+{
+    if (Node* node = currentNode())
+        emit( focusChanged((BaseNode*)node) );
+}
+
+void QSofaTreeView::collapseNode()
+{
+    const QModelIndex index = currentIndex();
+    if (!index.isValid()) return;
+    const int n = model_->rowCount(index);
+    for (int r = 0; r < n; ++r)
+        collapse(model_->index(r, 0, index));
+    expand(index);
+}
+
+void QSofaTreeView::expandNode()
+{
+    emit Lock(true);
+    expandNode(currentIndex());
+    emit Lock(false);
+}
+
+void QSofaTreeView::expandNode(const QModelIndex& index)
+{
+    if (!index.isValid() || !Node::DynamicCast(model_->getBase(index))) return;
+    if (model_->canFetchMore(index)) model_->fetchMore(index);
+    expand(index);
+    const int n = model_->rowCount(index);
+    for (int r = 0; r < n; ++r)
+        expandNode(model_->index(r, 0, index));
+}
+
+void QSofaTreeView::DeactivateNode()
+{
+    if (Node* node = currentNode())
+    {
+        emit RequestActivation(node, false);
+        collapse(currentIndex());
+    }
+}
+
+void QSofaTreeView::ActivateNode()
+{
+    if (Node* node = currentNode())
+        emit RequestActivation(node, true);
+}
+
+void QSofaTreeView::setFilterOnNode()
+{
+    if (Node* node = currentNode())
+        setFilter(QString("\"") + QString(node->getName().c_str()));
+}
+
+void QSofaTreeView::enableDraw()
+{
+    if (Node* node = currentNode())
+        emit requestDrawActivation(node, true);
+}
+
+void QSofaTreeView::disableDraw()
+{
+    if (Node* node = currentNode())
+        emit requestDrawActivation(node, false);
+}
+
+void QSofaTreeView::SaveNode()
+{
+    if (Node* node = currentNode())
+    {
+        emit Lock(true);
+        emit RequestSaving(node);
+        emit Lock(false);
+    }
+}
+
+void QSofaTreeView::exportOBJ()
+{
+    if (Node* node = currentNode())
+    {
+        emit Lock(true);
+        emit RequestExportOBJ(node,true);
+        emit Lock(false);
+    }
+}
+
+void QSofaTreeView::RemoveNode()
+{
+    Node* node = currentNode();
+    if (!node) return;
+    emit Lock(true);
+    if ( node == node->getRoot() )
+    {
+        //Attempt to destroy the Root node : create an empty node to handle new graph interaction
+        Node::SPtr root = simulation::getSimulation()->createNewGraph( "Root" );
+        model_->setRoot(root.get());
+        emit RootNodeChanged(root.get(),NULL);
+    }
+    else
+    {
+        node->detachFromGraph();
+        node->execute<simulation::DeleteVisitor>(sofa::core::ExecParams::defaultInstance());
+        emit NodeRemoved();
+    }
+    emit Lock(false);
+}
+
+void QSofaTreeView::HideDatas()
+{
+    if (BaseObject* object = currentObject())
+        model_->setShowDatas(object, false);
+}
+
+void QSofaTreeView::ShowDatas()
+{
+    if (BaseObject* object = currentObject())
+    {
+        model_->setShowDatas(object, true);
+        expand(currentIndex());
+    }
+}
+
+// Test if a node can be erased in the graph : the condition is that none of its children has a menu modify opened
+bool QSofaTreeView::isNodeErasable(Node* node) const
+{
+    if (map_modifyObjectWindow.count(node)) return false;
+    for (Node::ObjectIterator it = node->object.begin(); it != node->object.end(); ++it)
+        if (map_modifyObjectWindow.count(it->get())) return false;
+    for (Node::ChildIterator it = node->child.begin(); it != node->child.end(); ++it)
+        if (map_modifyObjectWindow.count(it->get())) return false;
+    return true;
+}
+
+void QSofaTreeView::Modify()
+{
+    const QModelIndex index = currentIndex();
+    if (!index.isValid() || model_->isMultiNode(index)) return;
+
+    emit Lock(true);
+    //Opening of a dialog window automatically created
+    ModifyObject* dialogModifyObject = ModifyObject::openFromGraphView(this, model_->getBase(index), model_->getData(index),
+            model_->data(index).toString(), NULL, noItems_, map_modifyObjectWindow);
+    if (dialogModifyObject)
+    {
+        connect ( dialogModifyObject, SIGNAL( objectUpdated() ), this, SLOT( refresh() ));
+        connect ( dialogModifyObject, SIGNAL( objectUpdated() ), this, SLOT( updateSearchIndex() ));
+        connect ( dialogModifyObject, SIGNAL( nodeNameModification(simulation::Node*) ) , this, SLOT( refresh() ));
+        connect ( dialogModifyObject, SIGNAL( nodeNameModification(simulation::Node*) ) , this, SLOT( updateSearchIndex() ));
+        dialogModifyObject->show();
+        dialogModifyObject->raise();
+    }
+    emit Lock(false);
+}
+
+void QSofaTreeView::Export()
+{
+    Node* root = model_->getRoot();
+    if (!root) return;
+    GenGraphForm* form = new sofa::gui::qt::GenGraphForm;
+    form->setScene ( root, ((RealGUI*) (qApp->mainWidget()))->windowFilePath().ascii() );
+    form->show();
+}
+
+} // namespace qt
+} // namespace gui
+} // namespace sofa
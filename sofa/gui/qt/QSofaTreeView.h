@@ -0,0 +1,175 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_QT_QSOFATREEVIEW_H
+#define SOFA_GUI_QT_QSOFATREEVIEW_H
+
+#include "SofaGUIQt.h"
+#include "SceneGraphModel.h"
+#include "SceneGraphFilter.h"
+
+#include <QTreeView>
+#include <QDialog>
+#include <Q3ListViewItem>
+#include <QTimer>
+
+#include <sofa/simulation/common/Node.h>
+
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+namespace qt
+{
+
+/// Scene graph widget for large scenes, showing a SceneGraphModel whose rows are
+/// created when their parent is expanded. It offers the context menu, filters and
+/// signals of QSofaListView, the filter walking the graph by time slices.
+class SOFA_SOFAGUIQT_API QSofaTreeView : public QTreeView
+{
+    Q_OBJECT
+public:
+    QSofaTreeView(QWidget* parent=0);
+    ~QSofaTreeView();
+
+    SceneGraphModel* getModel() const { return model_; }
+    void Clear(sofa::simulation::Node* rootNode);
+    void Freeze();
+    void Unfreeze();
+    /// Start filtering the components, cancelling the filtering in progress.
+    /// The graph is walked by time slices, the rows are hidden once all of it is done.
+    void applyFilter();
+    bool isFiltering() const { return !filterStack_.empty(); }
+    /// Select and show the row of the component, creating the rows above it
+    void selectComponent(core::objectmodel::Base* base);
+
+public Q_SLOTS:
+    void Export();
+    void CloseAllDialogs();
+    void UpdateOpenedDialogs();
+
+    void setFilter( const QString & );
+    void setSearchName( bool );
+    void setSearchType( bool );
+    void setActivatedFilter(bool);
+    void setDisplayChildrenWhenParentMatches( bool );
+    void Modify();
+
+Q_SIGNALS:
+    void Close();
+    void Lock(bool);
+    void RequestSaving(sofa::simulation::Node*);
+    void RequestExportOBJ(sofa::simulation::Node* node, bool exportMTL);
+    void RequestActivation(sofa::simulation::Node*,bool);
+    void RootNodeChanged(sofa::simulation::Node* newroot, const char* newpath);
+    void NodeRemoved();
+    void Updated();
+    void selectedComponentChanged(sofa::core::objectmodel::Base*);
+    void focusChanged(sofa::core::objectmodel::BaseObject*);
+    void focusChanged(sofa::core::objectmodel::BaseNode*);
+    void dataModified( QString );
+    void requestDrawActivation(sofa::simulation::Node*, bool status);
+
+protected Q_SLOTS:
+    void SaveNode();
+    void exportOBJ();
+    void collapseNode();
+    void expandNode();
+    void modifyUnlock(void* Id);
+    void RemoveNode();
+    void HideDatas();
+    void ShowDatas();
+    void DeactivateNode();
+    void ActivateNode();
+    void setFilterOnNode();
+    void enableDraw();
+    void disableDraw();
+    void focusObject();
+    void focusNode();
+    void refresh();
+    /// Filter components until the time slice is elapsed
+    void processFilterSlice();
+    void updateSearchIndex();
+
+    void showContextMenu(const QPoint& point);
+    void currentIndexChanged(const QModelIndex& current, const QModelIndex& previous);
+    void indexDoubleClicked(const QModelIndex& index);
+    /// Hide the new rows filtered out
+    void filterInsertedRows(const QModelIndex& parent, int first, int last);
+
+protected:
+    /// Component being filtered, with the next of its children to visit
+    struct FilterFrame
+    {
+        core::objectmodel::Base* base;
+        unsigned int nextChild;
+        bool visitChildren;
+        bool childrenParentMatched;
+        bool visibleIfChildVisible;
+        bool hasVisibleChild;
+        bool visible;
+    };
+
+    /// Decide the visibility of the component from the filter, and whether its children are visited
+    void pushFilterFrame(core::objectmodel::Base* base, bool parentMatched);
+    void restartFilter();
+    void stopFilter();
+    void applyHiddenRows(const QModelIndex& parent);
+    void expandNode(const QModelIndex& index);
+    bool isNodeErasable(sofa::simulation::Node* node) const;
+    sofa::simulation::Node* currentNode() const;
+    core::objectmodel::BaseObject* currentObject() const;
+
+    SceneGraphModel* model_;
+    /// components filtered out, the rows are hidden when they are created
+    std::unordered_set<core::objectmodel::Base*> hidden_;
+    std::map< void*, QDialog* > map_modifyObjectWindow;
+    /// the modify dialogs of this view have no list item to update
+    std::unordered_map<core::objectmodel::Base*, Q3ListViewItem* > noItems_;
+    sofa::core::objectmodel::Base::SPtr selectedComponent_;
+
+    SceneGraphFilter filter_;
+    enum { FilterTimeSlice = 10 }; // ms
+    QTimer* filterTimer_;
+    std::vector<FilterFrame> filterStack_;
+    /// components filtered out by the walk in progress
+    std::unordered_set<core::objectmodel::Base*> filterHidden_;
+    unsigned int filterRevision_;
+    bool filterLocked_;
+};
+
+} // namespace qt
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_QT_QSOFATREEVIEW_H
@@ -110,10 +110,10 @@ void QTabulationModifyObject::updateListViewItem()
 {
     if (simulation::Node *node=simulation::Node::DynamicCast(object))
     {
-        item->setText(0,object->getName().c_str());
+        if (item) item->setText(0,object->getName().c_str());
         emit nodeNameModification(node);
     }
-    else
+    else if (item)
     {
         QString currentName = item->text(0);
 
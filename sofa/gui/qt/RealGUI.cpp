@@ -35,6 +35,8 @@
 #endif
 
 #include "QSofaListView.h"
+#include "QSofaTreeView.h"
+#include "QComponentSearchDialog.h"
 #include "FileManagement.h"
 #include "DisplayFlagsDataWidget.h"
 #include "SofaPluginManager.h"
@@ -288,10 +290,13 @@ RealGUI::RealGUI(const sofa::simulation::gui::BaseGUIArgument* a)
 #ifdef SOFA_DUMP_VISITOR_INFO
     windowTraceVisitor(NULL),
     handleTraceVisitor(NULL),
+    m_nbTimedSteps(0),
 #endif
 
     simulationGraph(NULL),
+    sceneGraphView(NULL),
     mCreateViewersOpt(true),
+    mLazyGraphOpt(false),
     mIsEmbeddedViewer(true),
     m_dumpState(false),
     m_dumpStateStream(NULL),
@@ -303,8 +308,10 @@ RealGUI::RealGUI(const sofa::simulation::gui::BaseGUIArgument* a)
     mViewer(NULL),
     currentTab(NULL),
     statWidget(NULL),
+    componentSearchDialog(NULL),
     timerStep(NULL),
     timerIdle(NULL),
+    timerStepTimes(NULL),
     backgroundImage(NULL),
     left_stack(NULL),
     pluginManager_dialog(NULL),
@@ -333,6 +340,8 @@ RealGUI::RealGUI(const sofa::simulation::gui::BaseGUIArgument* a)
     connect ( timerStep, SIGNAL ( timeout() ), this, SLOT ( step() ) );
     timerIdle = new QTimer(this);
     connect ( timerIdle, SIGNAL ( timeout() ), this, SLOT ( idle() ) );
+    timerStepTimes = new QTimer(this);
+    connect ( timerStepTimes, SIGNAL ( timeout() ), this, SLOT ( updateStepTimes() ) );
     connect(this, SIGNAL(quit()), this, SLOT(fileExit()));
     connect ( startButton, SIGNAL ( toggled ( bool ) ), this , SLOT ( playpauseGUI ( bool ) ) );
     connect ( ResetSceneButton, SIGNAL ( clicked() ), this, SLOT ( resetScene() ) );
@@ -513,6 +522,9 @@ RealGUI::~RealGUI()
     delete handleTraceVisitor;
 #endif
 
+    statWidget->detach();
+    if (sceneGraphView)
+        sceneGraphView->Clear(NULL);
     removeViewer();
 
 #ifdef WIN32
@@ -959,6 +971,9 @@ void RealGUI::setScene ( Node::SPtr root, const char* filename, bool temporaryFi
         //loadHtmlDescription( filename );
     }
 
+    // a component of the new scene may be allocated where the last picked one was
+    informationOnPickCallBack.reset();
+
     if (root)
     {
         eventNewTime();
@@ -967,7 +982,10 @@ void RealGUI::setScene ( Node::SPtr root, const char* filename, bool temporaryFi
         //std::cout << "INIT ANIMATE " << (root->getContext()->getAnimate() ? "ON" : "OFF") << std::endl;
         startButton->setOn ( root->getContext()->getAnimate() );
         dtEdit->setText ( QString::number ( root->getDt() ) );
-        simulationGraph->Clear(root.get());
+        if (sceneGraphView)
+            sceneGraphView->Clear(root.get());
+        else
+            simulationGraph->Clear(root.get());
         statWidget->CreateStats(root.get());
 
 #ifndef SOFA_GUI_QT_NO_RECORDER
@@ -987,7 +1005,10 @@ void RealGUI::setScene ( Node::SPtr root, const char* filename, bool temporaryFi
             getQtViewer()->getQWidget()->update();
         }
 
-        simulationGraph->applyFilter();
+        if (sceneGraphView)
+            sceneGraphView->applyFilter();
+        else
+            simulationGraph->applyFilter();
 
         if (!root->getContext()->getAnimate())
         {
@@ -1004,6 +1025,10 @@ void RealGUI::unloadScene(bool _withViewer)
     if(_withViewer && getViewer())
         getViewer()->unload();
 
+    statWidget->detach();
+    if (sceneGraphView)
+        sceneGraphView->Clear(NULL);
+    informationOnPickCallBack.reset();
     simulation::getSimulation()->unload ( getCurrentSimulation() );
 
     if(_withViewer && getViewer())
@@ -1731,7 +1756,7 @@ void RealGUI::startDumpVisitor()
 {
 #ifdef SOFA_DUMP_VISITOR_INFO
     Node* root = currentSimulation();
-    if (root && this->exportVisitorCheckbox->isOn())
+    if (root && (this->exportVisitorCheckbox->isOn() || m_displayComputationTime))
     {
         m_dumpVisitorStream.str("");
         Visitor::startDumpVisitor(&m_dumpVisitorStream, root->getTime());
@@ -1744,13 +1769,16 @@ void RealGUI::startDumpVisitor()
 void RealGUI::stopDumpVisitor()
 {
 #ifdef SOFA_DUMP_VISITOR_INFO
-    if (this->exportVisitorCheckbox->isOn())
+    if (this->exportVisitorCheckbox->isOn() || m_displayComputationTime)
     {
         Visitor::stopDumpVisitor();
         m_dumpVisitorStream.flush();
-        //Creation of the graph
         std::string xmlDoc=m_dumpVisitorStream.str();
-        handleTraceVisitor->load(xmlDoc);
+        //Creation of the graph
+        if (this->exportVisitorCheckbox->isOn())
+            handleTraceVisitor->load(xmlDoc);
+        if (m_displayComputationTime)
+            GraphVisitor::addComponentTimes(xmlDoc, m_stepTimes);
         m_dumpVisitorStream.str("");
     }
 #endif
@@ -1808,6 +1836,15 @@ void RealGUI::initViewer(BaseViewer* _viewer)
         connect(simulationGraph, SIGNAL( focusChanged(sofa::core::objectmodel::BaseNode*) ),
                 qtViewer->getQWidget(), SLOT( fitNodeBBox(sofa::core::objectmodel::BaseNode*) )
                );
+        if (sceneGraphView)
+        {
+            connect(sceneGraphView, SIGNAL(focusChanged(sofa::core::objectmodel::BaseObject*)),
+                    qtViewer->getQWidget(), SLOT(fitObjectBBox(sofa::core::objectmodel::BaseObject*))
+                   );
+            connect(sceneGraphView, SIGNAL( focusChanged(sofa::core::objectmodel::BaseNode*) ),
+                    qtViewer->getQWidget(), SLOT( fitNodeBBox(sofa::core::objectmodel::BaseNode*) )
+                   );
+        }
 
         // splitter2 separates horizontally the OptionTab widget and the viewer widget
         QSplitter *splitter_ptr = dynamic_cast<QSplitter *> ( splitter2 );
@@ -1859,6 +1896,10 @@ void RealGUI::parseOptionsPreInit(const std::vector<std::string>& options)
         {
             mCreateViewersOpt = false;
         }
+        else if (opt == "lazyGraph")
+        {
+            mLazyGraphOpt = true;
+        }
         //Set number of iterations
         //(option = "nbIterations=N where N is the number of iterations)
         else if ( (cursor = opt.find("nbIterations=")) != std::string::npos )
@@ -2045,10 +2086,59 @@ void RealGUI::createSimulationGraph()
     connect(simulationGraph, SIGNAL( selectedComponentChanged(sofa::core::objectmodel::Base*)), this, SLOT(setSelectedComponent(sofa::core::objectmodel::Base*)));
     connect(this, SIGNAL( newScene() ), simulationGraph, SLOT( CloseAllDialogs() ) );
     connect(this, SIGNAL( newStep() ), simulationGraph, SLOT( UpdateOpenedDialogs() ) );
+
+    if (mLazyGraphOpt)
+    {
+        // the list view is kept for the code using it, but stays hidden and empty
+        simulationGraph->hide();
+        sceneGraphView = new QSofaTreeView(TabGraph);
+        ((QVBoxLayout*)TabGraph->layout())->addWidget(sceneGraphView);
+
+        connect ( GraphFilter, SIGNAL( textChanged(const QString &) ), sceneGraphView, SLOT( setFilter( const QString & ) ) );
+        connect ( SearchNamesCheckbox, SIGNAL( toggled( bool ) ), sceneGraphView, SLOT( setSearchName( bool ) ) );
+        connect ( SearchTypesCheckbox, SIGNAL( toggled( bool ) ), sceneGraphView, SLOT( setSearchType( bool ) ) );
+        connect ( ActivatedCheckbox, SIGNAL( toggled( bool ) ), sceneGraphView, SLOT( setActivatedFilter( bool ) ) );
+        connect ( DisplayChildrenCheckbox, SIGNAL( toggled( bool ) ), sceneGraphView, SLOT( setDisplayChildrenWhenParentMatches( bool ) ) );
+
+        connect ( ExportGraphButton, SIGNAL ( clicked() ), sceneGraphView, SLOT ( Export() ) );
+        connect(sceneGraphView, SIGNAL( RootNodeChanged(sofa::simulation::Node*, const char*) ), this, SLOT ( NewRootNode(sofa::simulation::Node* , const char*) ) );
+        connect(sceneGraphView, SIGNAL( NodeRemoved() ), this, SLOT( Update() ) );
+        connect(sceneGraphView, SIGNAL( Lock(bool) ), this, SLOT( LockAnimation(bool) ) );
+        connect(sceneGraphView, SIGNAL( RequestSaving(sofa::simulation::Node*) ), this, SLOT( fileSaveAs(sofa::simulation::Node*) ) );
+        connect(sceneGraphView, SIGNAL( RequestExportOBJ(sofa::simulation::Node*, bool) ), this, SLOT( exportOBJ(sofa::simulation::Node*, bool) ) );
+        connect(sceneGraphView, SIGNAL( RequestActivation(sofa::simulation::Node*, bool) ), this, SLOT( ActivateNode(sofa::simulation::Node*, bool) ) );
+        connect(sceneGraphView, SIGNAL( requestDrawActivation(sofa::simulation::Node*, bool)), this, SLOT(setDrawStatus(sofa::simulation::Node*, bool)));
+        connect(sceneGraphView, SIGNAL( Updated() ), this, SLOT( redraw() ) );
+        connect(sceneGraphView, SIGNAL( dataModified( QString ) ), this, SLOT( appendToDataLogFile(QString ) ) );
+        connect(sceneGraphView, SIGNAL( selectedComponentChanged(sofa::core::objectmodel::Base*)), this, SLOT(setSelectedComponent(sofa::core::objectmodel::Base*)));
+        connect(this, SIGNAL( newScene() ), sceneGraphView, SLOT( CloseAllDialogs() ) );
+        connect(this, SIGNAL( newStep() ), sceneGraphView, SLOT( UpdateOpenedDialogs() ) );
+    }
+    else
+    {
+        // the search index is only maintained for the items of simulationGraph
+        componentSearchDialog = new QComponentSearchDialog(simulationGraph, this);
+        connect(componentSearchDialog, SIGNAL( componentSelected(sofa::core::objectmodel::Base*) ), this, SLOT( goToComponent(sofa::core::objectmodel::Base*) ) );
+        QAction* goToAction = new QAction(this);
+        goToAction->setText("Go to component");
+        goToAction->setMenuText("&Go to component...");
+        goToAction->setAccel(QKeySequence("Ctrl+G"));
+        goToAction->addTo(View);
+        connect(goToAction, SIGNAL( activated() ), componentSearchDialog, SLOT( popup() ) );
+    }
+}
+
+void RealGUI::goToComponent(sofa::core::objectmodel::Base* component)
+{
+    tabs->showPage(TabGraph);
+    simulationGraph->selectComponent(component);
+    simulationGraph->setFocus();
 }
 
 void RealGUI::setSelectedComponent(sofa::core::objectmodel::Base* selected)
 {
+    // after a selection by hand, hovering the picked element selects it again
+    informationOnPickCallBack.selectionChanged(selected);
     getViewer()->setSelectedComponent(selected);
 }
 
@@ -2117,7 +2207,8 @@ void RealGUI::NewRootNode(sofa::simulation::Node* root, const char* path)
 
 void RealGUI::ActivateNode(sofa::simulation::Node* node, bool activate)
 {
-    QSofaListView* sofalistview = (QSofaListView*)sender();
+    QSofaListView* sofalistview = dynamic_cast<QSofaListView*>(sender());
+    const bool fromSceneGraphView = sceneGraphView != NULL && sender() == sceneGraphView;
 
     if (activate)
         node->setActive(true);
@@ -2141,12 +2232,20 @@ void RealGUI::ActivateNode(sofa::simulation::Node* node, bool activate)
             nodeToProcess.push_back(it->get());
     }
 
-    ActivationFunctor activator( activate, sofalistview->getListener() );
-    std::for_each(nodeToChange.begin(),nodeToChange.end(),activator);
+    if (sofalistview)
+    {
+        ActivationFunctor activator( activate, sofalistview->getListener() );
+        std::for_each(nodeToChange.begin(),nodeToChange.end(),activator);
+    }
+    else if (fromSceneGraphView)
+    {
+        // the model computes the text and icon of the rows when they are painted
+        sceneGraphView->viewport()->update();
+    }
     nodeToChange.clear();
     Update();
 
-    if ( sofalistview == simulationGraph && activate )
+    if ( (sofalistview == simulationGraph || fromSceneGraphView) && activate )
     {
         if ( node == getCurrentSimulation() )
             simulation::getSimulation()->init(node);
@@ -2327,8 +2426,10 @@ void RealGUI::step()
     //root->setLogTime(true);
     //T=T+DT
     SReal dt=root->getDt();
+    simulationGraph->beginMutationBatch();
     simulation::getSimulation()->animate ( root, dt );
     simulation::getSimulation()->updateVisual( root );
+    simulationGraph->endMutationBatch();
 
     if ( m_dumpState )
         simulation::getSimulation()->dumpState ( root, *m_dumpStateStream );
@@ -2353,6 +2454,10 @@ void RealGUI::step()
     }
 
     stopDumpVisitor();
+#ifdef SOFA_DUMP_VISITOR_INFO
+    if (m_displayComputationTime)
+        ++m_nbTimedSteps;
+#endif
     if (sofa::simulation::getSimulation()->getExitStatus(this->getCurrentSimulation())) emit(quit());
     if (currentGUIMode != 0)
         emit newStep();
@@ -2579,7 +2684,10 @@ void RealGUI::clear()
     if (recorder)
         recorder->Clear(currentSimulation());
 #endif
-    simulationGraph->Clear(getCurrentSimulation());
+    if (sceneGraphView)
+        sceneGraphView->Clear(getCurrentSimulation());
+    else
+        simulationGraph->Clear(getCurrentSimulation());
     statWidget->CreateStats(getCurrentSimulation());
 }
 
@@ -2666,6 +2774,29 @@ void RealGUI::displayComputationTime ( bool value )
             std::cout << "Deactivating Timer" << std::endl;
         sofa::helper::AdvancedTimer::setEnabled("Animate", value);
     }
+#ifdef SOFA_DUMP_VISITOR_INFO
+    // the times of the components are read from the visitor dump of each step
+    m_stepTimes.clear();
+    m_nbTimedSteps = 0;
+    simulationGraph->showStepTimes(value);
+    if (value)
+        timerStepTimes->start(StepTimesPeriod);
+    else
+        timerStepTimes->stop();
+#endif
+}
+
+//------------------------------------
+
+void RealGUI::updateStepTimes()
+{
+#ifdef SOFA_DUMP_VISITOR_INFO
+    // the dumps made without step, at loading or reset, are not displayed
+    if (m_nbTimedSteps > 0)
+        simulationGraph->setStepTimes(m_stepTimes, m_nbTimedSteps);
+    m_stepTimes.clear();
+    m_nbTimedSteps = 0;
+#endif
 }
 
 //------------------------------------
@@ -2714,9 +2845,19 @@ void RealGUI::currentTabChanged ( QWidget* widget )
         currentTab = widget;
 
     if ( widget == TabGraph )
-        simulationGraph->Unfreeze( );
+    {
+        if (sceneGraphView)
+            sceneGraphView->Unfreeze( );
+        else
+            simulationGraph->Unfreeze( );
+    }
     else if ( currentTab == TabGraph )
-        simulationGraph->Freeze();
+    {
+        if (sceneGraphView)
+            sceneGraphView->Freeze();
+        else
+            simulationGraph->Freeze();
+    }
     else if (widget == TabStats)
         statWidget->CreateStats(getCurrentSimulation());
 
@@ -82,7 +82,9 @@ class QSofaRecorder;
 enum SCRIPT_TYPE { PHP, PERL };
 
 class QSofaListView;
+class QSofaTreeView;
 class QSofaStatWidget;
+class QComponentSearchDialog;
 class GraphListenerQListView;
 class DisplayFlagsDataWidget;
 class SofaPluginManager;
@@ -194,6 +196,9 @@ private:
 #ifdef SOFA_DUMP_VISITOR_INFO
     WindowVisitor* windowTraceVisitor;
     GraphVisitor* handleTraceVisitor;
+    /// time in ms spent in each component during the steps dumped since the last update of the graph
+    std::map<std::string, double> m_stepTimes;
+    unsigned int m_nbTimedSteps;
 #endif
 //-----------------OPTIONS DEFINITIONS------------------------}
 
@@ -203,10 +208,14 @@ private:
 public:
     //TODO: make a protected data with an accessor
     QSofaListView* simulationGraph;
+    /// lazily populated graph used instead of simulationGraph with the lazyGraph option
+    QSofaTreeView* sceneGraphView;
 
 protected:
     /// create a viewer by default, otherwise you have to manage your own viewer
     bool mCreateViewersOpt;
+    /// show the scene graph in a QSofaTreeView, for large scenes
+    bool mLazyGraphOpt;
     bool mIsEmbeddedViewer;
     bool m_dumpState;
     std::ofstream* m_dumpStateStream;
@@ -224,8 +233,13 @@ protected:
 
     QWidget* currentTab;
     QSofaStatWidget* statWidget;
+    /// "Go to component" dialog, using the search index of simulationGraph
+    QComponentSearchDialog* componentSearchDialog;
     QTimer* timerStep;
     QTimer* timerIdle;
+    /// update of the times displayed in the graph when displayComputationTime is enabled
+    QTimer* timerStepTimes;
+    enum { StepTimesPeriod = 500 }; // ms
     WDoubleLineEdit *background[3];
     QLineEdit *backgroundImage;
     /// Stack viewer widget
@@ -459,6 +473,10 @@ protected slots:
     virtual void updateViewerList();
 
     void appendToDataLogFile(QString);
+    /// Show in the graph the average time of the components during the last steps
+    void updateStepTimes();
+    /// Select the component in the graph
+    void goToComponent(sofa::core::objectmodel::Base*);
 
 signals:
     void reload();
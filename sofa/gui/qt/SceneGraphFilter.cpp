@@ -0,0 +1,216 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "SceneGraphFilter.h"
+#include <sofa/core/objectmodel/ConfigurationSetting.h>
+
+#ifdef SOFA_QT4
+#include <QStringList>
+#else
+#include <qstringlist.h>
+#endif
+
+namespace sofa
+{
+
+namespace gui
+{
+
+namespace qt
+{
+
+using sofa::simulation::Node;
+using sofa::core::objectmodel::BaseObject;
+
+// Same as the comparison of a word to the text of the item of the component: the whole name
+// of a node, the last word of the name of an object, whose item shows the class and the name.
+// The settings are only shown by their class.
+static bool nameMatchesWord(core::objectmodel::Base* base, const std::string& str, bool exactMatch)
+{
+    const bool isNode = Node::DynamicCast(base) != NULL;
+    if (!isNode && core::objectmodel::ConfigurationSetting::DynamicCast(base)) return false;
+    if (!exactMatch) return true; // the name contains the word
+    const std::string name = SceneSearchIndex::toLower(base->getName());
+    if (isNode) return name == str;
+    const std::string::size_type pos = name.rfind(' ');
+    return (pos == std::string::npos ? name : name.substr(pos+1)) == str;
+}
+
+void SceneGraphFilter::Keys::set(const QString& itemText)
+{
+    // the keys are only computed again when the item is renamed
+    if (text == itemText && !lower.isNull()) return;
+    text = itemText;
+    lower = text.toLower();
+    QStringList list = lower.split(' ');
+    type = list.front();
+    hasName = list.size() >= 2;
+    if (hasName)
+    {
+        lastWord = list.back();
+        list.pop_front();
+        name = list.join(" ");
+    }
+    else
+    {
+        lastWord = QString();
+        name = QString();
+    }
+}
+
+SceneGraphFilter::SceneGraphFilter()
+    : searchName_(true)
+    , searchType_(true)
+    , activatedFilter_(true)
+    , displayChildrenWhenParentMatches_(true)
+{
+}
+
+void SceneGraphFilter::setFilter(const QString& filter)
+{
+    filter_ = filter;
+    tokens_.clear();
+    QStringList filterList = filter_.toLower().split(' ');
+    for (int fl = 0; fl < filterList.size(); ++fl)
+    {
+        Token token;
+        token.str = filterList.at(fl);
+        token.exactMatch = token.str.contains("\""); //search for exact match
+        if (token.exactMatch) token.str.remove(QChar('"'));
+        token.nodeOnly = token.str.contains("/");
+        if (token.nodeOnly) token.str.remove(QChar('/'));
+        token.warnings = !token.nodeOnly && token.str.contains("!");
+        tokens_.push_back(token);
+    }
+}
+
+void SceneGraphFilter::findMatches(const SceneSearchIndex& index)
+{
+    std::vector<Base*> found;
+    for (unsigned int fl = 0; fl < tokens_.size(); ++fl)
+    {
+        Token& token = tokens_[fl];
+        token.matches.clear();
+        if (token.warnings || token.str.isEmpty()) continue;
+        const std::string str(token.str.ascii());
+
+        // the nodes only match by their name, the objects also by their class, not by their
+        // template which is not shown. An exact name is looked up by the names containing it,
+        // as it is compared to the last word of the names of the objects.
+        found.clear();
+        if (searchName_)
+            index.findSubstring(str, SceneSearchIndex::NameMask, found);
+        for (unsigned int i = 0; i < found.size(); ++i)
+        {
+            if (nameMatchesWord(found[i], str, token.exactMatch))
+                token.matches.insert(found[i]);
+        }
+
+        if (!searchType_ || token.nodeOnly) continue;
+        found.clear();
+        if (token.exactMatch)
+            index.findExact(str, SceneSearchIndex::ClassNameMask, found);
+        else
+            index.findSubstring(str, SceneSearchIndex::ClassNameMask, found);
+        for (unsigned int i = 0; i < found.size(); ++i)
+        {
+            if (!Node::DynamicCast(found[i]))
+                token.matches.insert(found[i]);
+        }
+    }
+}
+
+bool SceneGraphFilter::nameMatches(const Keys& keys, const QString& filter, bool isNode, bool exactMatch) const
+{
+    if (!searchName_) return false;
+
+    if (isNode)
+    {
+        if (exactMatch)
+            return keys.lower == filter;
+        else
+            return keys.lower.contains(filter);
+    }
+
+    if (!keys.hasName) return false;
+    if (exactMatch)
+        return keys.lastWord == filter;
+    else
+        return keys.name.contains(filter);
+}
+
+bool SceneGraphFilter::typeMatches(const Keys& keys, const QString& filter, bool isNode, bool exactMatch) const
+{
+    if (isNode || !searchType_) return false;
+
+    if (exactMatch)
+        return keys.type == filter;
+    else
+        return keys.type.contains(filter);
+}
+
+bool SceneGraphFilter::matches(Base* base, const Keys* keys, bool isNode, bool parentMatched) const
+{
+    bool noOption = !searchName_ && !searchType_ ; // No option activated : ignore filter and display node anyway
+
+    if (noOption || filter_.isEmpty() || (parentMatched && displayChildrenWhenParentMatches_))
+        return true;
+
+    bool display = true;
+    for (unsigned int fl = 0; fl < tokens_.size(); ++fl)
+    {
+        const Token& token = tokens_[fl];
+
+        if (token.nodeOnly && !isNode)
+        {
+            display = false;
+        }
+        else if (token.warnings)
+        {
+            BaseObject* bo = BaseObject::DynamicCast(base);
+            display = !(isNode || (bo && bo->getWarnings().empty()));
+        }
+        else if (base)
+        {
+            display &= token.str.isEmpty() || token.matches.count(base) != 0;
+        }
+        else if (keys)
+        {
+            display &= nameMatches(*keys, token.str, isNode, token.exactMatch) || typeMatches(*keys, token.str, isNode, token.exactMatch);
+        }
+    }
+    return display;
+}
+
+bool SceneGraphFilter::showsContent(Base* base) const
+{
+    Node* node = Node::DynamicCast(base);
+    return !node || node->isActive() || !activatedFilter_;
+}
+
+} // namespace qt
+
+} // namespace gui
+
+} // namespace sofa
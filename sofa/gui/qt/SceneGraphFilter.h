@@ -0,0 +1,129 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_QT_SCENEGRAPHFILTER_H
+#define SOFA_GUI_QT_SCENEGRAPHFILTER_H
+
+#include "SofaGUIQt.h"
+#include "SceneSearchIndex.h"
+
+#ifdef SOFA_QT4
+#include <QString>
+#else
+#include <qstring.h>
+#endif
+
+#include <sofa/simulation/common/Node.h>
+
+#include <unordered_set>
+#include <vector>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+namespace qt
+{
+
+/// Filter typed above the scene graph, shared by QSofaListView and QSofaTreeView.
+///
+/// A component is displayed if it matches all the words of the filter: the name of a
+/// node, or the class or the name of an object, as shown by its item. The template of
+/// an object is not matched, it is only searched by the "go to component" dialog. A word
+/// between quotes must be equal to the name of a node, or to the class or the last word
+/// of the name of an object, a word containing '/' only matches the nodes, and '!' matches
+/// the objects with warnings. The components matching each word are looked up in the search index of the graph, the
+/// other items, such as the Data, are compared to their text.
+class SOFA_SOFAGUIQT_API SceneGraphFilter
+{
+public:
+    typedef core::objectmodel::Base Base;
+
+    /// Lowercase keys compared to the filter, computed from the text of an item
+    struct Keys
+    {
+        QString text;     ///< text of the item the keys were computed from
+        QString lower;    ///< whole text, the name of a node
+        QString type;     ///< first word, the type of an object
+        QString name;     ///< words after the type of an object
+        QString lastWord;
+        bool hasName;
+        Keys() : hasName(false) {}
+        /// Compute the keys again if the text changed
+        void set(const QString& itemText);
+    };
+
+    SceneGraphFilter();
+
+    void setFilter(const QString& filter);
+    const QString& getFilter() const { return filter_; }
+    void setSearchName(bool value) { searchName_ = value; }
+    bool getSearchName() const { return searchName_; }
+    void setSearchType(bool value) { searchType_ = value; }
+    bool getSearchType() const { return searchType_; }
+    /// Hide the content of the deactivated nodes matching the filter
+    void setActivatedFilter(bool value) { activatedFilter_ = value; }
+    bool getActivatedFilter() const { return activatedFilter_; }
+    void setDisplayChildrenWhenParentMatches(bool value) { displayChildrenWhenParentMatches_ = value; }
+    bool getDisplayChildrenWhenParentMatches() const { return displayChildrenWhenParentMatches_; }
+
+    /// Look up the components matching each word, to be called again once the graph changed
+    void findMatches(const SceneSearchIndex& index);
+    /// Whether the component, or the item of the given keys if base is NULL, is displayed
+    bool matches(Base* base, const Keys* keys, bool isNode, bool parentMatched) const;
+    /// Whether the content of a matching component is displayed
+    bool showsContent(Base* base) const;
+
+protected:
+    /// Word of the filter, lowercase
+    struct Token
+    {
+        QString str;
+        bool exactMatch;
+        bool nodeOnly;
+        bool warnings;
+        /// components matching the word, found in the search index of the graph
+        std::unordered_set<Base*> matches;
+    };
+
+    bool nameMatches(const Keys& keys, const QString& filter, bool isNode, bool exactMatch) const;
+    bool typeMatches(const Keys& keys, const QString& filter, bool isNode, bool exactMatch) const;
+
+    QString filter_;
+    std::vector<Token> tokens_;
+    bool searchName_;
+    bool searchType_;
+    bool activatedFilter_;
+    bool displayChildrenWhenParentMatches_;
+};
+
+} // namespace qt
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_QT_SCENEGRAPHFILTER_H
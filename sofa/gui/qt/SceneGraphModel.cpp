@@ -0,0 +1,617 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "SceneGraphModel.h"
+#include "GraphListenerQListView.h"
+#include <sofa/core/objectmodel/ConfigurationSetting.h>
+#include "iconmultinode.xpm"
+#include "iconwarning.xpm"
+#include "icondata.xpm"
+
+#include <QPixmap>
+
+#include <set>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+namespace qt
+{
+
+using sofa::simulation::Node;
+using sofa::core::objectmodel::Base;
+using sofa::core::objectmodel::BaseData;
+using sofa::core::objectmodel::BaseObject;
+
+SceneGraphModel::SceneGraphModel(QObject* parent)
+    : QAbstractItemModel(parent)
+    , root(NULL)
+    , rootEntry(new Entry(NULL, NULL, NULL, false))
+    , frozen(false)
+    , revision(0)
+{
+    rootEntry->fetched = true;
+}
+
+SceneGraphModel::~SceneGraphModel()
+{
+    setRoot(NULL);
+    delete rootEntry;
+}
+
+void SceneGraphModel::setRoot(Node* node)
+{
+    beginResetModel();
+    for (unsigned int i=0; i<rootEntry->children.size(); ++i)
+        destroyEntry(rootEntry->children[i]);
+    rootEntry->children.clear();
+    entries.clear();
+    objectsShowingDatas.clear();
+    if (root)
+    {
+        removeChild(NULL, root.get());
+        root->removeListener(this);
+    }
+    searchIndex.clear();
+    ++revision;
+    root = node;
+    if (root)
+    {
+        // listen to the whole graph, the rows are only created when fetched
+        addChild(NULL, root.get());
+        rootEntry->children.push_back(createEntry(rootEntry, Content(root.get(), NULL)));
+    }
+    endResetModel();
+}
+
+void SceneGraphModel::freeze()
+{
+    frozen = true;
+}
+
+void SceneGraphModel::unfreeze()
+{
+    if (!frozen) return;
+    frozen = false;
+    synchronize(rootEntry);
+}
+
+void SceneGraphModel::setShowDatas(BaseObject* object, bool show)
+{
+    if (show) objectsShowingDatas.insert(object);
+    else objectsShowingDatas.erase(object);
+
+    std::vector<Entry*> shown;
+    std::pair<std::unordered_multimap<Base*, Entry*>::iterator, std::unordered_multimap<Base*, Entry*>::iterator> range = entries.equal_range(object);
+    for (std::unordered_multimap<Base*, Entry*>::iterator it = range.first; it != range.second; ++it)
+        shown.push_back(it->second);
+    for (unsigned int i=0; i<shown.size(); ++i)
+        synchronize(shown[i]);
+}
+
+Base* SceneGraphModel::getBase(const QModelIndex& index) const
+{
+    return index.isValid() ? entry(index)->base : NULL;
+}
+
+BaseData* SceneGraphModel::getData(const QModelIndex& index) const
+{
+    return index.isValid() ? entry(index)->data : NULL;
+}
+
+bool SceneGraphModel::isMultiNode(const QModelIndex& index) const
+{
+    return index.isValid() && entry(index)->multiNode;
+}
+
+QModelIndex SceneGraphModel::indexOf(Base* base)
+{
+    if (!root || !base) return QModelIndex();
+
+    // components between the root and base
+    std::vector<Base*> path;
+    Base* b = base;
+    while (b && b != root.get())
+    {
+        path.push_back(b);
+        if (Node* node = Node::DynamicCast(b))
+        {
+            core::objectmodel::BaseNode::Parents parents = node->getParents();
+            b = parents.empty() ? NULL : parents[0];
+        }
+        else if (BaseObject* object = BaseObject::DynamicCast(b))
+        {
+            if (object->getMaster()) b = object->getMaster();
+            else b = Node::DynamicCast(object->getContext());
+        }
+        else b = NULL;
+    }
+    if (b != root.get() || rootEntry->children.empty()) return QModelIndex();
+
+    Entry* e = rootEntry->children[0];
+    for (std::size_t i = path.size(); i-- > 0; )
+    {
+        if (!e->fetched) fetchMore(indexOf(e));
+        Entry* next = NULL;
+        for (unsigned int c=0; c<e->children.size() && !next; ++c)
+            if (e->children[c]->base == path[i] && !e->children[c]->multiNode) next = e->children[c];
+        if (!next) return QModelIndex();
+        e = next;
+    }
+    return indexOf(e);
+}
+
+QString SceneGraphModel::text(Base* base)
+{
+    if (Node::DynamicCast(base)) return QString(base->getName().c_str());
+
+    std::string name = sofa::helper::gettypename(typeid(*base));
+    std::string::size_type pos = name.find('<');
+    if (pos != std::string::npos)
+        name.erase(pos);
+    if (!core::objectmodel::ConfigurationSetting::DynamicCast(base))
+    {
+        name += "  ";
+        name += base->getName();
+    }
+    return QString(name.c_str());
+}
+
+QModelIndex SceneGraphModel::index(int row, int column, const QModelIndex& parent) const
+{
+    const Entry* e = entry(parent);
+    if (column != 0 || row < 0 || row >= (int)e->children.size()) return QModelIndex();
+    return createIndex(row, 0, e->children[row]);
+}
+
+QModelIndex SceneGraphModel::parent(const QModelIndex& index) const
+{
+    if (!index.isValid()) return QModelIndex();
+    return indexOf(entry(index)->parent);
+}
+
+int SceneGraphModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.column() > 0) return 0;
+    return (int)entry(parent)->children.size();
+}
+
+int SceneGraphModel::columnCount(const QModelIndex& /*parent*/) const
+{
+    return 1;
+}
+
+bool SceneGraphModel::hasChildren(const QModelIndex& parent) const
+{
+    const Entry* e = entry(parent);
+    if (e->fetched) return !e->children.empty();
+    return hasContent(e);
+}
+
+bool SceneGraphModel::canFetchMore(const QModelIndex& parent) const
+{
+    const Entry* e = entry(parent);
+    return !e->fetched && hasContent(e);
+}
+
+void SceneGraphModel::fetchMore(const QModelIndex& parent)
+{
+    Entry* e = entry(parent);
+    if (e->fetched) return;
+    e->fetched = true;
+    std::vector<Content> content;
+    listContent(e, content);
+    if (content.empty()) return;
+
+    // the icons of the rows are computed together
+    std::vector<Base*> components(content.size());
+    for (unsigned int i=0; i<content.size(); ++i)
+        components[i] = content[i].first;
+    std::vector<QPixmap*> pixmaps;
+    getPixmaps(components, pixmaps);
+
+    beginInsertRows(parent, 0, (int)content.size()-1);
+    for (unsigned int i=0; i<content.size(); ++i)
+        e->children.push_back(createEntry(e, content[i], content[i].second ? NULL : pixmaps[i]));
+    renumber(e, 0);
+    endInsertRows();
+}
+
+QVariant SceneGraphModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) return QVariant();
+    const Entry* e = entry(index);
+
+    if (e->data)
+    {
+        static QPixmap pixData((const char**)icondata_xpm);
+        if (role == Qt::DisplayRole) return QString("  ") + QString(e->data->getName().c_str());
+        if (role == Qt::DecorationRole) return pixData;
+        return QVariant();
+    }
+    if (e->multiNode)
+    {
+        static QPixmap pixMultiNode((const char**)iconmultinode_xpm);
+        if (role == Qt::DisplayRole) return QString("MultiNode ") + QString(e->base->getName().c_str());
+        if (role == Qt::DecorationRole) return pixMultiNode;
+        return QVariant();
+    }
+
+    if (role == Qt::DisplayRole)
+    {
+        Node* node = Node::DynamicCast(e->base);
+        if (node && !node->isActive()) return QString("Deactivated ") + text(e->base);
+        return text(e->base);
+    }
+    if (role == Qt::DecorationRole)
+    {
+        if (!e->base->getWarnings().empty())
+        {
+            static QPixmap pixWarning((const char**)iconwarning_xpm);
+            return pixWarning;
+        }
+        if (e->pixmap) return *e->pixmap;
+    }
+    return QVariant();
+}
+
+Qt::ItemFlags SceneGraphModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid()) return 0;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+SceneGraphModel::Entry* SceneGraphModel::entry(const QModelIndex& index) const
+{
+    return index.isValid() ? static_cast<Entry*>(index.internalPointer()) : rootEntry;
+}
+
+QModelIndex SceneGraphModel::indexOf(Entry* e) const
+{
+    if (!e || e == rootEntry) return QModelIndex();
+    return createIndex(rowOf(e), 0, e);
+}
+
+void SceneGraphModel::renumber(Entry* e, std::size_t from)
+{
+    for (std::size_t i = from; i < e->children.size(); ++i)
+        e->children[i]->row = (int)i;
+}
+
+SceneGraphModel::Entry* SceneGraphModel::createEntry(Entry* parent, const Content& content, QPixmap* pixmap)
+{
+    bool multiNode = false;
+    if (Node* node = Node::DynamicCast(content.first))
+    {
+        // the content of a node is shown below its first parent only
+        core::objectmodel::BaseNode::Parents parents = node->getParents();
+        multiNode = parents.size() > 1 && parent->base != parents[0];
+    }
+    if (!pixmap && !content.second) pixmap = getPixmap(content.first);
+    Entry* e = new Entry(parent, content.first, content.second, multiNode, pixmap);
+    if (e->base) entries.insert(std::make_pair(e->base, e));
+    return e;
+}
+
+void SceneGraphModel::destroyEntry(Entry* e)
+{
+    for (unsigned int i=0; i<e->children.size(); ++i)
+        destroyEntry(e->children[i]);
+    if (e->base)
+    {
+        std::pair<std::unordered_multimap<Base*, Entry*>::iterator, std::unordered_multimap<Base*, Entry*>::iterator> range = entries.equal_range(e->base);
+        for (std::unordered_multimap<Base*, Entry*>::iterator it = range.first; it != range.second; ++it)
+        {
+            if (it->second == e)
+            {
+                entries.erase(it);
+                break;
+            }
+        }
+    }
+    delete e;
+}
+
+void SceneGraphModel::listContent(const Entry* e, std::vector<Content>& content) const
+{
+    if (e == rootEntry)
+    {
+        if (root) content.push_back(Content(root.get(), NULL));
+        return;
+    }
+    if (e->data || e->multiNode) return;
+
+    if (Node* node = Node::DynamicCast(e->base))
+    {
+        for (Node::ObjectIterator it = node->object.begin(); it != node->object.end(); ++it)
+            content.push_back(Content(it->get(), NULL));
+        for (Node::ChildIterator it = node->child.begin(); it != node->child.end(); ++it)
+            content.push_back(Content(it->get(), NULL));
+    }
+    else if (BaseObject* object = BaseObject::DynamicCast(e->base))
+    {
+        const BaseObject::VecSlaves& slaves = object->getSlaves();
+        for (unsigned int i=0; i<slaves.size(); ++i)
+            content.push_back(Content(slaves[i].get(), NULL));
+        if (objectsShowingDatas.count(object))
+        {
+            const Base::VecData& fields = object->getDataFields();
+            for (unsigned int i=0; i<fields.size(); ++i)
+                content.push_back(Content(NULL, fields[i]));
+        }
+    }
+}
+
+bool SceneGraphModel::hasContent(const Entry* e) const
+{
+    if (e == rootEntry) return root != NULL;
+    if (e->data || e->multiNode) return false;
+
+    if (Node* node = Node::DynamicCast(e->base))
+        return !node->object.empty() || !node->child.empty();
+    if (BaseObject* object = BaseObject::DynamicCast(e->base))
+        return !object->getSlaves().empty()
+            || (objectsShowingDatas.count(object) && !object->getDataFields().empty());
+    return false;
+}
+
+void SceneGraphModel::insertRows(Base* owner, Base* base)
+{
+    // entries are created below, which invalidates the iterators of the index
+    std::vector<Entry*> owners;
+    std::pair<std::unordered_multimap<Base*, Entry*>::iterator, std::unordered_multimap<Base*, Entry*>::iterator> range = entries.equal_range(owner);
+    for (std::unordered_multimap<Base*, Entry*>::iterator it = range.first; it != range.second; ++it)
+        if (it->second->fetched && !it->second->multiNode) owners.push_back(it->second);
+
+    // the components are appended to the lists of their owner, which may already contain it
+    int row = -1;
+    if (Node* node = Node::DynamicCast(owner))
+    {
+        if (BaseObject::DynamicCast(base))
+        {
+            // objects are listed before the child nodes
+            row = (int)node->object.size();
+            if (row > 0 && (node->object.end()-1)->get() == base) --row;
+        }
+    }
+    else if (BaseObject* object = BaseObject::DynamicCast(owner))
+    {
+        // slaves are listed before the Data
+        const BaseObject::VecSlaves& slaves = object->getSlaves();
+        row = (int)slaves.size();
+        if (row > 0 && slaves.back().get() == base) --row;
+    }
+
+    std::set<Entry*> present;
+    range = entries.equal_range(base);
+    for (std::unordered_multimap<Base*, Entry*>::iterator it = range.first; it != range.second; ++it)
+        present.insert(it->second->parent);
+
+    for (unsigned int i=0; i<owners.size(); ++i)
+    {
+        Entry* o = owners[i];
+        if (present.count(o)) continue;
+
+        const int r = (row < 0 || row > (int)o->children.size()) ? (int)o->children.size() : row;
+        beginInsertRows(indexOf(o), r, r);
+        o->children.insert(o->children.begin()+r, createEntry(o, Content(base, NULL)));
+        renumber(o, r);
+        endInsertRows();
+    }
+}
+
+void SceneGraphModel::removeRows(Base* owner, Base* base)
+{
+    std::vector<Entry*> removed;
+    std::pair<std::unordered_multimap<Base*, Entry*>::iterator, std::unordered_multimap<Base*, Entry*>::iterator> range = entries.equal_range(base);
+    for (std::unordered_multimap<Base*, Entry*>::iterator it = range.first; it != range.second; ++it)
+        if (owner == NULL || it->second->parent->base == owner) removed.push_back(it->second);
+
+    for (unsigned int i=0; i<removed.size(); ++i)
+    {
+        Entry* e = removed[i];
+        Entry* p = e->parent;
+        const int row = rowOf(e);
+        beginRemoveRows(indexOf(p), row, row);
+        p->children.erase(p->children.begin()+row);
+        renumber(p, row);
+        destroyEntry(e);
+        endRemoveRows();
+    }
+}
+
+void SceneGraphModel::synchronize(Entry* e)
+{
+    if (!e->fetched) return;
+    const QModelIndex index = indexOf(e);
+    std::vector<Content> content;
+    listContent(e, content);
+    const std::set<Content> listed(content.begin(), content.end());
+
+    // rows which are not listed anymore
+    for (std::size_t i = e->children.size(); i-- > 0; )
+    {
+        Entry* child = e->children[i];
+        if (listed.count(Content(child->base, child->data))) continue;
+        beginRemoveRows(index, (int)i, (int)i);
+        e->children.erase(e->children.begin()+i);
+        renumber(e, i);
+        destroyEntry(child);
+        endRemoveRows();
+    }
+
+    // missing rows, in the display order
+    std::size_t k = 0;
+    for (std::size_t j = 0; j < content.size(); ++j, ++k)
+    {
+        if (k < e->children.size() && e->children[k]->base == content[j].first && e->children[k]->data == content[j].second)
+            continue;
+        beginInsertRows(index, (int)k, (int)k);
+        e->children.insert(e->children.begin()+k, createEntry(e, content[j]));
+        renumber(e, k);
+        endInsertRows();
+    }
+    // rows left after a reordering
+    if (e->children.size() > content.size())
+    {
+        beginRemoveRows(index, (int)content.size(), (int)e->children.size()-1);
+        std::vector<Entry*> extra(e->children.begin()+content.size(), e->children.end());
+        e->children.resize(content.size());
+        for (unsigned int i=0; i<extra.size(); ++i)
+            destroyEntry(extra[i]);
+        endRemoveRows();
+    }
+
+    for (unsigned int i=0; i<e->children.size(); ++i)
+        synchronize(e->children[i]);
+}
+
+void SceneGraphModel::rebuildMultiNodeRows(Node* node, Base* firstParent)
+{
+    std::vector<Entry*> multiNodes;
+    std::pair<std::unordered_multimap<Base*, Entry*>::iterator, std::unordered_multimap<Base*, Entry*>::iterator> range = entries.equal_range(node);
+    for (std::unordered_multimap<Base*, Entry*>::iterator it = range.first; it != range.second; ++it)
+        if (it->second->multiNode && it->second->parent->base == firstParent) multiNodes.push_back(it->second);
+
+    for (unsigned int i=0; i<multiNodes.size(); ++i)
+    {
+        Entry* e = multiNodes[i];
+        Entry* p = e->parent;
+        const int row = rowOf(e);
+        beginRemoveRows(indexOf(p), row, row);
+        p->children.erase(p->children.begin()+row);
+        renumber(p, row);
+        destroyEntry(e);
+        endRemoveRows();
+
+        // the removed parent may still be listed first by the node
+        Entry* rebuilt = createEntry(p, Content(node, NULL));
+        rebuilt->multiNode = false;
+        beginInsertRows(indexOf(p), row, row);
+        p->children.insert(p->children.begin()+row, rebuilt);
+        renumber(p, row);
+        endInsertRows();
+    }
+}
+
+void SceneGraphModel::addChild(Node* parent, Node* child)
+{
+    ++revision;
+    // a node with several parents is indexed below the first one
+    if (!searchIndex.contains(child)) searchIndex.add(child, parent);
+    MutationListener::addChild(parent, child);
+    if (frozen || parent == NULL) return;
+    insertRows(parent, child);
+}
+
+void SceneGraphModel::removeChild(Node* parent, Node* child)
+{
+    ++revision;
+    Node* firstParent = NULL;
+    if (parent)
+    {
+        core::objectmodel::BaseNode::Parents parents = child->getParents();
+        for (unsigned int i=0; i<parents.size() && !firstParent; ++i)
+            if (parents[i] != parent) firstParent = Node::DynamicCast(parents[i]);
+    }
+    if (firstParent == NULL)
+    {
+        MutationListener::removeChild(parent, child);
+        removeRows(parent, child);
+        searchIndex.remove(child);
+        return;
+    }
+
+    // the node stays in the graph with its content, below its other parents
+    removeRows(parent, child);
+    searchIndex.add(child, firstParent);
+    rebuildMultiNodeRows(child, firstParent);
+}
+
+void SceneGraphModel::moveChild(Node* previous, Node* parent, Node* child)
+{
+    ++revision;
+    searchIndex.add(child, parent);
+    removeRows(previous, child);
+    if (!frozen) insertRows(parent, child);
+}
+
+void SceneGraphModel::addObject(Node* parent, BaseObject* object)
+{
+    ++revision;
+    if (!searchIndex.contains(object)) searchIndex.add(object, parent);
+    MutationListener::addObject(parent, object);
+    if (frozen) return;
+    insertRows(parent, object);
+}
+
+void SceneGraphModel::removeObject(Node* parent, BaseObject* object)
+{
+    ++revision;
+    MutationListener::removeObject(parent, object);
+    removeRows(parent, object);
+    searchIndex.remove(object);
+}
+
+void SceneGraphModel::moveObject(Node* previous, Node* parent, BaseObject* object)
+{
+    ++revision;
+    searchIndex.add(object, parent);
+    removeRows(previous, object);
+    if (!frozen) insertRows(parent, object);
+}
+
+void SceneGraphModel::addSlave(BaseObject* master, BaseObject* slave)
+{
+    ++revision;
+    if (!searchIndex.contains(slave)) searchIndex.add(slave, master);
+    MutationListener::addSlave(master, slave);
+    if (frozen) return;
+    insertRows(master, slave);
+}
+
+void SceneGraphModel::removeSlave(BaseObject* master, BaseObject* slave)
+{
+    ++revision;
+    MutationListener::removeSlave(master, slave);
+    removeRows(master, slave);
+    searchIndex.remove(slave);
+}
+
+void SceneGraphModel::moveSlave(BaseObject* previousMaster, BaseObject* master, BaseObject* slave)
+{
+    ++revision;
+    searchIndex.add(slave, master);
+    removeRows(previousMaster, slave);
+    if (!frozen) insertRows(master, slave);
+}
+
+} // namespace qt
+
+} // namespace gui
+
+} // namespace sofa
@@ -0,0 +1,175 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_QT_SCENEGRAPHMODEL_H
+#define SOFA_GUI_QT_SCENEGRAPHMODEL_H
+
+#include "SofaGUIQt.h"
+#include "SceneSearchIndex.h"
+
+#include <QAbstractItemModel>
+#include <QPixmap>
+
+#include <sofa/simulation/common/Node.h>
+#include <sofa/simulation/common/MutationListener.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+namespace qt
+{
+
+/// Item model of a scene graph whose rows are only created when their parent is
+/// expanded, for the scenes too large to be shown by a QSofaListView.
+///
+/// Nodes list their objects then their child nodes, objects list their slaves and,
+/// if requested, their Data. A node with several parents is listed under each of
+/// them, but its content is only shown under the first one, the other rows being
+/// "MultiNode" entries. Texts and icons are read from the components when they
+/// are displayed, so renamed or deactivated components need no update. The whole
+/// graph is indexed for the filter of the view, including the rows not created yet.
+class SOFA_SOFAGUIQT_API SceneGraphModel : public QAbstractItemModel, public simulation::MutationListener
+{
+    Q_OBJECT
+public:
+    SceneGraphModel(QObject* parent = 0);
+    ~SceneGraphModel();
+
+    /// Show the graph below root, and listen to its changes. The root is kept alive
+    /// until another one is set, so that the listeners can always be removed.
+    void setRoot(simulation::Node* root);
+    simulation::Node* getRoot() const { return root.get(); }
+
+    /// Changes of the graph are ignored while frozen, and applied when unfrozen
+    void freeze();
+    void unfreeze();
+    bool isFrozen() const { return frozen; }
+
+    SceneSearchIndex& getSearchIndex() { return searchIndex; }
+    /// Incremented by each change of the graph
+    unsigned int getRevision() const { return revision; }
+
+    /// List the Data of the object below its slaves
+    void setShowDatas(core::objectmodel::BaseObject* object, bool show);
+    bool isShowingDatas(core::objectmodel::BaseObject* object) const { return objectsShowingDatas.count(object) != 0; }
+
+    /// Component of a row, NULL for a Data row
+    core::objectmodel::Base* getBase(const QModelIndex& index) const;
+    /// Data of a row, NULL for a component row
+    core::objectmodel::BaseData* getData(const QModelIndex& index) const;
+    bool isMultiNode(const QModelIndex& index) const;
+    /// Row showing the component, creating the rows of its ancestors if needed
+    QModelIndex indexOf(core::objectmodel::Base* base);
+
+    /// Text of the row of a component, as shown by QSofaListView
+    static QString text(core::objectmodel::Base* base);
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const;
+    QModelIndex parent(const QModelIndex& index) const;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const;
+    bool canFetchMore(const QModelIndex& parent) const;
+    void fetchMore(const QModelIndex& parent);
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+    Qt::ItemFlags flags(const QModelIndex& index) const;
+
+    virtual void addChild(simulation::Node* parent, simulation::Node* child);
+    virtual void removeChild(simulation::Node* parent, simulation::Node* child);
+    virtual void moveChild(simulation::Node* previous, simulation::Node* parent, simulation::Node* child);
+    virtual void addObject(simulation::Node* parent, core::objectmodel::BaseObject* object);
+    virtual void removeObject(simulation::Node* parent, core::objectmodel::BaseObject* object);
+    virtual void moveObject(simulation::Node* previous, simulation::Node* parent, core::objectmodel::BaseObject* object);
+    virtual void addSlave(core::objectmodel::BaseObject* master, core::objectmodel::BaseObject* slave);
+    virtual void removeSlave(core::objectmodel::BaseObject* master, core::objectmodel::BaseObject* slave);
+    virtual void moveSlave(core::objectmodel::BaseObject* previousMaster, core::objectmodel::BaseObject* master, core::objectmodel::BaseObject* slave);
+
+protected:
+    struct Entry
+    {
+        Entry(Entry* p, core::objectmodel::Base* b, core::objectmodel::BaseData* d, bool multi, QPixmap* pix)
+            : parent(p), base(b), data(d), multiNode(multi), fetched(false), pixmap(pix), row(0) {}
+        Entry* parent;
+        /// NULL for a Data entry
+        core::objectmodel::Base* base;
+        core::objectmodel::BaseData* data;
+        bool multiNode;
+        /// children were created
+        bool fetched;
+        /// categories icon of the component
+        QPixmap* pixmap;
+        /// position in the children of the parent
+        int row;
+        std::vector<Entry*> children;
+    };
+
+    Entry* entry(const QModelIndex& index) const;
+    QModelIndex indexOf(Entry* e) const;
+    int rowOf(const Entry* e) const { return e->row; }
+    /// Update the rows of the children of e from the given position
+    void renumber(Entry* e, std::size_t from);
+
+    typedef std::pair<core::objectmodel::Base*, core::objectmodel::BaseData*> Content;
+
+    /// pixmap is the icon of the component, computed if it is not given
+    Entry* createEntry(Entry* parent, const Content& content, QPixmap* pixmap = NULL);
+    /// Delete the entry and its descendants, which must already be out of the model
+    void destroyEntry(Entry* e);
+    /// Components and Data listed below the entry, in display order
+    void listContent(const Entry* e, std::vector<Content>& content) const;
+    bool hasContent(const Entry* e) const;
+
+    /// Insert a row for base below each fetched entry of owner, at its place in the display order
+    void insertRows(core::objectmodel::Base* owner, core::objectmodel::Base* base);
+    /// Remove the rows of base below the entries of owner, or everywhere if owner is NULL
+    void removeRows(core::objectmodel::Base* owner, core::objectmodel::Base* base);
+    /// Rebuild the rows of the fetched entries whose content changed
+    void synchronize(Entry* e);
+    /// Replace the MultiNode rows of the node below its new first parent by rows showing its content
+    void rebuildMultiNodeRows(simulation::Node* node, core::objectmodel::Base* firstParent);
+
+    simulation::Node::SPtr root;
+    /// invisible entry above the root node
+    Entry* rootEntry;
+    bool frozen;
+    std::unordered_multimap<core::objectmodel::Base*, Entry*> entries;
+    std::unordered_set<core::objectmodel::BaseObject*> objectsShowingDatas;
+    SceneSearchIndex searchIndex;
+    unsigned int revision;
+};
+
+} // namespace qt
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_QT_SCENEGRAPHMODEL_H
@@ -0,0 +1,331 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "SceneSearchIndex.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+namespace qt
+{
+
+SceneSearchIndex::SceneSearchIndex()
+    : removedEntries_(0)
+{
+}
+
+void SceneSearchIndex::clear()
+{
+    entries_.clear();
+    ids_.clear();
+    children_.clear();
+    for (int f = 0; f < NbFields; ++f)
+    {
+        sortedKeys_[f].clear();
+        trigrams_[f].clear();
+    }
+    removedEntries_ = 0;
+}
+
+std::string SceneSearchIndex::toLower(const std::string& str)
+{
+    std::string lower(str);
+    for (std::string::size_type i = 0; i < lower.size(); ++i)
+        lower[i] = (char)tolower((unsigned char)lower[i]);
+    return lower;
+}
+
+unsigned int SceneSearchIndex::trigram(const std::string& str, std::string::size_type pos)
+{
+    return (unsigned int)(unsigned char)str[pos]
+        | ((unsigned int)(unsigned char)str[pos+1] << 8)
+        | ((unsigned int)(unsigned char)str[pos+2] << 16);
+}
+
+std::string SceneSearchIndex::getPath(Base* component) const
+{
+    std::unordered_map<Base*, unsigned int>::const_iterator it = ids_.find(component);
+    if (it == ids_.end()) return std::string();
+    return entries_[it->second].path;
+}
+
+unsigned int SceneSearchIndex::createEntry(Base* component, Base* parent)
+{
+    Entry e;
+    e.component = component;
+    e.parent = parent;
+    e.name = component->getName();
+    if (parent == NULL)
+        e.path = "/";
+    else
+    {
+        const std::string parentPath = getPath(parent);
+        e.path = (parentPath.empty() || parentPath == "/") ? "/" + e.name : parentPath + "/" + e.name;
+    }
+    e.keys[Name] = toLower(e.name);
+    e.keys[ClassName] = toLower(component->getClassName());
+    e.keys[TemplateName] = toLower(component->getTemplateName());
+    e.keys[Path] = toLower(e.path);
+
+    const unsigned int id = (unsigned int)entries_.size();
+    entries_.push_back(e);
+    ids_[component] = id;
+
+    std::vector<unsigned int> keyTrigrams;
+    for (int f = 0; f < NbFields; ++f)
+    {
+        const std::string& key = entries_[id].keys[f];
+        sortedKeys_[f].insert(std::make_pair(key, id));
+        if (key.size() < 3) continue;
+        keyTrigrams.clear();
+        for (std::string::size_type pos = 0; pos + 3 <= key.size(); ++pos)
+            keyTrigrams.push_back(trigram(key, pos));
+        std::sort(keyTrigrams.begin(), keyTrigrams.end());
+        keyTrigrams.erase(std::unique(keyTrigrams.begin(), keyTrigrams.end()), keyTrigrams.end());
+        for (unsigned int i = 0; i < keyTrigrams.size(); ++i)
+            trigrams_[f][keyTrigrams[i]].push_back(id);
+    }
+    return id;
+}
+
+void SceneSearchIndex::removeEntry(unsigned int id)
+{
+    Entry& e = entries_[id];
+    for (int f = 0; f < NbFields; ++f)
+    {
+        sortedKeys_[f].erase(std::make_pair(e.keys[f], id));
+        e.keys[f] = std::string();
+    }
+    e.component = NULL;
+    e.parent = NULL;
+    e.name = std::string();
+    e.path = std::string();
+    ++removedEntries_;
+}
+
+void SceneSearchIndex::removeChild(Base* parent, Base* child)
+{
+    if (parent == NULL) return;
+    std::pair<std::unordered_multimap<Base*, Base*>::iterator, std::unordered_multimap<Base*, Base*>::iterator> range = children_.equal_range(parent);
+    for (std::unordered_multimap<Base*, Base*>::iterator it = range.first; it != range.second; ++it)
+    {
+        if (it->second == child)
+        {
+            children_.erase(it);
+            return;
+        }
+    }
+}
+
+void SceneSearchIndex::updateSubtree(Base* component)
+{
+    std::unordered_map<Base*, unsigned int>::const_iterator it = ids_.find(component);
+    if (it == ids_.end()) return;
+    Base* parent = entries_[it->second].parent;
+    removeEntry(it->second);
+    createEntry(component, parent);
+
+    std::vector<Base*> children;
+    std::pair<std::unordered_multimap<Base*, Base*>::const_iterator, std::unordered_multimap<Base*, Base*>::const_iterator> range = children_.equal_range(component);
+    for (std::unordered_multimap<Base*, Base*>::const_iterator c = range.first; c != range.second; ++c)
+        children.push_back(c->second);
+    for (unsigned int i = 0; i < children.size(); ++i)
+        updateSubtree(children[i]);
+}
+
+void SceneSearchIndex::add(Base* component, Base* parent)
+{
+    std::unordered_map<Base*, unsigned int>::const_iterator it = ids_.find(component);
+    if (it == ids_.end())
+    {
+        if (parent) children_.insert(std::make_pair(parent, component));
+        createEntry(component, parent);
+        return;
+    }
+    Entry& e = entries_[it->second];
+    if (e.parent != parent)
+    {
+        removeChild(e.parent, component);
+        if (parent) children_.insert(std::make_pair(parent, component));
+        e.parent = parent;
+    }
+    updateSubtree(component);
+    compact();
+}
+
+void SceneSearchIndex::remove(Base* component)
+{
+    std::unordered_map<Base*, unsigned int>::iterator it = ids_.find(component);
+    if (it == ids_.end()) return;
+    const unsigned int id = it->second;
+    ids_.erase(it);
+    removeChild(entries_[id].parent, component);
+    children_.erase(component);
+    removeEntry(id);
+    compact();
+}
+
+void SceneSearchIndex::update(Base* component)
+{
+    updateSubtree(component);
+    compact();
+}
+
+void SceneSearchIndex::updateNames()
+{
+    std::vector<Base*> renamed;
+    for (std::unordered_map<Base*, unsigned int>::const_iterator it = ids_.begin(); it != ids_.end(); ++it)
+    {
+        if (entries_[it->second].name != it->first->getName())
+            renamed.push_back(it->first);
+    }
+    for (unsigned int i = 0; i < renamed.size(); ++i)
+        updateSubtree(renamed[i]);
+    compact();
+}
+
+void SceneSearchIndex::compact()
+{
+    // the entries of the removed components are only dropped once they are the majority
+    if (removedEntries_ < 1024 || removedEntries_ < ids_.size()) return;
+
+    std::unordered_map<Base*, Base*> parents;
+    for (unsigned int i = 0; i < entries_.size(); ++i)
+    {
+        if (entries_[i].component)
+            parents[entries_[i].component] = entries_[i].parent;
+    }
+    std::unordered_multimap<Base*, Base*> children;
+    children.swap(children_);
+    clear();
+    children_.swap(children);
+
+    // the parents are indexed before their children, which need their path
+    std::vector<Base*> stack;
+    for (std::unordered_map<Base*, Base*>::const_iterator it = parents.begin(); it != parents.end(); ++it)
+    {
+        if (it->second == NULL || !parents.count(it->second))
+            stack.push_back(it->first);
+    }
+    while (!stack.empty())
+    {
+        Base* component = stack.back();
+        stack.pop_back();
+        createEntry(component, parents[component]);
+        std::pair<std::unordered_multimap<Base*, Base*>::const_iterator, std::unordered_multimap<Base*, Base*>::const_iterator> range = children_.equal_range(component);
+        for (std::unordered_multimap<Base*, Base*>::const_iterator c = range.first; c != range.second; ++c)
+            stack.push_back(c->second);
+    }
+}
+
+void SceneSearchIndex::appendResults(std::vector<unsigned int>& ids, std::vector<Base*>& result) const
+{
+    // each component once, even if several of its fields match
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    for (unsigned int i = 0; i < ids.size(); ++i)
+    {
+        if (entries_[ids[i]].component)
+            result.push_back(entries_[ids[i]].component);
+    }
+}
+
+void SceneSearchIndex::findExact(const std::string& str, int fields, std::vector<Base*>& result) const
+{
+    std::vector<unsigned int> ids;
+    for (int f = 0; f < NbFields; ++f)
+    {
+        if (!(fields & (1<<f))) continue;
+        for (SortedKeys::const_iterator it = sortedKeys_[f].lower_bound(std::make_pair(str, 0u));
+             it != sortedKeys_[f].end() && it->first == str; ++it)
+            ids.push_back(it->second);
+    }
+    appendResults(ids, result);
+}
+
+void SceneSearchIndex::findPrefix(const std::string& str, int fields, std::vector<Base*>& result) const
+{
+    std::vector<unsigned int> ids;
+    for (int f = 0; f < NbFields; ++f)
+    {
+        if (!(fields & (1<<f))) continue;
+        for (SortedKeys::const_iterator it = sortedKeys_[f].lower_bound(std::make_pair(str, 0u));
+             it != sortedKeys_[f].end() && it->first.compare(0, str.size(), str) == 0; ++it)
+            ids.push_back(it->second);
+    }
+    appendResults(ids, result);
+}
+
+void SceneSearchIndex::findSubstring(const std::string& str, int fields, std::vector<Base*>& result) const
+{
+    std::vector<unsigned int> ids;
+    for (int f = 0; f < NbFields; ++f)
+    {
+        if (!(fields & (1<<f))) continue;
+        if (str.size() < 3)
+        {
+            // too short to use the trigrams, these queries match most of the components anyway
+            for (unsigned int id = 0; id < entries_.size(); ++id)
+            {
+                if (entries_[id].component && entries_[id].keys[f].find(str) != std::string::npos)
+                    ids.push_back(id);
+            }
+            continue;
+        }
+
+        // only the entries with the least common trigram of str are compared
+        const std::vector<unsigned int>* candidates = NULL;
+        for (std::string::size_type pos = 0; pos + 3 <= str.size(); ++pos)
+        {
+            Trigrams::const_iterator it = trigrams_[f].find(trigram(str, pos));
+            if (it == trigrams_[f].end())
+            {
+                candidates = NULL;
+                break;
+            }
+            if (candidates == NULL || it->second.size() < candidates->size())
+                candidates = &it->second;
+        }
+        if (candidates == NULL) continue;
+        for (unsigned int i = 0; i < candidates->size(); ++i)
+        {
+            const Entry& e = entries_[(*candidates)[i]];
+            if (e.component && e.keys[f].find(str) != std::string::npos)
+                ids.push_back((*candidates)[i]);
+        }
+    }
+    appendResults(ids, result);
+}
+
+} // namespace qt
+
+} // namespace gui
+
+} // namespace sofa
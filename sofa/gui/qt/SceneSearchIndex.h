@@ -0,0 +1,127 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, version 1.0 RC 1        *
+*            (c) 2006-2021 INRIA, USTL, UJF, CNRS, MGH, InSimo                *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program; if not, write to the Free Software Foundation, Inc., 51  *
+* Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.                   *
+*******************************************************************************
+*                            SOFA :: Applications                             *
+*                                                                             *
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_QT_SCENESEARCHINDEX_H
+#define SOFA_GUI_QT_SCENESEARCHINDEX_H
+
+#include "SofaGUIQt.h"
+#include <sofa/core/objectmodel/Base.h>
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+namespace qt
+{
+
+/// Index of the names, class names, template names and paths of the components of a scene.
+/// It is filled while the graph is built and kept up to date by its mutations, and answers the
+/// exact, prefix and substring queries without visiting the whole graph. The keys are lowercase.
+class SOFA_SOFAGUIQT_API SceneSearchIndex
+{
+public:
+    typedef core::objectmodel::Base Base;
+
+    enum Field { Name = 0, ClassName, TemplateName, Path, NbFields };
+    enum
+    {
+        NameMask = 1<<Name,
+        ClassNameMask = 1<<ClassName,
+        TemplateNameMask = 1<<TemplateName,
+        PathMask = 1<<Path,
+        AllFields = (1<<NbFields)-1
+    };
+
+    SceneSearchIndex();
+
+    void clear();
+    /// Add the component below its parent, a node or the master of a slave. If the component is
+    /// already indexed, it is moved and the paths of the components below it are updated.
+    void add(Base* component, Base* parent);
+    /// Remove the component, the components below it must be removed first
+    void remove(Base* component);
+    /// Index again the name of the component, and the paths below it
+    void update(Base* component);
+    /// Index again the components which were renamed
+    void updateNames();
+
+    bool contains(Base* component) const { return ids_.count(component) != 0; }
+    unsigned int size() const { return (unsigned int)ids_.size(); }
+    /// Path of the indexed component, "/" for the root node
+    std::string getPath(Base* component) const;
+
+    /// Components with one of the fields equal to str
+    void findExact(const std::string& str, int fields, std::vector<Base*>& result) const;
+    /// Components with one of the fields starting with str
+    void findPrefix(const std::string& str, int fields, std::vector<Base*>& result) const;
+    /// Components with one of the fields containing str
+    void findSubstring(const std::string& str, int fields, std::vector<Base*>& result) const;
+
+    static std::string toLower(const std::string& str);
+
+protected:
+    struct Entry
+    {
+        Base* component;              ///< NULL once removed or indexed again
+        Base* parent;
+        std::string name;
+        std::string path;
+        std::string keys[NbFields];
+    };
+    typedef std::set< std::pair<std::string, unsigned int> > SortedKeys;
+    typedef std::unordered_map<unsigned int, std::vector<unsigned int> > Trigrams;
+
+    unsigned int createEntry(Base* component, Base* parent);
+    void removeEntry(unsigned int id);
+    void updateSubtree(Base* component);
+    void removeChild(Base* parent, Base* child);
+    void appendResults(std::vector<unsigned int>& ids, std::vector<Base*>& result) const;
+    void compact();
+
+    static unsigned int trigram(const std::string& str, std::string::size_type pos);
+
+    std::vector<Entry> entries_;
+    std::unordered_map<Base*, unsigned int> ids_;
+    std::unordered_multimap<Base*, Base*> children_;
+    SortedKeys sortedKeys_[NbFields];
+    /// entries containing each sequence of 3 characters, the removed ones are skipped by the queries
+    Trigrams trigrams_[NbFields];
+    unsigned int removedEntries_;
+};
+
+} // namespace qt
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif // SOFA_GUI_QT_SCENESEARCHINDEX_H
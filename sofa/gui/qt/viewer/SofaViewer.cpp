@@ -23,6 +23,7 @@
 * Contact information: contact@sofa-framework.org                             *
 ******************************************************************************/
 #include "SofaViewer.h"
+#include "../QGLProfilerWidget.h"
 #include <sofa/helper/Factory.inl>
 #include <SofaBaseVisual/VisualStyle.h>
 #include <sofa/core/visual/DisplayFlags.h>
@@ -39,6 +40,7 @@ namespace viewer
 SofaViewer::SofaViewer()
     : sofa::gui::BaseViewer()
     , m_isControlPressed(false)
+    , profilerTab(NULL)
 {
     colourPickingRenderCallBack = ColourPickingRenderCallBack(this);
 }
@@ -52,6 +54,25 @@ void SofaViewer::redraw()
     getQWidget()->update();
 }
 
+void SofaViewer::configureViewerTab(QTabWidget* tabs)
+{
+    if (profilerTab) return;
+    profilerTab = new QGLProfilerWidget(&frameProfiler, tabs);
+    tabs->addTab(profilerTab, QString("Profiler"));
+}
+
+void SofaViewer::removeViewerTab(QTabWidget* tabs)
+{
+    if (!profilerTab) return;
+#ifdef SOFA_QT4
+    tabs->removeTab(tabs->indexOf(profilerTab));
+#else
+    tabs->removePage(profilerTab);
+#endif
+    delete profilerTab;
+    profilerTab = NULL;
+}
+
 void SofaViewer::keyPressEvent(QKeyEvent * e)
 {
 
@@ -30,6 +30,7 @@
 #include "../PickHandlerCallBacks.h"
 #include "../SofaGUIQt.h"
 #include "../SofaVideoRecorderManager.h"
+#include "../../GLFrameProfiler.h"
 
 #include <qstring.h>
 #include <qwidget.h>
@@ -57,6 +58,8 @@ namespace gui
 namespace qt
 {
 
+class QGLProfilerWidget;
+
 namespace viewer
 {
 
@@ -77,9 +80,12 @@ public:
     virtual ~SofaViewer();
 
     /// Optional QTabWidget GUI for a concreate viewer.
-    virtual void removeViewerTab(QTabWidget *) {}
+    /// By default it displays the times measured by the frame profiler.
+    virtual void removeViewerTab(QTabWidget *);
     /// Optional QTabWidget GUI for a concreate viewer.
-    virtual void configureViewerTab(QTabWidget *) {}
+    virtual void configureViewerTab(QTabWidget *);
+
+    sofa::gui::GLFrameProfiler* getFrameProfiler() { return &frameProfiler; }
 
     virtual QWidget* getQWidget()=0;
     virtual QString helpString()=0;
@@ -110,6 +116,10 @@ protected:
 
     ColourPickingRenderCallBack colourPickingRenderCallBack;
 
+    /// CPU and GPU times of the sections of the frames drawn by the viewer
+    sofa::gui::GLFrameProfiler frameProfiler;
+    QGLProfilerWidget* profilerTab;
+
 signals:
     virtual void redrawn() = 0;
     virtual void resizeW(int) = 0;
@@ -99,6 +99,8 @@ QtGLViewer::QtGLViewer(QWidget* parent, const char* name)
     //Fl_Gl_Window::mode(FL_RGB | FL_DOUBLE | FL_DEPTH | FL_ALPHA);
     timerAnimate = new QTimer(this);
     connect( timerAnimate, SIGNAL(timeout()), this, SLOT(animate()) );
+    timerPicking = new QTimer(this);
+    connect( timerPicking, SIGNAL(timeout()), this, SLOT(pollPicking()) );
 
     //	_previousEyePos = Vector3(0.0, 0.0, 0.0);
     // 	_zoom = 1.0;
@@ -138,6 +140,10 @@ QtGLViewer::QtGLViewer(QWidget* parent, const char* name)
 // ---------------------------------------------------------
 QtGLViewer::~QtGLViewer()
 {
+    makeCurrent();
+    overlay.release();
+    getPickHandler()->releaseGL();
+    frameProfiler.release();
 }
 
 // -----------------------------------------------------------------
@@ -244,27 +250,6 @@ void QtGLViewer::init(void)
         glEnable(GL_LIGHT0);
         //glEnable(GL_COLOR_MATERIAL);
 
-        //init Quadrics
-        _arrow = gluNewQuadric();
-        gluQuadricDrawStyle(_arrow, GLU_FILL);
-        gluQuadricOrientation(_arrow, GLU_OUTSIDE);
-        gluQuadricNormals(_arrow, GLU_SMOOTH);
-
-        _tube = gluNewQuadric();
-        gluQuadricDrawStyle(_tube, GLU_FILL);
-        gluQuadricOrientation(_tube, GLU_OUTSIDE);
-        gluQuadricNormals(_tube, GLU_SMOOTH);
-
-        _sphere = gluNewQuadric();
-        gluQuadricDrawStyle(_sphere, GLU_FILL);
-        gluQuadricOrientation(_sphere, GLU_OUTSIDE);
-        gluQuadricNormals(_sphere, GLU_SMOOTH);
-
-        _disk = gluNewQuadric();
-        gluQuadricDrawStyle(_disk, GLU_FILL);
-        gluQuadricOrientation(_disk, GLU_OUTSIDE);
-        gluQuadricNormals(_disk, GLU_SMOOTH);
-
         // change status so we only do this stuff once
         //initialized = true;
 
@@ -337,10 +322,7 @@ void QtGLViewer::Display3DText(float x, float y, float z, char* string)
 void QtGLViewer::DrawAxis(double xpos, double ypos, double zpos,
         double arrowSize)
 {
-    glPushMatrix();
-    glTranslatef(xpos, ypos,zpos);
-    QGLViewer::drawAxis(arrowSize);
-    glPopMatrix();
+    overlay.drawAxis(xpos, ypos, zpos, arrowSize);
 }
 
 // ---------------------------------------------------
@@ -349,102 +331,7 @@ void QtGLViewer::DrawAxis(double xpos, double ypos, double zpos,
 // ---------------------------------------------------
 void QtGLViewer::DrawBox(Real* minBBox, Real* maxBBox, Real r)
 {
-    //std::cout << "box = < " << minBBox[0] << ' ' << minBBox[1] << ' ' << minBBox[2] << " >-< " << maxBBox[0] << ' ' << maxBBox[1] << ' ' << maxBBox[2] << " >"<< std::endl;
-    if (r==0.0)
-        r = (Vector3(maxBBox) - Vector3(minBBox)).norm() / 500;
-#if 0
-    {
-        Enable<GL_DEPTH_TEST> depth;
-        Disable<GL_LIGHTING> lighting;
-        glColor3f(0.0, 1.0, 1.0);
-        glBegin(GL_LINES);
-        for (int corner=0; corner<4; ++corner)
-        {
-            glVertex3d(           minBBox[0]           ,
-                    (corner&1)?minBBox[1]:maxBBox[1],
-                    (corner&2)?minBBox[2]:maxBBox[2]);
-            glVertex3d(           maxBBox[0]           ,
-                    (corner&1)?minBBox[1]:maxBBox[1],
-                    (corner&2)?minBBox[2]:maxBBox[2]);
-        }
-        for (int corner=0; corner<4; ++corner)
-        {
-            glVertex3d((corner&1)?minBBox[0]:maxBBox[0],
-                    minBBox[1]           ,
-                    (corner&2)?minBBox[2]:maxBBox[2]);
-            glVertex3d((corner&1)?minBBox[0]:maxBBox[0],
-                    maxBBox[1]           ,
-                    (corner&2)?minBBox[2]:maxBBox[2]);
-        }
-
-        // --- Draw the Z edges
-        for (int corner=0; corner<4; ++corner)
-        {
-            glVertex3d((corner&1)?minBBox[0]:maxBBox[0],
-                    (corner&2)?minBBox[1]:maxBBox[1],
-                    minBBox[2]           );
-            glVertex3d((corner&1)?minBBox[0]:maxBBox[0],
-                    (corner&2)?minBBox[1]:maxBBox[1],
-                    maxBBox[2]           );
-        }
-        glEnd();
-        return;
-    }
-#endif
-    Enable<GL_DEPTH_TEST> depth;
-    Enable<GL_LIGHTING> lighting;
-    Enable<GL_COLOR_MATERIAL> colorMat;
-
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glShadeModel(GL_SMOOTH);
-
-    // --- Draw the corners
-    glColor3f(0.0, 1.0, 1.0);
-    for (int corner=0; corner<8; ++corner)
-    {
-        glPushMatrix();
-        glTranslated((corner&1)?minBBox[0]:maxBBox[0],
-                (corner&2)?minBBox[1]:maxBBox[1],
-                (corner&4)?minBBox[2]:maxBBox[2]);
-        gluSphere(_sphere,2*r,20,10);
-        glPopMatrix();
-    }
-
-    glColor3f(1.0, 1.0, 0.0);
-    // --- Draw the X edges
-    for (int corner=0; corner<4; ++corner)
-    {
-        glPushMatrix();
-        glTranslated(           minBBox[0]           ,
-                (corner&1)?minBBox[1]:maxBBox[1],
-                (corner&2)?minBBox[2]:maxBBox[2]);
-        glRotatef(90,0,1,0);
-        gluCylinder(_tube, r, r, maxBBox[0] - minBBox[0], 10, 10);
-        glPopMatrix();
-    }
-
-    // --- Draw the Y edges
-    for (int corner=0; corner<4; ++corner)
-    {
-        glPushMatrix();
-        glTranslated((corner&1)?minBBox[0]:maxBBox[0],
-                minBBox[1]           ,
-                (corner&2)?minBBox[2]:maxBBox[2]);
-        glRotatef(-90,1,0,0);
-        gluCylinder(_tube, r, r, maxBBox[1] - minBBox[1], 10, 10);
-        glPopMatrix();
-    }
-
-    // --- Draw the Z edges
-    for (int corner=0; corner<4; ++corner)
-    {
-        glPushMatrix();
-        glTranslated((corner&1)?minBBox[0]:maxBBox[0],
-                (corner&2)?minBBox[1]:maxBBox[1],
-                minBBox[2]           );
-        gluCylinder(_tube, r, r, maxBBox[2] - minBBox[2], 10, 10);
-        glPopMatrix();
-    }
+    overlay.drawBox(minBBox, maxBBox, r);
 }
 
 
@@ -455,25 +342,7 @@ void QtGLViewer::DrawBox(Real* minBBox, Real* maxBBox, Real r)
 void QtGLViewer::DrawXYPlane(double zo, double xmin, double xmax, double ymin,
         double ymax, double step)
 {
-    register double x, y;
-
-    Enable<GL_DEPTH_TEST> depth;
-
-    glBegin(GL_LINES);
-    for (x = xmin; x <= xmax; x += step)
-    {
-        glVertex3d(x, ymin, zo);
-        glVertex3d(x, ymax, zo);
-    }
-    glEnd();
-
-    glBegin(GL_LINES);
-    for (y = ymin; y <= ymax; y += step)
-    {
-        glVertex3d(xmin, y, zo);
-        glVertex3d(xmax, y, zo);
-    }
-    glEnd();
+    overlay.drawXYPlane(zo, xmin, xmax, ymin, ymax, step);
 }
 
 
@@ -484,25 +353,7 @@ void QtGLViewer::DrawXYPlane(double zo, double xmin, double xmax, double ymin,
 void QtGLViewer::DrawYZPlane(double xo, double ymin, double ymax, double zmin,
         double zmax, double step)
 {
-    register double y, z;
-    Enable<GL_DEPTH_TEST> depth;
-
-    glBegin(GL_LINES);
-    for (y = ymin; y <= ymax; y += step)
-    {
-        glVertex3d(xo, y, zmin);
-        glVertex3d(xo, y, zmax);
-    }
-    glEnd();
-
-    glBegin(GL_LINES);
-    for (z = zmin; z <= zmax; z += step)
-    {
-        glVertex3d(xo, ymin, z);
-        glVertex3d(xo, ymax, z);
-    }
-    glEnd();
-
+    overlay.drawYZPlane(xo, ymin, ymax, zmin, zmax, step);
 }
 
 
@@ -513,24 +364,7 @@ void QtGLViewer::DrawYZPlane(double xo, double ymin, double ymax, double zmin,
 void QtGLViewer::DrawXZPlane(double yo, double xmin, double xmax, double zmin,
         double zmax, double step)
 {
-    register double x, z;
-    Enable<GL_DEPTH_TEST> depth;
-
-    glBegin(GL_LINES);
-    for (x = xmin; x <= xmax; x += step)
-    {
-        glVertex3d(x, yo, zmin);
-        glVertex3d(x, yo, zmax);
-    }
-    glEnd();
-
-    glBegin(GL_LINES);
-    for (z = zmin; z <= zmax; z += step)
-    {
-        glVertex3d(xmin, yo, z);
-        glVertex3d(xmax, yo, z);
-    }
-    glEnd();
+    overlay.drawXZPlane(yo, xmin, xmax, zmin, zmax, step);
 }
 
 void QtGLViewer::drawColourPicking(ColourPickingVisitor::ColourCode code)
@@ -547,7 +381,8 @@ void QtGLViewer::drawColourPicking(ColourPickingVisitor::ColourCode code)
 
 
 
-    ColourPickingVisitor cpv(sofa::core::visual::VisualParams::defaultInstance(), code);
+    ColourPickingVisitor cpv(sofa::core::visual::VisualParams::defaultInstance(), code,
+            &pick->getColourPickingRegistry(), pick->getColourPickingRenderer());
     cpv.execute(groot.get());
 
     glMatrixMode(GL_PROJECTION);
@@ -561,51 +396,7 @@ void QtGLViewer::drawColourPicking(ColourPickingVisitor::ColourCode code)
 // -------------------------------------------------------------------
 void QtGLViewer::DrawLogo()
 {
-    glPushMatrix();
-
-    int w = 0;
-    int h = 0;
-
-    if (texLogo && texLogo->getImage())
-    {
-        h = texLogo->getImage()->getHeight();
-        w = texLogo->getImage()->getWidth();
-    }
-    else return;
-
-    Enable <GL_TEXTURE_2D> tex;
-    glDisable(GL_DEPTH_TEST);
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(-0.5, _W, -0.5, _H, -1.0, 1.0);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-
-    if (texLogo)
-        texLogo->bind();
-
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glBegin(GL_QUADS);
-    glTexCoord2d(0.0, 0.0);
-    glVertex3d((_W-w)/2, (_H-h)/2, 0.0);
-
-    glTexCoord2d(1.0, 0.0);
-    glVertex3d( _W-(_W-w)/2, (_H-h)/2, 0.0);
-
-    glTexCoord2d(1.0, 1.0);
-    glVertex3d( _W-(_W-w)/2, _H-(_H-h)/2, 0.0);
-
-    glTexCoord2d(0.0, 1.0);
-    glVertex3d((_W-w)/2, _H-(_H-h)/2, 0.0);
-    glEnd();
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
+    overlay.drawLogo(texLogo, _W, _H);
 }
 
 // -------------------------------------------------------------------
@@ -616,7 +407,10 @@ void QtGLViewer::DisplayOBJs()
 
 
     if (_background==0)
+    {
+        GLFrameProfiler::ScopedSection section(frameProfiler, "Background");
         DrawLogo();
+    }
 
     if (!groot) return;
 
@@ -657,10 +451,14 @@ void QtGLViewer::DisplayOBJs()
 
 
     {
-        //Draw Debug information of the components
-        simulation::getSimulation()->draw(vparams,groot.get());
+        {
+            GLFrameProfiler::ScopedSection section(frameProfiler, "Scene");
+            //Draw Debug information of the components
+            simulation::getSimulation()->draw(vparams,groot.get());
+        }
         if (_axis)
         {
+            GLFrameProfiler::ScopedSection section(frameProfiler, "Overlays");
             this->setSceneBoundingBox(qglviewer::Vec(vparams->sceneBBox().minBBoxPtr()),
                     qglviewer::Vec(vparams->sceneBBox().maxBBoxPtr()) );
 
@@ -703,31 +501,7 @@ void QtGLViewer::DisplayMenu(void)
 
 void QtGLViewer::MakeStencilMask()
 {
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    gluOrtho2D(0,_W, 0, _H );
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
-
-    glClear(GL_STENCIL_BUFFER_BIT);
-    glStencilFunc(GL_ALWAYS, 0x1, 0x1);
-    glStencilOp(GL_REPLACE, GL_REPLACE, GL_REPLACE);
-    glColor4f(0,0,0,0);
-    glBegin(GL_LINES);
-    for (float f=0 ; f< _H ; f+=2.0)
-    {
-        glVertex2f(0.0, f);
-        glVertex2f(_W, f);
-    }
-    glEnd();
-
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
-
+    overlay.makeStencilMask(_W, _H);
 }
 
 // ---------------------------------------------------------
@@ -764,6 +538,7 @@ void QtGLViewer::drawScene(void)
     {
 
         DisplayOBJs();
+        GLFrameProfiler::ScopedSection section(frameProfiler, "Menu");
         DisplayMenu();		// always needs to be the last object being drawn
     }
 
@@ -845,21 +620,31 @@ void QtGLViewer::draw()
     reshape(_W, _H);
     }
     */
-    // clear buffers (color and depth)
-    if (_background==0)
-        glClearColor(0.0f,0.0f,0.0f,1.0f);
-    else if (_background==1)
-        glClearColor(0.0f,0.0f,0.0f,0.0f);
-    else if (_background==2)
-        glClearColor(backgroundColour[0],backgroundColour[1],backgroundColour[2], 1.0f);
-    glClearDepth(1.0);
-    glClear(_clearBuffer);
+    frameProfiler.beginFrame();
+
+    {
+        GLFrameProfiler::ScopedSection section(frameProfiler, "Background");
+        // clear buffers (color and depth)
+        if (_background==0)
+            glClearColor(0.0f,0.0f,0.0f,1.0f);
+        else if (_background==1)
+            glClearColor(0.0f,0.0f,0.0f,0.0f);
+        else if (_background==2)
+            glClearColor(backgroundColour[0],backgroundColour[1],backgroundColour[2], 1.0f);
+        glClearDepth(1.0);
+        glClear(_clearBuffer);
+    }
 
     // draw the scene
     drawScene();
 
     if(!captureTimer.isActive())
+    {
+        GLFrameProfiler::ScopedSection section(frameProfiler, "Capture");
         SofaViewer::captureEvent();
+    }
+
+    frameProfiler.endFrame();
 
     if (_waitForRender)
         _waitForRender = false;
@@ -1035,6 +820,19 @@ void QtGLViewer::moveRayPickInteractor(int eventX, int eventY)
     direction = transform*Vec4d(0,0,1,0);
     direction.normalize();
     pick->updateRay(position, direction);
+    // the answer of a ray posted to the picking service is applied when it arrives
+    if (getPickHandler()->isWaitingAsynchronousResult())
+        timerPicking->start(PickingPollPeriod);
+}
+
+void QtGLViewer::pollPicking()
+{
+    // the readback of the selection buffer is decoded in the context of the viewer
+    makeCurrent();
+    if (getPickHandler()->pollAsynchronousResult())
+        update();
+    if (!getPickHandler()->isWaitingAsynchronousResult())
+        timerPicking->stop();
 }
 
 // -------------------------------------------------------------------
@@ -36,6 +36,7 @@
 
 #include <viewer/SofaViewer.h>
 #include <sofa/gui/ViewerFactory.h>
+#include <sofa/gui/ViewerOverlayRenderer.h>
 #include <sofa/defaulttype/Vec.h>
 #include <sofa/defaulttype/Quat.h>
 #include <sofa/helper/gl/Transformation.h>
@@ -81,6 +82,9 @@ private:
 #endif
 
     QTimer* timerAnimate;
+    /// polls the answer of the picking service after the mouse stopped
+    QTimer* timerPicking;
+    enum { PickingPollPeriod = 10 };
     int				_W, _H;
     int				_clearBuffer;
     bool			_lightModelTwoSides;
@@ -90,10 +94,7 @@ private:
     double lastProjectionMatrix[16];
     double lastModelviewMatrix[16];
 
-    GLUquadricObj*	_arrow;
-    GLUquadricObj*	_tube;
-    GLUquadricObj*	_sphere;
-    GLUquadricObj*	_disk;
+    sofa::gui::ViewerOverlayRenderer overlay;
     GLuint _numOBJmodels;
     GLuint _materialMode;
     GLboolean _facetNormal;
@@ -128,6 +129,7 @@ public:
     ~QtGLViewer();
 
     QWidget* getQWidget() { return this; }
+    bool makeGLContextCurrent() { makeCurrent(); return true; }
 
 protected:
 
@@ -200,6 +202,7 @@ protected:
 
 
 public slots:
+    void pollPicking();
     void resetView();
     void saveView();
     void setSizeW(int);
@@ -26,6 +26,7 @@
 #include <sofa/helper/system/FileRepository.h>
 #include <sofa/helper/system/thread/CTime.h>
 #include <sofa/simulation/common/Simulation.h>
+#include <sofa/core/visual/VisualLoop.h>
 #include <sofa/core/objectmodel/KeypressedEvent.h>
 #include <sofa/core/objectmodel/KeyreleasedEvent.h>
 #include <sofa/core/ObjectFactory.h>
@@ -43,6 +44,7 @@
 //#endif
 
 #include "../../GenGraphForm.h"
+#include "../../QDynamicResolutionWidget.h"
 
 
 #include <sofa/helper/system/glut.h>
@@ -58,6 +60,7 @@
 
 #include <sofa/defaulttype/RigidTypes.h>
 #include "../../../ColourPickingVisitor.h"
+#include "../../../FrustumCullingDrawVisitor.h"
 
 namespace sofa
 {
@@ -143,6 +146,8 @@ QtViewer::QtViewer(QWidget* parent, const char* name, void* shareRenderingContex
     //Fl_Gl_Window::mode(FL_RGB | FL_DOUBLE | FL_DEPTH | FL_ALPHA);
     timerAnimate = new QTimer(this);
     //connect( timerAnimate, SIGNAL(timeout()), this, SLOT(animate()) );
+    timerPicking = new QTimer(this);
+    connect( timerPicking, SIGNAL(timeout()), this, SLOT(pollPicking()) );
 
     _video = false;
     _axis = false;
@@ -171,6 +176,22 @@ QtViewer::QtViewer(QWidget* parent, const char* name, void* shareRenderingContex
     _mouseInteractorTrackball.ComputeQuaternion(0.0, 0.0, 0.0, 0.0);
     _mouseInteractorNewQuat = _mouseInteractorTrackball.GetQuaternion();
 
+    _dynamicResolution = false;
+    _targetFrameTime = 1000.0 / 60.0;
+    _minResolutionScale = 0.5;
+    _maxResolutionScale = 1.0;
+    _resolutionScale = 1.0;
+    _scaledFboAllocated = false;
+    _scaledFboWidth = 0;
+    _scaledFboHeight = 0;
+    _windowWidth = 0;
+    _windowHeight = 0;
+    _scaledRendering = false;
+    resolutionTab = NULL;
+    _frustumCulling = false;
+    _nbVisitedNodes = 0;
+    _nbCulledNodes = 0;
+
     copyscreen_texture_render = 0;
     copyscreen_texture_update = 0;
     copyscreen_needed = false;
@@ -205,6 +226,14 @@ QtViewer::QtViewer(QWidget* parent, const char* name, void* shareRenderingContex
 // ---------------------------------------------------------
 QtViewer::~QtViewer()
 {
+    makeCurrent();
+    overlay.release();
+    getPickHandler()->releaseGL();
+    if (_scaledFboAllocated)
+        _scaledFbo.destroy();
+    _frameTimer.release();
+    frameProfiler.release();
+
     for (auto& it : m_view)
     {
         free(it);
@@ -361,27 +390,6 @@ void QtViewer::initializeGL(void)
         glEnable(GL_LIGHT0);
         //glEnable(GL_COLOR_MATERIAL);
 
-        //init Quadrics
-        _arrow = gluNewQuadric();
-        gluQuadricDrawStyle(_arrow, GLU_FILL);
-        gluQuadricOrientation(_arrow, GLU_OUTSIDE);
-        gluQuadricNormals(_arrow, GLU_SMOOTH);
-
-        _tube = gluNewQuadric();
-        gluQuadricDrawStyle(_tube, GLU_FILL);
-        gluQuadricOrientation(_tube, GLU_OUTSIDE);
-        gluQuadricNormals(_tube, GLU_SMOOTH);
-
-        _sphere = gluNewQuadric();
-        gluQuadricDrawStyle(_sphere, GLU_FILL);
-        gluQuadricOrientation(_sphere, GLU_OUTSIDE);
-        gluQuadricNormals(_sphere, GLU_SMOOTH);
-
-        _disk = gluNewQuadric();
-        gluQuadricDrawStyle(_disk, GLU_FILL);
-        gluQuadricOrientation(_disk, GLU_OUTSIDE);
-        gluQuadricNormals(_disk, GLU_SMOOTH);
-
         // change status so we only do this stuff once
         //initialized = true;
 
@@ -432,74 +440,7 @@ void QtViewer::Display3DText(float x, float y, float z, char* string)
 // ---------------------------------------------------
 void QtViewer::DrawAxis(double xpos, double ypos, double zpos, double arrowSize)
 {
-    float fontScale = (float) (arrowSize / 600.0);
-
-    Enable<GL_DEPTH_TEST> depth;
-    Enable<GL_LIGHTING> lighting;
-    Enable<GL_COLOR_MATERIAL> colorMat;
-
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glShadeModel(GL_SMOOTH);
-
-    // --- Draw the "X" axis in red
-    glPushMatrix();
-    glColor3f(1.0, 0.0, 0.0);
-    glTranslated(xpos, ypos, zpos);
-    glRotatef(90.0f, 0.0, 1.0, 0.0);
-    gluCylinder(_tube, arrowSize / 50.0, arrowSize / 50.0, arrowSize, 10, 10);
-    glTranslated(0.0, 0.0, arrowSize);
-    gluCylinder(_arrow, arrowSize / 15.0, 0.0, arrowSize / 5.0, 10, 10);
-    // ---- Display a "X" near the tip of the arrow
-    glTranslated(-0.5 * fontScale * (double) glutStrokeWidth(GLUT_STROKE_ROMAN,
-            88), arrowSize / 15.0, arrowSize / 5.0);
-    glLineWidth(3.0);
-    glScalef(fontScale, fontScale, fontScale);
-    glutStrokeCharacter(GLUT_STROKE_ROMAN, 88);
-    glScalef(1.0f / fontScale, 1.0f / fontScale, 1.0f / fontScale);
-    glLineWidth(1.0f);
-    // --- Undo transforms
-    glTranslated(-xpos, -ypos, -zpos);
-    glPopMatrix();
-
-    // --- Draw the "Y" axis in green
-    glPushMatrix();
-    glColor3f(0.0, 1.0, 0.0);
-    glTranslated(xpos, ypos, zpos);
-    glRotatef(-90.0f, 1.0, 0.0, 0.0);
-    gluCylinder(_tube, arrowSize / 50.0, arrowSize / 50.0, arrowSize, 10, 10);
-    glTranslated(0.0, 0.0, arrowSize);
-    gluCylinder(_arrow, arrowSize / 15.0, 0.0, arrowSize / 5.0, 10, 10);
-    // ---- Display a "Y" near the tip of the arrow
-    glTranslated(-0.5 * fontScale * (double) glutStrokeWidth(GLUT_STROKE_ROMAN,
-            89), arrowSize / 15.0, arrowSize / 5.0);
-    glLineWidth(3.0);
-    glScalef(fontScale, fontScale, fontScale);
-    glutStrokeCharacter(GLUT_STROKE_ROMAN, 89);
-    glScalef(1.0f / fontScale, 1.0f / fontScale, 1.0f / fontScale);
-    glLineWidth(1.0);
-    // --- Undo transforms
-    glTranslated(-xpos, -ypos, -zpos);
-    glPopMatrix();
-
-    // --- Draw the "Z" axis in blue
-    glPushMatrix();
-    glColor3f(0.0, 0.0, 1.0);
-    glTranslated(xpos, ypos, zpos);
-    glRotatef(0.0f, 1.0, 0.0, 0.0);
-    gluCylinder(_tube, arrowSize / 50.0, arrowSize / 50.0, arrowSize, 10, 10);
-    glTranslated(0.0, 0.0, arrowSize);
-    gluCylinder(_arrow, arrowSize / 15.0, 0.0, arrowSize / 5.0, 10, 10);
-    // ---- Display a "Z" near the tip of the arrow
-    glTranslated(-0.5 * fontScale * (double) glutStrokeWidth(GLUT_STROKE_ROMAN,
-            90), arrowSize / 15.0, arrowSize / 5.0);
-    glLineWidth(3.0);
-    glScalef(fontScale, fontScale, fontScale);
-    glutStrokeCharacter(GLUT_STROKE_ROMAN, 90);
-    glScalef(1.0f / fontScale, 1.0f / fontScale, 1.0f / fontScale);
-    glLineWidth(1.0);
-    // --- Undo transforms
-    glTranslated(-xpos, -ypos, -zpos);
-    glPopMatrix();
+    overlay.drawAxis(xpos, ypos, zpos, arrowSize);
 }
 
 // ---------------------------------------------------
@@ -508,61 +449,7 @@ void QtViewer::DrawAxis(double xpos, double ypos, double zpos, double arrowSize)
 // ---------------------------------------------------
 void QtViewer::DrawBox(SReal* minBBox, SReal* maxBBox, SReal r)
 {
-    //std::cout << "box = < " << minBBox[0] << ' ' << minBBox[1] << ' ' << minBBox[2] << " >-< " << maxBBox[0] << ' ' << maxBBox[1] << ' ' << maxBBox[2] << " >"<< std::endl;
-    if (r == 0.0)
-        r = (Vector3(maxBBox) - Vector3(minBBox)).norm() / 500;
-
-    Enable<GL_DEPTH_TEST> depth;
-    Enable<GL_LIGHTING> lighting;
-    Enable<GL_COLOR_MATERIAL> colorMat;
-
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glShadeModel(GL_SMOOTH);
-
-    // --- Draw the corners
-    glColor3f(0.0, 1.0, 1.0);
-    for (int corner = 0; corner < 8; ++corner)
-    {
-        glPushMatrix();
-        glTranslated((corner & 1) ? minBBox[0] : maxBBox[0],
-                (corner & 2) ? minBBox[1] : maxBBox[1],
-                (corner & 4) ? minBBox[2] : maxBBox[2]);
-        gluSphere(_sphere, 2 * r, 20, 10);
-        glPopMatrix();
-    }
-
-    glColor3f(1.0, 1.0, 0.0);
-    // --- Draw the X edges
-    for (int corner = 0; corner < 4; ++corner)
-    {
-        glPushMatrix();
-        glTranslated(minBBox[0], (corner & 1) ? minBBox[1] : maxBBox[1],
-                (corner & 2) ? minBBox[2] : maxBBox[2]);
-        glRotatef(90, 0, 1, 0);
-        gluCylinder(_tube, r, r, maxBBox[0] - minBBox[0], 10, 10);
-        glPopMatrix();
-    }
-
-    // --- Draw the Y edges
-    for (int corner = 0; corner < 4; ++corner)
-    {
-        glPushMatrix();
-        glTranslated((corner & 1) ? minBBox[0] : maxBBox[0], minBBox[1],
-                (corner & 2) ? minBBox[2] : maxBBox[2]);
-        glRotatef(-90, 1, 0, 0);
-        gluCylinder(_tube, r, r, maxBBox[1] - minBBox[1], 10, 10);
-        glPopMatrix();
-    }
-
-    // --- Draw the Z edges
-    for (int corner = 0; corner < 4; ++corner)
-    {
-        glPushMatrix();
-        glTranslated((corner & 1) ? minBBox[0] : maxBBox[0],
-                (corner & 2) ? minBBox[1] : maxBBox[1], minBBox[2]);
-        gluCylinder(_tube, r, r, maxBBox[2] - minBBox[2], 10, 10);
-        glPopMatrix();
-    }
+    overlay.drawBox(minBBox, maxBBox, r);
 }
 
 // ----------------------------------------------------------------------------------
@@ -572,80 +459,27 @@ void QtViewer::DrawBox(SReal* minBBox, SReal* maxBBox, SReal r)
 void QtViewer::DrawXYPlane(double zo, double xmin, double xmax, double ymin,
         double ymax, double step)
 {
-    double x, y;
-
-    Enable<GL_DEPTH_TEST> depth;
-
-    glBegin(GL_LINES);
-    for (x = xmin; x <= xmax; x += step)
-    {
-        glVertex3d(x, ymin, zo);
-        glVertex3d(x, ymax, zo);
-    }
-    glEnd();
-
-    glBegin(GL_LINES);
-    for (y = ymin; y <= ymax; y += step)
-    {
-        glVertex3d(xmin, y, zo);
-        glVertex3d(xmax, y, zo);
-    }
-    glEnd();
+    overlay.drawXYPlane(zo, xmin, xmax, ymin, ymax, step);
 }
 
 // ----------------------------------------------------------------------------------
-// --- Draw a "plane" in wireframe. The "plane" is parallel to the XY axis
+// --- Draw a "plane" in wireframe. The "plane" is parallel to the YZ axis
 // --- of the main coordinate system
 // ----------------------------------------------------------------------------------
 void QtViewer::DrawYZPlane(double xo, double ymin, double ymax, double zmin,
         double zmax, double step)
 {
-    double y, z;
-    Enable<GL_DEPTH_TEST> depth;
-
-    glBegin(GL_LINES);
-    for (y = ymin; y <= ymax; y += step)
-    {
-        glVertex3d(xo, y, zmin);
-        glVertex3d(xo, y, zmax);
-    }
-    glEnd();
-
-    glBegin(GL_LINES);
-    for (z = zmin; z <= zmax; z += step)
-    {
-        glVertex3d(xo, ymin, z);
-        glVertex3d(xo, ymax, z);
-    }
-    glEnd();
-
+    overlay.drawYZPlane(xo, ymin, ymax, zmin, zmax, step);
 }
 
 // ----------------------------------------------------------------------------------
-// --- Draw a "plane" in wireframe. The "plane" is parallel to the XY axis
+// --- Draw a "plane" in wireframe. The "plane" is parallel to the XZ axis
 // --- of the main coordinate system
 // ----------------------------------------------------------------------------------
 void QtViewer::DrawXZPlane(double yo, double xmin, double xmax, double zmin,
         double zmax, double step)
 {
-    double x, z;
-    Enable<GL_DEPTH_TEST> depth;
-
-    glBegin(GL_LINES);
-    for (x = xmin; x <= xmax; x += step)
-    {
-        glVertex3d(x, yo, zmin);
-        glVertex3d(x, yo, zmax);
-    }
-    glEnd();
-
-    glBegin(GL_LINES);
-    for (z = zmin; z <= zmax; z += step)
-    {
-        glVertex3d(xmin, yo, z);
-        glVertex3d(xmax, yo, z);
-    }
-    glEnd();
+    overlay.drawXZPlane(yo, xmin, xmax, zmin, zmax, step);
 }
 
 // -------------------------------------------------------------------
@@ -653,51 +487,7 @@ void QtViewer::DrawXZPlane(double yo, double xmin, double xmax, double zmin,
 // -------------------------------------------------------------------
 void QtViewer::DrawLogo()
 {
-    int w = 0;
-    int h = 0;
-
-    if (texLogo && texLogo->getImage())
-    {
-        h = texLogo->getImage()->getHeight();
-        w = texLogo->getImage()->getWidth();
-    }
-    else
-        return;
-
-    Enable<GL_TEXTURE_2D> tex;
-    glDisable(GL_DEPTH_TEST);
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(-0.5, _W, -0.5, _H, -1.0, 1.0);
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
-
-    if (texLogo)
-        texLogo->bind();
-
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glBegin(GL_QUADS);
-    glTexCoord2d(0.0, 0.0);
-    glVertex3d((_W - w) / 2, (_H - h) / 2, 0.0);
-
-    glTexCoord2d(1.0, 0.0);
-    glVertex3d(_W - (_W - w) / 2, (_H - h) / 2, 0.0);
-
-    glTexCoord2d(1.0, 1.0);
-    glVertex3d(_W - (_W - w) / 2, _H - (_H - h) / 2, 0.0);
-
-    glTexCoord2d(0.0, 1.0);
-    glVertex3d((_W - w) / 2, _H - (_H - h) / 2, 0.0);
-    glEnd();
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
+    overlay.drawLogo(texLogo, _W, _H);
 }
 
 
@@ -718,7 +508,8 @@ void QtViewer::drawColourPicking(ColourPickingVisitor::ColourCode code)
     glMatrixMode(GL_MODELVIEW);
 
 
-    ColourPickingVisitor cpv(sofa::core::visual::VisualParams::defaultInstance(), code);
+    ColourPickingVisitor cpv(sofa::core::visual::VisualParams::defaultInstance(), code,
+            &pick->getColourPickingRegistry(), pick->getColourPickingRenderer());
     cpv.execute( groot.get() );
 
     glMatrixMode(GL_PROJECTION);
@@ -736,7 +527,10 @@ void QtViewer::DisplayOBJs()
         return;
 
     if (_background == 0)
+    {
+        GLFrameProfiler::ScopedSection section(frameProfiler, "Background");
         DrawLogo();
+    }
 
     if (!groot)
         return;
@@ -763,10 +557,17 @@ void QtViewer::DisplayOBJs()
 
     {
 
-        getSimulation()->draw(vparams,groot.get());
+        {
+            GLFrameProfiler::ScopedSection section(frameProfiler, "Scene");
+            if (_frustumCulling && canCullScene())
+                drawCulledScene();
+            else
+                getSimulation()->draw(vparams,groot.get());
+        }
 
         if (_axis)
         {
+            GLFrameProfiler::ScopedSection section(frameProfiler, "Overlays");
             DrawAxis(0.0, 0.0, 0.0, 10.0);
             sofa::defaulttype::BoundingBox bbox = vparams->sceneBBox();
             sofa::core::objectmodel::Base* selection = getSelectedComponent();
@@ -796,6 +597,47 @@ void QtViewer::DisplayOBJs()
     // glDisable(GL_COLOR_MATERIAL);
 }
 
+// -------------------------------------------------------------------
+// --- The culled draw replaces the default visual loop only, other loops
+// --- and visual managers add their own steps to the simulation's draw
+// -------------------------------------------------------------------
+bool QtViewer::canCullScene()
+{
+    sofa::core::visual::VisualLoop* vloop = groot->getVisualLoop();
+    return vloop && vloop->getClassName() == "DefaultVisualManagerLoop"
+            && groot->visualManager.empty();
+}
+
+// -------------------------------------------------------------------
+// --- Same passes as the default visual loop, skipping the subtrees
+// --- outside of the view frustum
+// -------------------------------------------------------------------
+void QtViewer::drawCulledScene()
+{
+    // only draw the components with the tags of the visual loop, as it does
+    const sofa::core::objectmodel::TagSet& tags = groot->getVisualLoop()->getTags();
+
+    // use the current matrices, as they differ from the last ones for each stereo eye
+    double projection[16];
+    double modelview[16];
+    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+
+    vparams->pass() = sofa::core::visual::VisualParams::Std;
+    FrustumCullingDrawVisitor act(vparams, projection, modelview);
+    act.setTags(tags);
+    groot->execute(&act);
+
+    vparams->pass() = sofa::core::visual::VisualParams::Transparent;
+    FrustumCullingDrawVisitor act2(vparams, projection, modelview);
+    act2.setTags(tags);
+    groot->execute(&act2);
+    vparams->pass() = sofa::core::visual::VisualParams::Std;
+
+    _nbVisitedNodes = act.getNbVisitedNodes();
+    _nbCulledNodes = act.getNbCulledNodes();
+}
+
 // -------------------------------------------------------
 // ---
 // -------------------------------------------------------
@@ -814,6 +656,7 @@ void QtViewer::DisplayMenu(void)
 
     if (_currentGUIMode == 2 || _currentGUIMode == 3) {
         // DISPLAY EXTERNAL SCREEN
+        GLFrameProfiler::ScopedSection section(frameProfiler, "Copy screen");
         drawCopyScreen();
     }
 
@@ -868,56 +711,15 @@ void QtViewer::drawCopyScreen()
         }
 
 
-        Enable<GL_TEXTURE_2D> tex;
         glBindTexture(GL_TEXTURE_2D, copyscreen_texture_render);
-        glDisable(GL_DEPTH_TEST);
-
-        glColor3f(1.0f, 1.0f, 1.0f);
-        glBegin(GL_QUADS);
-        glTexCoord2d(0.0, 0.0);
-        glVertex3d(copyscreen_view_x0, copyscreen_view_y0, 0.0);
-        
-        glTexCoord2d(1.0, 0.0);
-        glVertex3d(copyscreen_view_x0 + copyscreen_view_width, copyscreen_view_y0, 0.0);
-        
-        glTexCoord2d(1.0, 1.0);
-        glVertex3d(copyscreen_view_x0 + copyscreen_view_width, copyscreen_view_y0 + copyscreen_view_height, 0.0);
-        
-        glTexCoord2d(0.0, 1.0);
-        glVertex3d(copyscreen_view_x0, copyscreen_view_y0 + copyscreen_view_height, 0.0);
-        glEnd();
-
+        overlay.drawTexturedRect(copyscreen_view_x0, copyscreen_view_y0, copyscreen_view_width, copyscreen_view_height);
         glBindTexture(GL_TEXTURE_2D, 0);
     }
 }
 
 void QtViewer::MakeStencilMask()
 {
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    gluOrtho2D(0,_W, 0, _H );
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
-
-    glClear(GL_STENCIL_BUFFER_BIT);
-    glStencilFunc(GL_ALWAYS, 0x1, 0x1);
-    glStencilOp(GL_REPLACE, GL_REPLACE, GL_REPLACE);
-    glColor4f(0,0,0,0);
-    glBegin(GL_LINES);
-    for (float f=0 ; f< _H ; f+=2.0)
-    {
-        glVertex2f(0.0, f);
-        glVertex2f(_W, f);
-    }
-    glEnd();
-
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
-
+    overlay.makeStencilMask(_W, _H);
 }
 
 // ---------------------------------------------------------
@@ -1142,7 +944,9 @@ void QtViewer::drawScene(void)
         glDrawPixels(GetWidth(), GetHeight(), GL_BGRA, GL_UNSIGNED_BYTE, m_view[(m_recFrame + m_viewFrame+ m_maxBuffer) % m_maxBuffer]);
     }
 
-    DisplayMenu(); // always needs to be the last object being drawn
+    // in the scaled buffer, the menu is drawn at the window resolution once upscaled
+    if (!_scaledRendering)
+        DisplayMenu(); // always needs to be the last object being drawn
 }
 
 void QtViewer::recordFrame()
@@ -1281,26 +1085,45 @@ void QtViewer::calcProjection(int width, int height)
 // ---------------------------------------------------------
 void QtViewer::paintGL()
 {
+    frameProfiler.beginFrame();
 
-    // clear buffers (color and depth)
-    if (_background == 0)
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    else if (_background == 1)
-        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-    else if (_background == 2)
-        glClearColor(backgroundColour[0], backgroundColour[1],
-                backgroundColour[2], 1.0f);
-    glClearDepth(1.0);
-    glClear( _clearBuffer);
+    bool scaledRendering = beginScaledRendering();
+
+    {
+        GLFrameProfiler::ScopedSection section(frameProfiler, "Background");
+        // clear buffers (color and depth)
+        if (_background == 0)
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        else if (_background == 1)
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        else if (_background == 2)
+            glClearColor(backgroundColour[0], backgroundColour[1],
+                    backgroundColour[2], 1.0f);
+        glClearDepth(1.0);
+        glClear( _clearBuffer);
+    }
 
     // draw the scene
     drawScene();
 
+    if (scaledRendering)
+    {
+        {
+            GLFrameProfiler::ScopedSection section(frameProfiler, "Upscale");
+            endScaledRendering();
+        }
+        // the overlays and their mouse areas are in window pixels
+        DisplayMenu();
+    }
+
     if(!captureTimer.isActive() && groot)
     {
+        GLFrameProfiler::ScopedSection section(frameProfiler, "Capture");
         SofaViewer::captureEvent();
     }
 
+    frameProfiler.endFrame();
+
     if (_waitForRender)
     {
         _waitForRender = false;
@@ -1309,6 +1132,139 @@ void QtViewer::paintGL()
     emit( redrawn());
 }
 
+void QtViewer::configureViewerTab(QTabWidget* tabs)
+{
+    SofaViewer::configureViewerTab(tabs);
+    if (resolutionTab) return;
+    resolutionTab = new QDynamicResolutionWidget(this, tabs);
+    tabs->addTab(resolutionTab, QString("Resolution"));
+}
+
+void QtViewer::removeViewerTab(QTabWidget* tabs)
+{
+    SofaViewer::removeViewerTab(tabs);
+    if (!resolutionTab) return;
+#ifdef SOFA_QT4
+    tabs->removeTab(tabs->indexOf(resolutionTab));
+#else
+    tabs->removePage(resolutionTab);
+#endif
+    delete resolutionTab;
+    resolutionTab = NULL;
+}
+
+void QtViewer::setResolutionScaleLimits(double minScale, double maxScale)
+{
+    _minResolutionScale = std::max(0.1, std::min(minScale, maxScale));
+    _maxResolutionScale = std::max(_minResolutionScale, maxScale);
+    _resolutionScale = std::max(_minResolutionScale, std::min(_maxResolutionScale, _resolutionScale));
+}
+
+// ---------------------------------------------------------
+// --- Adapt the resolution scale to the last measured GPU frame time
+// ---------------------------------------------------------
+void QtViewer::updateResolutionScale()
+{
+    double frameTime = 0.0;
+    if (!_frameTimer.popLastTime(frameTime) || frameTime <= 0.0)
+        return;
+
+    const double ratio = _targetFrameTime / frameTime;
+    if (ratio > 0.9 && ratio < 1.1)
+        return; // close enough, avoid reallocating the buffer for small variations
+
+    // the cost of a fill-rate bound frame is proportional to the number of pixels
+    double scale = _resolutionScale * sqrt(ratio);
+    // damp the changes, and quantize them by steps of 5%
+    scale = std::max(_resolutionScale * 0.8, std::min(_resolutionScale * 1.1, scale));
+    scale = floor(scale * 20.0 + 0.5) / 20.0;
+    _resolutionScale = std::max(_minResolutionScale, std::min(_maxResolutionScale, scale));
+}
+
+// ---------------------------------------------------------
+// --- Redirect the rendering to the scaled offscreen buffer
+// ---------------------------------------------------------
+bool QtViewer::beginScaledRendering()
+{
+#ifdef SOFA_HAVE_GLEW
+    if (!_dynamicResolution || !sofa::gui::GLTimerQuery::isSupported() || !GLEW_EXT_framebuffer_object)
+        return false;
+    // the past views are stored at the window resolution, and interlaced stereo needs a stencil buffer
+    if (m_displayPastView || (_stereoEnabled && _stereoMode == STEREO_INTERLACED))
+        return false;
+
+    updateResolutionScale();
+
+    const int width = std::max(1, (int)(_W * _resolutionScale + 0.5));
+    const int height = std::max(1, (int)(_H * _resolutionScale + 0.5));
+    if (_scaledFboAllocated && (width != _scaledFboWidth || height != _scaledFboHeight))
+    {
+        _scaledFbo.destroy();
+        _scaledFboAllocated = false;
+    }
+    if (!_scaledFboAllocated)
+    {
+        _scaledFbo.init(width, height);
+        _scaledFboAllocated = true;
+        _scaledFboWidth = width;
+        _scaledFboHeight = height;
+    }
+
+    _frameTimer.begin();
+    _scaledFbo.start();
+
+    // the whole scene is drawn as if the window had the size of the buffer
+    _windowWidth = _W;
+    _windowHeight = _H;
+    _W = width;
+    _H = height;
+    _scaledRendering = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+// ---------------------------------------------------------
+// --- Upscale the offscreen buffer to the window
+// ---------------------------------------------------------
+void QtViewer::endScaledRendering()
+{
+    _scaledFbo.stop();
+
+    _W = _windowWidth;
+    _H = _windowHeight;
+    _scaledRendering = false;
+    // restore the window viewport, used to pick at the window resolution
+    vparams->viewport() = sofa::helper::make_array(0,0,_W,_H);
+    glViewport(0, 0, _W, _H);
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0, _W, 0, _H, -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    {
+        Disable<GL_LIGHTING> light;
+        Disable<GL_BLEND> blend;
+        glBindTexture(GL_TEXTURE_2D, _scaledFbo.getColorTexture());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        overlay.drawTexturedRect(0, 0, _W, _H);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+
+    _frameTimer.end();
+}
+
 // ---------------------------------------------------------
 // ---
 // ---------------------------------------------------------
@@ -1435,6 +1391,23 @@ void QtViewer::keyPressEvent(QKeyEvent * e)
             }
             break;
         }
+        case Qt::Key_F6:
+        {
+            // --- toggle the frustum culling of the scene graph
+            _frustumCulling = !_frustumCulling;
+            std::cout << "Frustum culling " << (_frustumCulling ? "Enabled" : "Disabled") << std::endl;
+            if (!_frustumCulling)
+                std::cout << "Last frame: " << _nbCulledNodes << " nodes culled out of " << _nbVisitedNodes << std::endl;
+            break;
+        }
+        case Qt::Key_F7:
+        {
+            // --- toggle the dynamic resolution
+            _dynamicResolution = !_dynamicResolution;
+            std::cout << "Dynamic resolution " << (_dynamicResolution ? "Enabled" : "Disabled")
+                    << " (target " << _targetFrameTime << " ms, current scale " << _resolutionScale << ")" << std::endl;
+            break;
+        }
         case Qt::Key_0:
         {
             if (m_maxBuffer > 0)
@@ -1825,6 +1798,19 @@ void QtViewer::moveRayPickInteractor(int eventX, int eventY)
     direction = transform * Vec4d(0, 0, 1, 0);
     direction.normalize();
     getPickHandler()->updateRay(position, direction);
+    // the answer of a ray posted to the picking service is applied when it arrives
+    if (getPickHandler()->isWaitingAsynchronousResult())
+        timerPicking->start(PickingPollPeriod);
+}
+
+void QtViewer::pollPicking()
+{
+    // the readback of the selection buffer is decoded in the context of the viewer
+    makeCurrent();
+    if (getPickHandler()->pollAsynchronousResult())
+        update();
+    if (!getPickHandler()->isWaitingAsynchronousResult())
+        timerPicking->stop();
 }
 
 // -------------------------------------------------------------------
@@ -1961,6 +1947,9 @@ The captured images are saved in the running project directory under the name fo
 <li><b>T</b>: TO CHANGE BETWEEN A PERSPECTIVE OR AN ORTHOGRAPHIC CAMERA<br></li>\
 <li><b>V</b>: TO SAVE A VIDEO<br>\
 Each time the frame is updated a screenshot is saved<br></li>\
+<li><b>F6</b>: TO SKIP THE PARTS OF THE SCENE OUTSIDE OF THE VIEW<br>\
+The number of nodes culled during the last frame is printed when disabled<br></li>\
+<li><b>F7</b>: TO ADAPT THE RENDERING RESOLUTION TO THE FRAME TIME<br></li>\
 <li><b>Esc</b>: TO QUIT ::sofa:: <br></li></ul>");
     return text;
 }
@@ -38,12 +38,15 @@
 
 #include "../SofaViewer.h"
 #include "../../../ViewerFactory.h"
+#include "../../../ViewerOverlayRenderer.h"
+#include "../../../GLTimerQuery.h"
 
 #include <sofa/defaulttype/Vec.h>
 #include <sofa/defaulttype/Quat.h>
 #include <sofa/helper/gl/Transformation.h>
 #include <sofa/helper/gl/Trackball.h>
 #include <sofa/helper/gl/Texture.h>
+#include <sofa/helper/gl/FrameBufferObject.h>
 
 #include <sofa/helper/system/thread/CTime.h>
 #include <sofa/simulation/common/xml/Element.h>
@@ -61,6 +64,8 @@ namespace gui
 namespace qt
 {
 
+class QDynamicResolutionWidget;
+
 namespace viewer
 {
 
@@ -98,6 +103,9 @@ private:
 
 
     QTimer* timerAnimate;
+    /// polls the answer of the picking service after the mouse stopped
+    QTimer* timerPicking;
+    enum { PickingPollPeriod = 10 };
     int				_W = 0, _H = 0;
     int				_clearBuffer;
     bool			_lightModelTwoSides;
@@ -106,10 +114,7 @@ private:
     int				_mouseX, _mouseY;
     int				_savedMouseX, _savedMouseY;
 
-    GLUquadricObj*	_arrow;
-    GLUquadricObj*	_tube;
-    GLUquadricObj*	_sphere;
-    GLUquadricObj*	_disk;
+    sofa::gui::ViewerOverlayRenderer overlay;
     GLuint			_numOBJmodels;
     GLuint			_materialMode;
     GLboolean		_facetNormal;
@@ -125,6 +130,11 @@ private:
     double lastProjectionMatrix[16];
     double lastModelviewMatrix[16];
 
+    /// skip the subtrees outside of the view frustum when drawing the scene
+    bool _frustumCulling;
+    unsigned int _nbVisitedNodes;
+    unsigned int _nbCulledNodes;
+
     // COPY EXTERNAL SCREEN
 
     using CopyScreenInfo = sofa::simulation::gui::BaseGUI::CopyScreenInfo;
@@ -144,6 +154,28 @@ private:
     int copyscreen_view_y0;
     int copyscreen_view_height;
 
+    // DYNAMIC RESOLUTION
+
+    bool beginScaledRendering();
+    void endScaledRendering();
+    void updateResolutionScale();
+
+    bool _dynamicResolution;
+    double _targetFrameTime;
+    double _minResolutionScale;
+    double _maxResolutionScale;
+    double _resolutionScale;
+    sofa::helper::gl::FrameBufferObject _scaledFbo;
+    bool _scaledFboAllocated;
+    int _scaledFboWidth;
+    int _scaledFboHeight;
+    int _windowWidth;
+    int _windowHeight;
+    /// the scene is being drawn in the scaled offscreen buffer
+    bool _scaledRendering;
+    sofa::gui::GLTimerQuery _frameTimer;
+    QDynamicResolutionWidget* resolutionTab;
+
 public:
 
     static const std::string VIEW_FILE_EXTENSION;
@@ -186,11 +218,13 @@ public:
     ~QtViewer();
 
     QWidget* getQWidget() { return this; }
+    bool makeGLContextCurrent() { makeCurrent(); return true; }
 
     bool ready() {return !_waitForRender;}
     void wait() {_waitForRender = true;}
 
 public slots:
+    void pollPicking();
     void resetView();
     virtual void saveView();
     virtual void setSizeW(int);
@@ -239,6 +273,28 @@ public:
     };
 
     void	UpdateOBJ(void);
+
+    /// Dynamic resolution: the scene is rendered in an offscreen buffer whose size
+    /// is adapted to keep the GPU frame time close to the target, then upscaled to
+    /// the window. Picking is not affected and keeps the window resolution.
+    void setDynamicResolution(bool enabled) { _dynamicResolution = enabled; }
+    bool getDynamicResolution() const { return _dynamicResolution; }
+    /// Target GPU time of a frame, in milliseconds
+    void setTargetFrameTime(double ms) { _targetFrameTime = ms; }
+    double getTargetFrameTime() const { return _targetFrameTime; }
+    /// Limits of the ratio between the offscreen buffer and the window sizes
+    void setResolutionScaleLimits(double minScale, double maxScale);
+    double getMinResolutionScale() const { return _minResolutionScale; }
+    double getMaxResolutionScale() const { return _maxResolutionScale; }
+    double getResolutionScale() const { return _resolutionScale; }
+
+    /// Add the dynamic resolution settings to the viewer tabs
+    virtual void configureViewerTab(QTabWidget* tabs);
+    virtual void removeViewerTab(QTabWidget* tabs);
+
+    /// Statistics of the frustum culling during the last draw
+    unsigned int getNbVisitedNodes() const { return _nbVisitedNodes; }
+    unsigned int getNbCulledNodes() const { return _nbCulledNodes; }
     void moveRayPickInteractor(int eventX, int eventY);
     /////////////////
     // Interaction //
@@ -280,6 +336,8 @@ private:
     //void	LoadGLTexture(char *Filename);
     void	DrawLogo(void);
     void	DisplayOBJs();
+    bool	canCullScene();
+    void	drawCulledScene();
     void	DisplayMenu(void);
     void	drawCopyScreen();
     virtual void	drawScene();